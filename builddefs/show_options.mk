@@ -67,6 +67,7 @@ OTHER_OPTION_NAMES = \
   MACROS_ENABLED \
   PS2_MOUSE_ENABLE \
   RAW_ENABLE \
+  TRACE_ENABLE \
   SWAP_HANDS_ENABLE \
   RING_BUFFERED_6KRO_REPORT_ENABLE \
   WATCHDOG_ENABLE \
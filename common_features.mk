@@ -46,6 +46,15 @@ else ifeq ($(strip $(DEBUG_MATRIX_SCAN_RATE_ENABLE)), api)
     OPT_DEFS += -DDEBUG_MATRIX_SCAN_RATE
 endif
 
+ifeq ($(strip $(TRACE_ENABLE)), yes)
+    OPT_DEFS += -DTRACE_ENABLE
+    QUANTUM_SRC += $(QUANTUM_DIR)/logging/trace.c
+    # Without raw HID the trace is streamed over the console
+    ifneq ($(strip $(RAW_ENABLE)), yes)
+        CONSOLE_ENABLE = yes
+    endif
+endif
+
 AUDIO_ENABLE ?= no
 ifeq ($(strip $(AUDIO_ENABLE)), yes)
     ifeq ($(PLATFORM),CHIBIOS)
@@ -255,6 +264,7 @@ endif
     SRC += $(QUANTUM_DIR)/process_keycode/process_backlight.c
     SRC += $(QUANTUM_DIR)/led_matrix/led_matrix.c
     SRC += $(QUANTUM_DIR)/led_matrix/led_matrix_drivers.c
+    LED_COMPOSITOR := yes
     SRC += $(LIB_PATH)/lib8tion/lib8tion.c
     CIE1931_CURVE := yes
 
@@ -284,6 +294,8 @@ endif
     SRC += $(QUANTUM_DIR)/color.c
     SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix.c
     SRC += $(QUANTUM_DIR)/rgb_matrix/rgb_matrix_drivers.c
+    LED_COMPOSITOR := yes
+    LED_OUTPUT := yes
     SRC += $(LIB_PATH)/lib8tion/lib8tion.c
     CIE1931_CURVE := yes
     RGB_KEYCODES_ENABLE := yes
@@ -447,6 +459,14 @@ ifeq ($(strip $(LED_TABLES)), yes)
     SRC += $(QUANTUM_DIR)/led_tables.c
 endif
 
+ifeq ($(strip $(LED_COMPOSITOR)), yes)
+    SRC += $(QUANTUM_DIR)/led_compositor.c
+endif
+
+ifeq ($(strip $(LED_OUTPUT)), yes)
+    SRC += $(QUANTUM_DIR)/led_output.c
+endif
+
 ifeq ($(strip $(TERMINAL_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/process_keycode/process_terminal.c
     OPT_DEFS += -DTERMINAL_ENABLE
@@ -535,9 +555,22 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
     COMMON_VPATH += $(QUANTUM_PATH)/split_common
 endif
 
+VALID_CRC_DRIVER_TYPES := software stm32
+
+CRC_DRIVER ?= software
 ifeq ($(strip $(CRC_ENABLE)), yes)
+    ifeq ($(filter $(CRC_DRIVER),$(VALID_CRC_DRIVER_TYPES)),)
+        $(error CRC_DRIVER="$(CRC_DRIVER)" is not a valid CRC driver)
+    endif
+
     OPT_DEFS += -DCRC_ENABLE
     SRC += crc.c
+    ifeq ($(strip $(CRC_DRIVER)), stm32)
+        ifneq ($(PLATFORM),CHIBIOS)
+            $(error CRC_DRIVER="$(CRC_DRIVER)" requires a ChibiOS STM32 MCU)
+        endif
+        SRC += crc_stm32.c
+    endif
 endif
 
 ifeq ($(strip $(HAPTIC_ENABLE)),yes)
@@ -6,7 +6,7 @@
 #include "debug.h"
 #include "timer.h"
 #include "action_util.h"
-#include "ringbuffer.hpp"
+#include "ring_buffer.h"
 #include <string.h>
 #include "spi_master.h"
 #include "wait.h"
@@ -102,11 +102,13 @@ struct queue_item {
 };
 
 // Items that we wish to send
-static RingBuffer<queue_item, 40> send_buf;
+static queue_item    send_buf_data[40];
+static ring_buffer_t send_buf = RING_BUFFER_INIT(send_buf_data);
 // Pending response; while pending, we can't send any more requests.
 // This records the time at which we sent the command for which we
 // are expecting a response.
-static RingBuffer<uint16_t, 2> resp_buf;
+static uint16_t      resp_buf_data[2];
+static ring_buffer_t resp_buf = RING_BUFFER_INIT(resp_buf_data);
 
 static bool process_queue_item(struct queue_item *item, uint16_t timeout);
 
@@ -229,7 +231,7 @@ static bool sdep_recv_pkt(struct sdep_msg *msg, uint16_t timeout) {
 
 static void resp_buf_read_one(bool greedy) {
     uint16_t last_send;
-    if (!resp_buf.peek(last_send)) {
+    if (!ring_buffer_peek(&resp_buf, &last_send)) {
         return;
     }
 
@@ -240,20 +242,20 @@ static void resp_buf_read_one(bool greedy) {
         if (sdep_recv_pkt(&msg, SdepTimeout)) {
             if (!msg.more) {
                 // We got it; consume this entry
-                resp_buf.get(last_send);
+                ring_buffer_drop(&resp_buf, 1);
                 dprintf("recv latency %dms\n", TIMER_DIFF_16(timer_read(), last_send));
             }
 
-            if (greedy && resp_buf.peek(last_send) && readPin(ADAFRUIT_BLE_IRQ_PIN)) {
+            if (greedy && ring_buffer_peek(&resp_buf, &last_send) && readPin(ADAFRUIT_BLE_IRQ_PIN)) {
                 goto again;
             }
         }
 
     } else if (timer_elapsed(last_send) > SdepTimeout * 2) {
-        dprintf("waiting_for_result: timeout, resp_buf size %d\n", (int)resp_buf.size());
+        dprintf("waiting_for_result: timeout, resp_buf size %d\n", (int)ring_buffer_count(&resp_buf));
 
         // Timed out: consume this entry
-        resp_buf.get(last_send);
+        ring_buffer_drop(&resp_buf, 1);
     }
 }
 
@@ -261,17 +263,17 @@ static void send_buf_send_one(uint16_t timeout = SdepTimeout) {
     struct queue_item item;
 
     // Don't send anything more until we get an ACK
-    if (!resp_buf.empty()) {
+    if (!ring_buffer_empty(&resp_buf)) {
         return;
     }
 
-    if (!send_buf.peek(item)) {
+    if (!ring_buffer_peek(&send_buf, &item)) {
         return;
     }
     if (process_queue_item(&item, timeout)) {
         // commit that peek
-        send_buf.get(item);
-        dprintf("send_buf_send_one: have %d remaining\n", (int)send_buf.size());
+        ring_buffer_drop(&send_buf, 1);
+        dprintf("send_buf_send_one: have %d remaining\n", (int)ring_buffer_count(&send_buf));
     } else {
         dprint("failed to send, will retry\n");
         wait_ms(SdepTimeout);
@@ -281,7 +283,7 @@ static void send_buf_send_one(uint16_t timeout = SdepTimeout) {
 
 static void resp_buf_wait(const char *cmd) {
     bool didPrint = false;
-    while (!resp_buf.empty()) {
+    while (!ring_buffer_empty(&resp_buf)) {
         if (!didPrint) {
             dprintf("wait on buf for %s\n", cmd);
             didPrint = true;
@@ -405,7 +407,7 @@ static bool at_command(const char *cmd, char *resp, uint16_t resplen, bool verbo
 
     if (resp == NULL) {
         uint16_t now = timer_read();
-        while (!resp_buf.enqueue(now)) {
+        while (!ring_buffer_push(&resp_buf, &now)) {
             resp_buf_read_one(false);
         }
         uint16_t later = timer_read();
@@ -507,7 +509,7 @@ void adafruit_ble_task(void) {
     resp_buf_read_one(true);
     send_buf_send_one(SdepShortTimeout);
 
-    if (resp_buf.empty() && (state.event_flags & UsingEvents) && readPin(ADAFRUIT_BLE_IRQ_PIN)) {
+    if (ring_buffer_empty(&resp_buf) && (state.event_flags & UsingEvents) && readPin(ADAFRUIT_BLE_IRQ_PIN)) {
         // Must be an event update
         if (at_command_P(PSTR("AT+EVENTSTATUS"), resbuf, sizeof(resbuf))) {
             uint32_t mask = strtoul(resbuf, NULL, 16);
@@ -550,7 +552,7 @@ void adafruit_ble_task(void) {
     }
 
 #ifdef SAMPLE_BATTERY
-    if (timer_elapsed(state.last_battery_update) > BatteryUpdateInterval && resp_buf.empty()) {
+    if (timer_elapsed(state.last_battery_update) > BatteryUpdateInterval && ring_buffer_empty(&resp_buf)) {
         state.last_battery_update = timer_read();
 
         state.vbat = analogReadPin(BATTERY_LEVEL_PIN);
@@ -625,7 +627,7 @@ void adafruit_ble_send_keys(uint8_t hid_modifier_mask, uint8_t *keys, uint8_t nk
         item.key.keys[4] = nkeys >= 4 ? keys[4] : 0;
         item.key.keys[5] = nkeys >= 5 ? keys[5] : 0;
 
-        if (!send_buf.enqueue(item)) {
+        if (!ring_buffer_push(&send_buf, &item)) {
             if (!didWait) {
                 dprint("wait for buf space\n");
                 didWait = true;
@@ -649,7 +651,7 @@ void adafruit_ble_send_consumer_key(uint16_t usage) {
     item.queue_type = QTConsumer;
     item.consumer   = usage;
 
-    while (!send_buf.enqueue(item)) {
+    while (!ring_buffer_push(&send_buf, &item)) {
         send_buf_send_one();
     }
 }
@@ -665,7 +667,7 @@ void adafruit_ble_send_mouse_move(int8_t x, int8_t y, int8_t scroll, int8_t pan,
     item.mousemove.pan     = pan;
     item.mousemove.buttons = buttons;
 
-    while (!send_buf.enqueue(item)) {
+    while (!ring_buffer_push(&send_buf, &item)) {
         send_buf_send_one();
     }
 }
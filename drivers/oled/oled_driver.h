@@ -166,6 +166,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #    define OLED_I2C_TIMEOUT 100
 #endif
 
+// Remember the text written to each character cell, and skip rewriting unchanged characters
+// Costs 2 bytes of RAM per cell, so it is off by default on AVR
+#if !defined(OLED_TEXT_CACHE)
+#    if defined(__AVR__)
+#        define OLED_TEXT_CACHE 0
+#    else
+#        define OLED_TEXT_CACHE 1
+#    endif
+#endif
+
 #if !defined(OLED_UPDATE_INTERVAL) && defined(SPLIT_KEYBOARD)
 #    define OLED_UPDATE_INTERVAL 50
 #endif
@@ -226,6 +236,11 @@ void oled_write(const char *data, bool invert);
 // Advances the cursor to the next page, wiring ' ' to the remainder of the current page
 void oled_write_ln(const char *data, bool invert);
 
+// Sets the whole text of a line, padding the rest with ' ' instead of wrapping to the next line
+// Leaves the cursor at the start of the next line
+// With OLED_TEXT_CACHE, characters that are already shown are skipped, so it is cheap to call on every oled_task
+void oled_write_line(uint8_t line, const char *data, bool invert);
+
 // Pans the buffer to the right (or left by passing true) by moving contents of the buffer
 // Useful for moving the screen in preparation for new drawing
 void oled_pan(bool left);
@@ -256,11 +271,16 @@ void oled_write_P(const char *data, bool invert);
 // Remapped to call 'void oled_write_ln(const char *data, bool invert);' on ARM
 void oled_write_ln_P(const char *data, bool invert);
 
+// Sets the whole text of a line from a PROGMEM string, padding the rest with ' '
+// Remapped to call 'void oled_write_line(uint8_t line, const char *data, bool invert);' on ARM
+void oled_write_line_P(uint8_t line, const char *data, bool invert);
+
 // Writes a PROGMEM string to the buffer at current cursor position
 void oled_write_raw_P(const char *data, uint16_t size);
 #else
 #    define oled_write_P(data, invert) oled_write(data, invert)
 #    define oled_write_ln_P(data, invert) oled_write(data, invert)
+#    define oled_write_line_P(line, data, invert) oled_write_line(line, data, invert)
 #    define oled_write_raw_P(data, size) oled_write_raw(data, size)
 #endif  // defined(__AVR__)
 
@@ -132,6 +132,19 @@ uint32_t oled_scroll_timeout;
 uint16_t oled_update_timeout;
 #endif
 
+#if OLED_TEXT_CACHE
+/* The character last written to each text cell, so writing the same text
+ * again is a comparison instead of a glyph copy. A cell is forgotten when its
+ * pixels are changed any other way. There are at most as many cells as whole
+ * font widths fit in the buffer, whatever the rotation. */
+#    define OLED_TEXT_CELLS (OLED_MATRIX_SIZE / OLED_FONT_WIDTH)
+#    define OLED_TEXT_NO_CELL 0xFFFF
+#    define OLED_TEXT_VALID 0x100
+#    define OLED_TEXT_INVERTED 0x200
+
+static uint16_t oled_text[OLED_TEXT_CELLS];
+#endif
+
 // Internal variables to reduce math instructions
 
 #if defined(__AVR__)
@@ -151,6 +164,34 @@ static i2c_status_t i2c_transmit_P(uint8_t address, const uint8_t *data, uint16_
 }
 #endif
 
+#if OLED_TEXT_CACHE
+// Returns the text cell the buffer byte at index belongs to
+static uint16_t oled_text_cell(uint16_t index) {
+    if (index >= OLED_MATRIX_SIZE) {
+        return OLED_TEXT_NO_CELL;
+    }
+    uint8_t line   = index / oled_rotation_width;
+    uint8_t column = index % oled_rotation_width / OLED_FONT_WIDTH;
+    uint8_t chars  = oled_rotation_width / OLED_FONT_WIDTH;
+    if (column >= chars) {
+        return OLED_TEXT_NO_CELL;
+    }
+    return line * chars + column;
+}
+
+static void oled_text_invalidate(uint16_t index) {
+    uint16_t cell = oled_text_cell(index);
+    if (cell != OLED_TEXT_NO_CELL) {
+        oled_text[cell] = 0;
+    }
+}
+
+static void oled_text_invalidate_all(void) { memset(oled_text, 0, sizeof(oled_text)); }
+#else
+#    define oled_text_invalidate(index)
+#    define oled_text_invalidate_all()
+#endif
+
 // Flips the rendering bits for a character at the current cursor position
 static void InvertCharacter(uint8_t *cursor) {
     const uint8_t *end = cursor + OLED_FONT_WIDTH;
@@ -239,6 +280,7 @@ void oled_clear(void) {
     memset(oled_buffer, 0, sizeof(oled_buffer));
     oled_cursor = &oled_buffer[0];
     oled_dirty  = OLED_ALL_BLOCKS_MASK;
+    oled_text_invalidate_all();
 }
 
 static void calc_bounds(uint8_t update_start, uint8_t *cmd_array) {
@@ -271,20 +313,53 @@ static void calc_bounds_90(uint8_t update_start, uint8_t *cmd_array) {
     cmd_array[5] = (OLED_BLOCK_SIZE + OLED_DISPLAY_HEIGHT - 1) % OLED_DISPLAY_HEIGHT / 8;
 }
 
-uint8_t crot(uint8_t a, int8_t n) {
-    const uint8_t mask = 0x7;
-    n &= mask;
-    return a << n | a >> (-n & mask);
+/* Transposes an 8x8 bit tile for the 90 degree rotation: bit i of src[j]
+ * becomes bit 7 - j of dest[i]. */
+#if defined(__AVR__)
+// AVR can only shift by one bit per instruction, so the bits are moved one at a time through the carry
+static void rotate_90(const uint8_t *src, uint8_t *dest) {
+    uint8_t d0 = 0, d1 = 0, d2 = 0, d3 = 0, d4 = 0, d5 = 0, d6 = 0, d7 = 0;
+    for (uint8_t j = 0; j < 8; ++j) {
+        uint8_t row = src[j];
+        d0          = d0 << 1 | (row & 1);
+        d1          = d1 << 1 | (row >> 1 & 1);
+        d2          = d2 << 1 | (row >> 2 & 1);
+        d3          = d3 << 1 | (row >> 3 & 1);
+        d4          = d4 << 1 | (row >> 4 & 1);
+        d5          = d5 << 1 | (row >> 5 & 1);
+        d6          = d6 << 1 | (row >> 6 & 1);
+        d7          = d7 << 1 | (row >> 7);
+    }
+    dest[0] = d0;
+    dest[1] = d1;
+    dest[2] = d2;
+    dest[3] = d3;
+    dest[4] = d4;
+    dest[5] = d5;
+    dest[6] = d6;
+    dest[7] = d7;
 }
-
+#else
+// Swaps the off-diagonal 1x1, 2x2 and 4x4 sub-blocks of the whole tile in three steps
 static void rotate_90(const uint8_t *src, uint8_t *dest) {
-    for (uint8_t i = 0, shift = 7; i < 8; ++i, --shift) {
-        uint8_t selector = (1 << i);
-        for (uint8_t j = 0; j < 8; ++j) {
-            dest[i] |= crot(src[j] & selector, shift - (int8_t)j);
-        }
+    uint64_t x = 0;
+    for (uint8_t j = 0; j < 8; ++j) {
+        x = x << 8 | src[j];
+    }
+
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+
+    for (uint8_t i = 0; i < 8; ++i) {
+        dest[i] = x >> (8 * i);
     }
 }
+#endif
 
 void oled_render(void) {
     if (!oled_initialized) {
@@ -328,8 +403,11 @@ void oled_render(void) {
         const static uint8_t source_map[] = OLED_SOURCE_MAP;
         const static uint8_t target_map[] = OLED_TARGET_MAP;
 
+        // Each tile is overwritten as a whole, so only a block the maps do not cover needs clearing
         static uint8_t temp_buffer[OLED_BLOCK_SIZE];
-        memset(temp_buffer, 0, sizeof(temp_buffer));
+        if (sizeof(source_map) * 8 < OLED_BLOCK_SIZE) {
+            memset(temp_buffer, 0, sizeof(temp_buffer));
+        }
         for (uint8_t i = 0; i < sizeof(source_map); ++i) {
             rotate_90(&oled_buffer[OLED_BLOCK_SIZE * update_start + source_map[i]], &temp_buffer[target_map[i]]);
         }
@@ -412,6 +490,21 @@ void oled_write_char(const char data, bool invert) {
         return;
     }
 
+    uint16_t index = oled_cursor - &oled_buffer[0];
+
+#if OLED_TEXT_CACHE
+    // Nothing to do if the cell already shows this character
+    uint16_t cell = OLED_TEXT_NO_CELL;
+    uint16_t text = OLED_TEXT_VALID | (invert ? OLED_TEXT_INVERTED : 0) | (uint8_t)data;
+    if (index % oled_rotation_width % OLED_FONT_WIDTH == 0) {
+        cell = oled_text_cell(index);
+    }
+    if (cell != OLED_TEXT_NO_CELL && oled_text[cell] == text) {
+        oled_advance_char();
+        return;
+    }
+#endif
+
     // copy the current render buffer to check for dirty after
     static uint8_t oled_temp_buffer[OLED_FONT_WIDTH];
     memcpy(&oled_temp_buffer, oled_cursor, OLED_FONT_WIDTH);
@@ -432,9 +525,18 @@ void oled_write_char(const char data, bool invert) {
         InvertCharacter(oled_cursor);
     }
 
+#if OLED_TEXT_CACHE
+    if (cell != OLED_TEXT_NO_CELL) {
+        oled_text[cell] = text;
+    } else {
+        // Not aligned to the cells, so it overwrote parts of two
+        oled_text_invalidate(index);
+        oled_text_invalidate(index + OLED_FONT_WIDTH - 1);
+    }
+#endif
+
     // Dirty check
     if (memcmp(&oled_temp_buffer, oled_cursor, OLED_FONT_WIDTH)) {
-        uint16_t index = oled_cursor - &oled_buffer[0];
         oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
         // Edgecase check if the written data spans the 2 chunks
         oled_dirty |= ((OLED_BLOCK_TYPE)1 << ((index + OLED_FONT_WIDTH - 1) / OLED_BLOCK_SIZE));
@@ -457,6 +559,14 @@ void oled_write_ln(const char *data, bool invert) {
     oled_advance_page(true);
 }
 
+void oled_write_line(uint8_t line, const char *data, bool invert) {
+    uint8_t chars = oled_rotation_width / OLED_FONT_WIDTH;
+    oled_set_cursor(0, line);
+    for (uint8_t i = 0; i < chars; i++) {
+        oled_write_char(*data ? *data++ : ' ', invert);
+    }
+}
+
 void oled_pan(bool left) {
     uint16_t i = 0;
     for (uint16_t y = 0; y < OLED_DISPLAY_HEIGHT / 8; y++) {
@@ -473,10 +583,13 @@ void oled_pan(bool left) {
         }
     }
     oled_dirty = OLED_ALL_BLOCKS_MASK;
+    oled_text_invalidate_all();
 }
 
 oled_buffer_reader_t oled_read_raw(uint16_t start_index) {
     if (start_index > OLED_MATRIX_SIZE) start_index = OLED_MATRIX_SIZE;
+    // The caller may change the buffer through the reader
+    oled_text_invalidate_all();
     oled_buffer_reader_t ret_reader;
     ret_reader.current_element         = &oled_buffer[start_index];
     ret_reader.remaining_element_count = OLED_MATRIX_SIZE - start_index;
@@ -488,6 +601,7 @@ void oled_write_raw_byte(const char data, uint16_t index) {
     if (oled_buffer[index] == data) return;
     oled_buffer[index] = data;
     oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
+    oled_text_invalidate(index);
 }
 
 void oled_write_raw(const char *data, uint16_t size) {
@@ -498,6 +612,7 @@ void oled_write_raw(const char *data, uint16_t size) {
         if (oled_buffer[i] == c) continue;
         oled_buffer[i] = c;
         oled_dirty |= ((OLED_BLOCK_TYPE)1 << (i / OLED_BLOCK_SIZE));
+        oled_text_invalidate(i);
     }
 }
 
@@ -518,6 +633,7 @@ void oled_write_pixel(uint8_t x, uint8_t y, bool on) {
     if (oled_buffer[index] != data) {
         oled_buffer[index] = data;
         oled_dirty |= ((OLED_BLOCK_TYPE)1 << (index / OLED_BLOCK_SIZE));
+        oled_text_invalidate(index);
     }
 }
 
@@ -535,6 +651,16 @@ void oled_write_ln_P(const char *data, bool invert) {
     oled_advance_page(true);
 }
 
+void oled_write_line_P(uint8_t line, const char *data, bool invert) {
+    uint8_t chars = oled_rotation_width / OLED_FONT_WIDTH;
+    oled_set_cursor(0, line);
+    for (uint8_t i = 0; i < chars; i++) {
+        uint8_t c = pgm_read_byte(data);
+        if (c) data++;
+        oled_write_char(c ? c : ' ', invert);
+    }
+}
+
 void oled_write_raw_P(const char *data, uint16_t size) {
     uint16_t cursor_start_index = oled_cursor - &oled_buffer[0];
     if ((size + cursor_start_index) > OLED_MATRIX_SIZE) size = OLED_MATRIX_SIZE - cursor_start_index;
@@ -543,6 +669,7 @@ void oled_write_raw_P(const char *data, uint16_t size) {
         if (oled_buffer[i] == c) continue;
         oled_buffer[i] = c;
         oled_dirty |= ((OLED_BLOCK_TYPE)1 << (i / OLED_BLOCK_SIZE));
+        oled_text_invalidate(i);
     }
 }
 #endif  // defined(__AVR__)
@@ -7,7 +7,9 @@ from subprocess import DEVNULL
 from argcomplete.completers import FilesCompleter
 from milc import cli
 
+import qmk.compile_cache
 import qmk.path
+from qmk.constants import COMPILE_CACHE_DIR
 from qmk.decorators import automagic_keyboard, automagic_keymap
 from qmk.commands import compile_configurator_json, create_make_command, parse_configurator_json
 from qmk.keyboard import keyboard_completer, keyboard_folder
@@ -21,6 +23,7 @@ from qmk.keymap import keymap_completer
 @cli.argument('-j', '--parallel', type=int, default=1, help="Set the number of parallel make jobs; 0 means unlimited.")
 @cli.argument('-e', '--env', arg_only=True, action='append', default=[], help="Set a variable to be passed to make. May be passed multiple times.")
 @cli.argument('-c', '--clean', arg_only=True, action='store_true', help="Remove object files before compiling.")
+@cli.argument('--cache', action='store_true', help="Reuse identical object files from the compile cache and report its hit rate.")
 @cli.subcommand('Compile a QMK Firmware.')
 @automagic_keyboard
 @automagic_keymap
@@ -44,6 +47,9 @@ def compile(cli):
         else:
             cli.log.warning('Invalid environment variable: %s', env)
 
+    if cli.config.compile.cache:
+        envs.setdefault('USE_COMPILE_CACHE', 'yes')
+
     # Determine the compile command
     command = None
 
@@ -67,8 +73,15 @@ def compile(cli):
         cli.log.info('Compiling keymap with {fg_cyan}%s', ' '.join(command))
         if not cli.args.dry_run:
             cli.echo('\n')
+            cache_dir = envs.get('COMPILE_CACHE_DIR', COMPILE_CACHE_DIR)
+            stats_before = qmk.compile_cache.read_stats(cache_dir)
+
             # FIXME(skullydazed/anyone): Remove text=False once milc 1.0.11 has had enough time to be installed everywhere.
             compile = cli.run(command, capture_output=False, text=False)
+
+            if cli.config.compile.cache:
+                cli.log.info(qmk.compile_cache.report(stats_before, qmk.compile_cache.read_stats(cache_dir)).capitalize())
+
             return compile.returncode
 
     else:
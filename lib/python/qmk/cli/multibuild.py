@@ -2,15 +2,21 @@
 
 This will compile everything in parallel, for testing purposes.
 """
+import hashlib
 import os
 import re
+from concurrent.futures import FIRST_COMPLETED, ThreadPoolExecutor, wait
 from pathlib import Path
-from subprocess import DEVNULL
+from subprocess import DEVNULL, STDOUT
+from time import monotonic
 
 from milc import cli
 
-from qmk.constants import QMK_FIRMWARE
+from qmk.constants import COMPILE_CACHE_DIR, QMK_FIRMWARE
 from qmk.commands import _find_make, get_make_parallel_args
+from qmk.json_schema import json_load
+import qmk.compile_cache
+import qmk.info
 import qmk.keyboard
 import qmk.keymap
 
@@ -28,8 +34,87 @@ def _is_split(keyboard_name):
     return True if 'SPLIT_KEYBOARD' in rules_mk and rules_mk['SPLIT_KEYBOARD'].lower() == 'yes' else False
 
 
+def _build_group(keyboard_name):
+    """Returns the key of the group of keyboards that are likely to produce identical object files.
+
+    Keyboards are grouped by their processor and a hash of the features enabled in rules.mk.
+    """
+    rules_mk = qmk.keyboard.rules_mk(keyboard_name)
+    processor = rules_mk.get('MCU')
+
+    if not processor:
+        for info_file in qmk.info.find_info_json(keyboard_name):
+            processor = json_load(info_file).get('processor')
+            if processor:
+                break
+
+    features = sorted(f'{key}={value.lower()}' for key, value in rules_mk.items() if key.endswith('_ENABLE') or key in ('SPLIT_KEYBOARD', 'BOOTLOADER'))
+    features_hash = hashlib.sha1('\n'.join(features).encode()).hexdigest()[:8]
+
+    return f'{processor}:{features_hash}'
+
+
+def _grouped_build(make_cmd, keyboard_list, keymap, parallel):
+    """Build each keyboard with its own make, scheduling them across all cores and sharing objects through the compile cache.
+
+    The first keyboard of every group is built on its own, the rest of the group is only queued once it has populated the cache.
+    """
+    builddir = Path(QMK_FIRMWARE) / '.build'
+    cache_dir = Path(QMK_FIRMWARE) / COMPILE_CACHE_DIR
+    stats_before = qmk.compile_cache.read_stats(cache_dir)
+
+    groups = {}
+    for keyboard_name in keyboard_list:
+        groups.setdefault(_build_group(keyboard_name), []).append(keyboard_name)
+
+    cli.log.info(f'Building {len(keyboard_list)} keyboards in {len(groups)} groups')
+
+    def build(keyboard_name):
+        keyboard_safe = keyboard_name.replace('/', '_')
+        build_log = builddir / f'build.log.{os.getpid()}.{keyboard_safe}'
+        command = [
+            make_cmd, '-C', QMK_FIRMWARE.as_posix(), '-f', f'{QMK_FIRMWARE}/build_keyboard.mk', f'KEYBOARD={keyboard_name}', f'KEYMAP={keymap}', 'REQUIRE_PLATFORM_KEY=', 'COLOR=true', 'SILENT=false', 'USE_COMPILE_CACHE=yes', f'COMPILE_CACHE_DIR={cache_dir.as_posix()}'
+        ]
+
+        start = monotonic()
+        with open(build_log, 'w') as log:
+            result = cli.run(command, capture_output=False, stdin=DEVNULL, stdout=log, stderr=STDOUT)
+        elapsed = monotonic() - start
+
+        output = build_log.read_text(errors='replace')
+        if result.returncode != 0 or '[ERRORS]' in output:
+            status = '{fg_red}[ERRORS]'
+            build_log.replace(builddir / f'failed.log.{os.getpid()}.{keyboard_safe}')
+        else:
+            status = '{fg_yellow}[WARNINGS]' if '[WARNINGS]' in output else '{fg_green}[OK]'
+            build_log.unlink()
+
+        return keyboard_name, status, elapsed
+
+    timings = []
+    start = monotonic()
+    with ThreadPoolExecutor(max_workers=parallel if parallel > 0 else os.cpu_count()) as executor:
+        pending = {executor.submit(build, members[0]): members[1:] for members in groups.values()}
+
+        while pending:
+            done, _ = wait(pending, return_when=FIRST_COMPLETED)
+            for future in done:
+                for keyboard_name in pending.pop(future):
+                    pending[executor.submit(build, keyboard_name)] = []
+
+                keyboard_name, status, elapsed = future.result()
+                timings.append((elapsed, keyboard_name))
+                cli.echo(f'[{len(timings)}/{len(keyboard_list)}] Build {keyboard_name + ":" + keymap:<64} {{style_bright}}{status}{{style_reset_all}} {elapsed:6.1f}s')
+
+    stats_after = qmk.compile_cache.read_stats(cache_dir)
+    cli.log.info(f'Built {len(keyboard_list)} keyboards in {monotonic() - start:.1f}s, {qmk.compile_cache.report(stats_before, stats_after)}')
+    for elapsed, keyboard_name in sorted(timings, reverse=True)[:5]:
+        cli.log.info(f'Slowest: {keyboard_name}:{keymap} {elapsed:.1f}s')
+
+
 @cli.argument('-j', '--parallel', type=int, default=1, help="Set the number of parallel make jobs; 0 means unlimited.")
 @cli.argument('-c', '--clean', arg_only=True, action='store_true', help="Remove object files before compiling.")
+@cli.argument('-g', '--grouped', arg_only=True, action='store_true', help="Group keyboards by processor and enabled features and share identical object files between them through the compile cache.")
 @cli.argument('-f', '--filter', arg_only=True, action='append', default=[], help="Filter the list of keyboards based on the supplied value in rules.mk. Supported format is 'SPLIT_KEYBOARD=yes'. May be passed multiple times.")
 @cli.argument('-km', '--keymap', type=str, default='default', help="The keymap name to build. Default is 'default'.")
 @cli.subcommand('Compile QMK Firmware for all keyboards.', hidden=False if cli.config.user.developer else True)
@@ -58,6 +143,17 @@ def multibuild(cli):
         return
 
     builddir.mkdir(parents=True, exist_ok=True)
+
+    if cli.args.grouped:
+        keyboard_list = [keyboard_name for keyboard_name in keyboard_list if qmk.keymap.locate_keymap(keyboard_name, cli.args.keymap) is not None]
+        _grouped_build(make_cmd, keyboard_list, cli.args.keymap, cli.args.parallel)
+
+        failures = [f for f in builddir.glob(f'failed.log.{os.getpid()}.*')]
+        if len(failures) > 0:
+            return False
+
+        return
+
     with open(makefile, "w") as f:
         for keyboard_name in keyboard_list:
             if qmk.keymap.locate_keymap(keyboard_name, cli.args.keymap) is not None:
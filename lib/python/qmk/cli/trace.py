@@ -0,0 +1,96 @@
+"""Decode the binary event trace of a keyboard.
+"""
+from milc import cli
+
+import qmk.path
+from qmk.trace import CONSOLE_USAGE, CONSOLE_USAGE_PAGE, PACKET_SIZE, RAW_USAGE, RAW_USAGE_PAGE, decode_buffer, decode_packet, decode_stream, event_name, format_record, unwrap_times
+
+
+def _print_records(records, last):
+    """Prints records with the time since the previous one, and returns the last record printed.
+    """
+    for record in unwrap_times(records, last):
+        delta = record.time - last.time if last else 0
+        print('%10d ms %+6d  %-20s %s' % (record.time, delta, event_name(record.event), format_record(record)))
+        last = record
+
+    return last
+
+
+def _find_device(device, usage_page, usage):
+    """Returns the hidapi description of the first matching interface.
+    """
+    import hid
+
+    vid = pid = None
+    if device:
+        vid, pid = (int(part, 16) for part in device.split(':'))
+
+    for interface in hid.enumerate(vid or 0, pid or 0):
+        if interface['usage_page'] == usage_page and interface['usage'] == usage:
+            return interface
+
+    return None
+
+
+def _read_device(interface, console, output):
+    import hid
+
+    cli.log.info('Reading trace from {fg_cyan}%s %s{fg_reset}, press Ctrl-C to stop.', interface['manufacturer_string'], interface['product_string'])
+
+    last = None
+    pending = b''
+    with hid.Device(path=interface['path']) as device:
+        while True:
+            packet = device.read(PACKET_SIZE, 1000)
+            if not packet:
+                continue
+            if output:
+                output.write(packet)
+                output.flush()
+            if console:
+                # Other console output can shift the trace packets across reports
+                records, pending = decode_buffer(pending + packet)
+            else:
+                records = decode_packet(packet)
+            last = _print_records(records, last)
+
+
+@cli.argument('-d', '--device', arg_only=True, help='Only read from the keyboard with this VID:PID, in hex. Example: 03a8:0068')
+@cli.argument('-c', '--console', arg_only=True, action='store_true', help='Read the trace from the console instead of raw HID')
+@cli.argument('-o', '--output', arg_only=True, type=qmk.path.normpath, help='Also write the packets received to this file, to decode later with --file')
+@cli.argument('-f', '--file', arg_only=True, type=qmk.path.normpath, help='Decode a file of packets instead of reading from a keyboard')
+@cli.subcommand('Decodes the binary event trace of a keyboard built with TRACE_ENABLE.')
+def trace(cli):
+    """Prints the events a keyboard streams with TRACE_ENABLE, one per line.
+    """
+    if cli.args.file:
+        if not cli.args.file.exists():
+            cli.log.error('File not found: %s', cli.args.file)
+            return False
+
+        _print_records(decode_stream(cli.args.file.read_bytes()), None)
+        return True
+
+    usage_page, usage = (CONSOLE_USAGE_PAGE, CONSOLE_USAGE) if cli.args.console else (RAW_USAGE_PAGE, RAW_USAGE)
+
+    try:
+        interface = _find_device(cli.args.device, usage_page, usage)
+    except ImportError:
+        cli.log.error('Reading from a keyboard needs hidapi, install the python requirements first.')
+        return False
+
+    if not interface:
+        cli.log.error('No keyboard with a %s interface found.', 'console' if cli.args.console else 'raw HID')
+        return False
+
+    output = cli.args.output.open('wb') if cli.args.output else None
+    try:
+        _read_device(interface, cli.args.console, output)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if output:
+            output.close()
+
+    return True
@@ -0,0 +1,307 @@
+"""Content-addressed object cache for the QMK build.
+
+This is used as a compiler prefix by the make system (see `USE_COMPILE_CACHE` in tmk_core/rules.mk):
+
+    python3 -m qmk.compile_cache <cache dir> [--max-size <MiB>] -- <compiler> <compiler arguments>
+
+Compiles of a single C/C++ source file are looked up by a hash of the compiler, the flags that affect code generation and the preprocessed source. Include paths, defines and `-include`d config headers are only hashed through their effect on the preprocessed source, so objects that end up identical are shared between keymaps and keyboards. Everything else (linking, `--version`, ...) is passed straight through to the compiler.
+
+Once the objects take up more than the maximum size, the least recently used ones are removed.
+
+This module is deliberately standalone, it runs once per compiled object and must not pay the cost of importing milc or the rest of the qmk package.
+"""
+import hashlib
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+from contextlib import contextmanager
+from pathlib import Path
+
+try:
+    import fcntl
+except ImportError:
+    fcntl = None
+    import msvcrt
+
+# Bump when the hash inputs change
+CACHE_VERSION = '1'
+
+CACHEABLE_SOURCES = ('.c', '.cc', '.cpp')
+
+# Arguments whose effect is fully captured by the preprocessed source
+PREPROCESSOR_ARGS = ('-MMD', '-MD', '-MP')
+PREPROCESSOR_ARGS_WITH_VALUE = ('-I', '-D', '-U', '-include', '-imacros', '-isystem', '-iquote', '-MF', '-MT', '-MQ')
+
+# Arguments that need the real compiler to run, as they print or write more than the object.
+# -flto is hashed like any other code generation flag, the LTO bytecode only depends on the inputs.
+UNCACHEABLE_ARGS = ('-v', '-H', '-E', '-M', '-MM', '-save-temps')
+
+# Line markers only carry file names, which differ between build directories
+LINE_MARKER_RE = re.compile(rb'^(# \d+) "[^"\n]*"', re.MULTILINE)
+
+DEFAULT_MAX_SIZE = 2048 * 1024 * 1024
+
+# Trimming stops once the objects fit in this fraction of the maximum size, so it does not run on every miss
+TRIM_TARGET = 0.8
+
+STATS = ('hits', 'misses', 'size')
+
+
+def stats_dir(cache_dir):
+    return Path(cache_dir) / 'stats'
+
+
+def objects_dir(cache_dir):
+    return Path(cache_dir) / 'objects'
+
+
+@contextmanager
+def _locked_stats(cache_dir):
+    """Opens the stats file with an exclusive lock, so the parallel compiles update it in turn.
+    """
+    path = stats_dir(cache_dir) / 'counters'
+    path.parent.mkdir(parents=True, exist_ok=True)
+
+    with open(path, 'a+') as f:
+        f.seek(0)
+        if fcntl:
+            fcntl.flock(f, fcntl.LOCK_EX)
+        else:
+            msvcrt.locking(f.fileno(), msvcrt.LK_LOCK, 1)
+        try:
+            yield f
+        finally:
+            f.seek(0)
+            if fcntl:
+                fcntl.flock(f, fcntl.LOCK_UN)
+            else:
+                msvcrt.locking(f.fileno(), msvcrt.LK_UNLCK, 1)
+
+
+def _parse_stats(text):
+    values = text.split()
+    if len(values) != len(STATS) or not all(value.isdigit() for value in values):
+        return dict.fromkeys(STATS, 0)
+
+    return dict(zip(STATS, map(int, values)))
+
+
+def record(cache_dir, event, size=0, max_size=None):
+    """Count a cache hit or miss, and add `size` bytes of new objects.
+
+    Trims the cache when it has grown past `max_size`.
+    """
+    with _locked_stats(cache_dir) as f:
+        stats = _parse_stats(f.read())
+        stats[event] += 1
+        stats['size'] += size
+
+        if max_size is not None and stats['size'] > max_size:
+            stats['size'] = trim(cache_dir, int(max_size * TRIM_TARGET))
+
+        f.seek(0)
+        f.truncate()
+        f.write(' '.join(str(stats[key]) for key in STATS) + '\n')
+
+
+def read_stats(cache_dir):
+    """Returns a dictionary with the number of hits and misses and the size of the objects recorded in `cache_dir`.
+    """
+    path = stats_dir(cache_dir) / 'counters'
+
+    return _parse_stats(path.read_text()) if path.exists() else dict.fromkeys(STATS, 0)
+
+
+def trim(cache_dir, target):
+    """Removes the least recently used objects until the rest take up at most `target` bytes, and returns their size.
+
+    Hits touch their object, so the modification time is the time of last use.
+    """
+    entries = []
+    # Only finished entries, the temporary files of a parallel _store() are left alone
+    paths = [*objects_dir(cache_dir).glob('*/*.o'), *objects_dir(cache_dir).glob('*/*.stderr')]
+    for path in paths:
+        try:
+            stat = path.stat()
+        except FileNotFoundError:
+            continue
+        entries.append((stat.st_mtime_ns, stat.st_size, path))
+
+    total = sum(size for _, size, _ in entries)
+    for _, size, path in sorted(entries):
+        if total <= target:
+            break
+        try:
+            path.unlink()
+        except FileNotFoundError:
+            pass
+        total -= size
+
+    return total
+
+
+def report(before, after):
+    """Returns a summary of the cache activity between two `read_stats()` results.
+    """
+    hits = after['hits'] - before['hits']
+    misses = after['misses'] - before['misses']
+    hit_rate = 100 * hits / (hits + misses) if hits + misses else 0
+
+    return f'compile cache hit rate {hit_rate:.1f}% ({hits} hits, {misses} misses)'
+
+
+def _parse_args(args):
+    """Splits the compiler arguments into the ones that are hashed and the ones that only matter for the preprocessor.
+
+    Returns a tuple of (source, output, hashed arguments, preprocessor arguments), or None when this compile can not be cached.
+    """
+    source = None
+    output = None
+    compile_only = False
+    hashed = []
+    preprocess = []
+
+    i = 0
+    while i < len(args):
+        arg = args[i]
+
+        if arg in UNCACHEABLE_ARGS:
+            return None
+
+        elif arg == '-c':
+            compile_only = True
+
+        elif arg == '-o':
+            i += 1
+            output = args[i] if i < len(args) else None
+
+        elif arg in PREPROCESSOR_ARGS:
+            preprocess.append(arg)
+
+        elif arg in PREPROCESSOR_ARGS_WITH_VALUE:
+            preprocess.extend(args[i:i + 2])
+            i += 1
+
+        elif arg.startswith(PREPROCESSOR_ARGS_WITH_VALUE):
+            preprocess.append(arg)
+
+        elif arg.startswith('-Wa,-adhlns='):
+            # AVR assembler listings are a side output named after the object
+            pass
+
+        elif not arg.startswith('-'):
+            if source is not None:
+                return None
+            source = arg
+
+        else:
+            hashed.append(arg)
+            preprocess.append(arg)
+
+        i += 1
+
+    if not compile_only or source is None or output is None or not source.endswith(CACHEABLE_SOURCES):
+        return None
+
+    return source, output, hashed, preprocess
+
+
+def _compiler_identity(compiler):
+    """Identifies the compiler by its resolved path, size and modification time.
+    """
+    path = shutil.which(compiler)
+    if path is None:
+        return compiler.encode()
+
+    path = os.path.realpath(path)
+    stat = os.stat(path)
+
+    return f'{path}:{stat.st_size}:{stat.st_mtime_ns}'.encode()
+
+
+def _store(path, data):
+    """Atomically write `data` to `path`, so concurrent builds never see a partial object.
+    """
+    path.parent.mkdir(parents=True, exist_ok=True)
+    fd, tmp = tempfile.mkstemp(dir=path.parent)
+    with os.fdopen(fd, 'wb') as f:
+        f.write(data)
+    os.replace(tmp, path)
+
+
+def cached_compile(cache_dir, command, max_size=DEFAULT_MAX_SIZE):
+    """Run a compile through the cache. Returns the compiler's exit code.
+    """
+    parsed = _parse_args(command[1:])
+    if parsed is None:
+        return subprocess.run(command).returncode
+
+    source, output, hashed, preprocess = parsed
+
+    # Preprocess first; this also writes the dependency file make expects from the real compile
+    if any(arg in ('-MMD', '-MD') for arg in preprocess) and not any(arg in ('-MT', '-MQ') for arg in preprocess):
+        preprocess += ['-MT', output]
+
+    preprocessed = subprocess.run([command[0], '-E', *preprocess, source], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+    if preprocessed.returncode != 0:
+        # Let the real compile report the error
+        return subprocess.run(command).returncode
+
+    digest = hashlib.sha256()
+    for part in (CACHE_VERSION.encode(), _compiler_identity(command[0]), '\0'.join(hashed).encode(), os.path.splitext(source)[1].encode()):
+        digest.update(part)
+        digest.update(b'\0')
+    digest.update(LINE_MARKER_RE.sub(rb'\1', preprocessed.stdout))
+
+    key = digest.hexdigest()
+    cached_object = objects_dir(cache_dir) / key[:2] / f'{key[2:]}.o'
+    cached_stderr = cached_object.with_suffix('.stderr')
+
+    try:
+        shutil.copyfile(cached_object, output)
+        os.utime(cached_object)
+        if cached_stderr.exists():
+            sys.stderr.buffer.write(cached_stderr.read_bytes())
+            os.utime(cached_stderr)
+        record(cache_dir, 'hits')
+        return 0
+    except FileNotFoundError:
+        # Not cached yet, or trimmed by a parallel compile
+        pass
+
+    result = subprocess.run(command, stderr=subprocess.PIPE)
+    sys.stderr.buffer.write(result.stderr)
+
+    if result.returncode == 0:
+        # Keep the warnings so a later hit still reports them
+        size = 0
+        if result.stderr:
+            _store(cached_stderr, result.stderr)
+            size += len(result.stderr)
+        data = Path(output).read_bytes()
+        _store(cached_object, data)
+        size += len(data)
+        record(cache_dir, 'misses', size, max_size)
+
+    return result.returncode
+
+
+def main(argv):
+    max_size = DEFAULT_MAX_SIZE
+    args = argv[2:]
+    if len(args) > 2 and args[0] == '--max-size' and args[1].isdigit():
+        max_size = int(args[1]) * 1024 * 1024
+        args = args[2:]
+
+    if len(args) < 2 or args[0] != '--':
+        print('usage: python3 -m qmk.compile_cache <cache dir> [--max-size <MiB>] -- <compiler> [args...]', file=sys.stderr)
+        return 2
+
+    return cached_compile(argv[1], args[1:], max_size)
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -36,3 +36,4 @@ LED_INDICATORS = {
 # Constants that should match their counterparts in make
 BUILD_DIR = environ.get('BUILD_DIR', '.build')
 KEYBOARD_OUTPUT_PREFIX = f'{BUILD_DIR}/obj_'
+COMPILE_CACHE_DIR = f'{BUILD_DIR}/cache'
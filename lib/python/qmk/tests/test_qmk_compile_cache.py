@@ -0,0 +1,139 @@
+import os
+import sys
+from pathlib import Path
+
+from qmk.compile_cache import cached_compile, main, objects_dir, read_stats, record, report, trim
+
+# Stands in for gcc: -E prints the source, -c writes it to the object with a warning. Every
+# compile is logged, and like gcc, -MT without -MD or -MMD is an error.
+STUB_COMPILER = f"""#!{sys.executable}
+import sys
+args = sys.argv[1:]
+source = [arg for arg in args if arg.endswith('.c')][0]
+text = open(source).read()
+if '-MT' in args and '-MD' not in args and '-MMD' not in args:
+    sys.exit(1)
+if '-E' in args:
+    print(text)
+    sys.exit(0)
+with open(sys.argv[0] + '.log', 'a') as log:
+    log.write(' '.join(args) + '\\n')
+open(args[args.index('-o') + 1], 'w').write('object of ' + text)
+sys.stderr.write('warning: ' + text)
+"""
+
+
+def _stub_compiler(tmp_path):
+    compiler = tmp_path / 'cc'
+    compiler.write_text(STUB_COMPILER)
+    compiler.chmod(0o755)
+    return compiler
+
+
+def _compiles(compiler):
+    log = Path(f'{compiler}.log')
+    return len(log.read_text().splitlines()) if log.exists() else 0
+
+
+def _store_object(cache_dir, name, size, mtime):
+    path = objects_dir(cache_dir) / name[:2] / f'{name[2:]}.o'
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_bytes(bytes(size))
+    os.utime(path, (mtime, mtime))
+    return path
+
+
+def test_stats_are_counted(tmp_path):
+    assert read_stats(tmp_path) == {'hits': 0, 'misses': 0, 'size': 0}
+
+    for _ in range(300):
+        record(tmp_path, 'hits')
+    record(tmp_path, 'misses', 100)
+
+    stats = read_stats(tmp_path)
+    assert stats == {'hits': 300, 'misses': 1, 'size': 100}
+    assert report({'hits': 0, 'misses': 0}, stats) == 'compile cache hit rate 99.7% (300 hits, 1 misses)'
+    # The counters do not grow with the number of events
+    assert (tmp_path / 'stats' / 'counters').stat().st_size < 20
+
+
+def test_trim_removes_least_recently_used(tmp_path):
+    old = _store_object(tmp_path, 'aa01', 100, 1000)
+    used = _store_object(tmp_path, 'bb02', 100, 3000)
+    new = _store_object(tmp_path, 'cc03', 100, 2000)
+
+    assert trim(tmp_path, 200) == 200
+    assert not old.exists()
+    assert used.exists() and new.exists()
+
+
+def test_record_trims_past_the_maximum_size(tmp_path):
+    for i in range(10):
+        _store_object(tmp_path, f'{i:02}ff', 100, 1000 + i)
+        record(tmp_path, 'misses', 100, 500)
+
+    stats = read_stats(tmp_path)
+    assert stats['misses'] == 10
+    assert stats['size'] <= 500
+    assert stats['size'] == sum(path.stat().st_size for path in objects_dir(tmp_path).glob('*/*'))
+    # The most recent object is kept
+    assert (objects_dir(tmp_path) / '09' / 'ff.o').exists()
+
+
+def test_main_usage():
+    assert main(['compile_cache', 'dir']) == 2
+    assert main(['compile_cache', 'dir', '--max-size', 'x', '--', 'gcc']) == 2
+
+
+def test_cached_compile(tmp_path, capfd):
+    cache = tmp_path / 'cache'
+    compiler = str(_stub_compiler(tmp_path))
+    source = tmp_path / 'a.c'
+    source.write_text('int a;\n')
+    output = tmp_path / 'a.o'
+
+    # A miss runs the compiler and stores the object and its warnings
+    assert cached_compile(cache, [compiler, '-c', '-Os', '-flto', str(source), '-o', str(output)]) == 0
+    assert _compiles(compiler) == 1
+    assert read_stats(cache)['misses'] == 1
+    assert capfd.readouterr().err == 'warning: int a;\n'
+
+    # A hit copies the object back and replays the warnings, without compiling
+    output.unlink()
+    assert cached_compile(cache, [compiler, '-c', '-Os', '-flto', str(source), '-o', str(output)]) == 0
+    assert _compiles(compiler) == 1
+    assert read_stats(cache)['hits'] == 1
+    assert output.read_text() == 'object of int a;\n'
+    assert capfd.readouterr().err == 'warning: int a;\n'
+
+    # Different code generation flags are a different object
+    assert cached_compile(cache, [compiler, '-c', '-O2', '-flto', str(source), '-o', str(output)]) == 0
+    assert _compiles(compiler) == 2
+
+    # Dependency files are written during preprocessing
+    assert cached_compile(cache, [compiler, '-c', '-Os', '-MMD', '-MF', str(tmp_path / 'a.d'), str(source), '-o', str(output)]) == 0
+    assert read_stats(cache)['misses'] == 3
+
+
+def test_cached_compile_falls_back(tmp_path, capfd):
+    cache = tmp_path / 'cache'
+    compiler = str(_stub_compiler(tmp_path))
+    source = tmp_path / 'a.c'
+    source.write_text('int a;\n')
+    output = tmp_path / 'a.o'
+
+    for _ in range(2):
+        assert cached_compile(cache, [compiler, '-c', '-save-temps', str(source), '-o', str(output)]) == 0
+    assert _compiles(compiler) == 2
+    assert read_stats(cache) == {'hits': 0, 'misses': 0, 'size': 0}
+    assert output.read_text() == 'object of int a;\n'
+
+
+def test_trim_leaves_temporary_files(tmp_path):
+    _store_object(tmp_path, 'aa01', 100, 1000)
+    temporary = objects_dir(tmp_path) / 'aa' / 'tmpabcd'
+    temporary.write_bytes(bytes(100))
+
+    assert trim(tmp_path, 0) == 0
+    assert temporary.exists()
+
@@ -0,0 +1,51 @@
+import struct
+
+from qmk.trace import PACKET_MAGIC, PACKET_SIZE, RECORD, TRACE_KEY, TRACE_OVERFLOW, TRACE_REPORT_MOUSE, TRACE_USER, TraceRecord, decode_buffer, decode_packet, decode_stream, event_name, format_record, unwrap_times
+
+
+def make_packet(*records):
+    packet = bytes([PACKET_MAGIC, len(records)]) + b''.join(RECORD.pack(*record) for record in records)
+    return packet + bytes(PACKET_SIZE - len(packet))
+
+
+def test_decode_packet():
+    packet = make_packet((100, TRACE_KEY, 1, 0x0102, 99), (101, TRACE_OVERFLOW, 0, 7, 0))
+    assert decode_packet(packet) == [TraceRecord(100, TRACE_KEY, 1, 0x0102, 99), TraceRecord(101, TRACE_OVERFLOW, 0, 7, 0)]
+
+
+def test_decode_packet_skips_other_traffic():
+    assert decode_packet(b'hello world'.ljust(PACKET_SIZE, b'\0')) == []
+    assert decode_packet(bytes([PACKET_MAGIC, 200]) + bytes(PACKET_SIZE - 2)) == []
+
+
+def test_decode_stream():
+    data = make_packet((1, TRACE_KEY, 1, 0, 0)) + b'\0' * PACKET_SIZE + make_packet((2, TRACE_KEY, 0, 0, 0))
+    assert [record.time for record in decode_stream(data)] == [1, 2]
+
+
+def test_decode_stream_resyncs():
+    # Text, a header with a bad length and a packet cut short, between packets that do not line up with the report size
+    data = b'debug\n' + make_packet((1, TRACE_KEY, 1, 0, 0)) + bytes([PACKET_MAGIC, 9]) + make_packet((2, TRACE_KEY, 0, 0, 0))[:20] + make_packet((3, TRACE_USER, 0, 0, 0))
+    assert [record.time for record in decode_stream(data)] == [1, 3]
+
+
+def test_decode_buffer_keeps_partial_packet():
+    packet = make_packet((1, TRACE_KEY, 1, 0, 0))
+    records, pending = decode_buffer(b'x' + packet[:10])
+    assert records == []
+    records, pending = decode_buffer(pending + packet[10:])
+    assert [record.time for record in records] == [1]
+    assert pending == b''
+
+
+def test_unwrap_times():
+    records = [TraceRecord(t, TRACE_USER, 0, 0, 0) for t in (65530, 65535, 4, 10)]
+    assert [record.time for record in unwrap_times(records)] == [65530, 65535, 65540, 65546]
+
+
+def test_format_record():
+    assert event_name(TRACE_KEY) == 'key'
+    assert event_name(TRACE_USER + 2) == 'user_2'
+    assert format_record(TraceRecord(0, TRACE_KEY, 1, 0x0203, 50)) == '(2,3) pressed at 50'
+    x, y = struct.unpack('<HH', struct.pack('<hh', -5, 3))
+    assert format_record(TraceRecord(0, TRACE_REPORT_MOUSE, 1, x, y)) == 'buttons=0x01 x=-5 y=3'
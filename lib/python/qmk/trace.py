@@ -0,0 +1,176 @@
+"""Decoder for the binary event trace streamed by keyboards built with `TRACE_ENABLE = yes`.
+
+The layout has to be kept in sync with quantum/logging/trace.h.
+"""
+import struct
+from collections import namedtuple
+
+PACKET_SIZE = 32
+PACKET_MAGIC = 0x54
+PACKET_HEADER_SIZE = 2
+
+RAW_USAGE_PAGE = 0xFF60
+RAW_USAGE = 0x61
+CONSOLE_USAGE_PAGE = 0xFF31
+CONSOLE_USAGE = 0x74
+
+RECORD = struct.Struct('<HBBHH')
+RECORDS_PER_PACKET = (PACKET_SIZE - PACKET_HEADER_SIZE) // RECORD.size
+
+TRACE_OVERFLOW = 0
+TRACE_KEY = 1
+TRACE_LAYER_STATE = 2
+TRACE_DEFAULT_LAYER_STATE = 3
+TRACE_TAPPING_KEY = 4
+TRACE_REPORT_KEYBOARD = 5
+TRACE_REPORT_MOUSE = 6
+TRACE_REPORT_SYSTEM = 7
+TRACE_REPORT_CONSUMER = 8
+TRACE_SPLIT_TRANSACTION = 9
+TRACE_USER = 0x80
+
+EVENT_NAMES = {
+    TRACE_OVERFLOW: 'overflow',
+    TRACE_KEY: 'key',
+    TRACE_LAYER_STATE: 'layer_state',
+    TRACE_DEFAULT_LAYER_STATE: 'default_layer_state',
+    TRACE_TAPPING_KEY: 'tapping_key',
+    TRACE_REPORT_KEYBOARD: 'report_keyboard',
+    TRACE_REPORT_MOUSE: 'report_mouse',
+    TRACE_REPORT_SYSTEM: 'report_system',
+    TRACE_REPORT_CONSUMER: 'report_consumer',
+    TRACE_SPLIT_TRANSACTION: 'split_transaction',
+}
+
+TraceRecord = namedtuple('TraceRecord', ['time', 'event', 'arg', 'data0', 'data1'])
+
+
+def _is_packet(data, offset=0):
+    """Returns True if a trace packet starts at `offset`.
+
+    Besides the header, the space after the records has to be zero, which other traffic rarely is.
+    """
+    if len(data) - offset < PACKET_SIZE or data[offset] != PACKET_MAGIC:
+        return False
+
+    count = data[offset + 1]
+    if count < 1 or count > RECORDS_PER_PACKET:
+        return False
+
+    end = offset + PACKET_HEADER_SIZE + count * RECORD.size
+    return not any(data[end:offset + PACKET_SIZE])
+
+
+def _unpack(data, offset=0):
+    records = []
+    for i in range(data[offset + 1]):
+        records.append(TraceRecord(*RECORD.unpack_from(data, offset + PACKET_HEADER_SIZE + i * RECORD.size)))
+
+    return records
+
+
+def decode_packet(packet):
+    """Returns the records in one packet, or an empty list if it is not a trace packet.
+
+    Raw HID and the console carry other traffic too, which is skipped.
+    """
+    if not _is_packet(packet):
+        return []
+
+    return _unpack(packet)
+
+
+def decode_buffer(data):
+    """Decodes the packets in a stream of bytes that may have other output between them.
+
+    Where no packet starts, the decoder moves on by one byte and tries again, so it finds the next packet after text or lost bytes. Returns the records and the bytes at the end that are too short to be a packet yet, to be put in front of the next data received.
+    """
+    records = []
+    offset = 0
+    while len(data) - offset >= PACKET_SIZE:
+        if _is_packet(data, offset):
+            records.extend(_unpack(data, offset))
+            offset += PACKET_SIZE
+        else:
+            offset += 1
+
+    return records, data[offset:]
+
+
+def decode_stream(data):
+    """Decodes a dump of packets, skipping anything between them.
+    """
+    records, _ = decode_buffer(data)
+    return records
+
+
+def unwrap_times(records, last=None):
+    """Replaces the 16 bit millisecond timestamps with ones that keep counting up past 65535.
+
+    Pass the last record of a previous call as `last` to continue a stream.
+    """
+    unwrapped = []
+    for record in records:
+        if last is None:
+            time = record.time
+        else:
+            time = last.time + ((record.time - last.time) & 0xFFFF)
+        last = record._replace(time=time)
+        unwrapped.append(last)
+
+    return unwrapped
+
+
+def _signed(value):
+    return value - 0x10000 if value & 0x8000 else value
+
+
+def _key(value):
+    return '(%d,%d)' % (value >> 8, value & 0xFF)
+
+
+def format_record(record):
+    """Returns a human readable description of the arguments of a record.
+    """
+    event = record.event
+
+    if event == TRACE_OVERFLOW:
+        return '%d events lost' % record.data0
+
+    if event == TRACE_KEY:
+        return '%s %s at %d' % (_key(record.data0), 'pressed' if record.arg else 'released', record.data1)
+
+    if event in (TRACE_LAYER_STATE, TRACE_DEFAULT_LAYER_STATE):
+        return '0x%08X' % (record.data1 << 16 | record.data0)
+
+    if event == TRACE_TAPPING_KEY:
+        return '%s %s count=%d%s at %d' % (
+            _key(record.data0),
+            'pressed' if record.arg & 0x80 else 'released',
+            record.arg & 0x0F,
+            ' interrupted' if record.arg & 0x40 else '',
+            record.data1,
+        )
+
+    if event == TRACE_REPORT_KEYBOARD:
+        return 'mods=0x%02X first=0x%02X keys=%d' % (record.arg, record.data0, record.data1)
+
+    if event == TRACE_REPORT_MOUSE:
+        return 'buttons=0x%02X x=%d y=%d' % (record.arg, _signed(record.data0), _signed(record.data1))
+
+    if event in (TRACE_REPORT_SYSTEM, TRACE_REPORT_CONSUMER):
+        return 'usage=0x%04X' % record.data0
+
+    if event == TRACE_SPLIT_TRANSACTION:
+        return 'id=%d %s sent=%d received=%d' % (record.arg, 'ok' if record.data0 else 'failed', record.data1 >> 8, record.data1 & 0xFF)
+
+    return 'arg=0x%02X data=0x%04X 0x%04X' % (record.arg, record.data0, record.data1)
+
+
+def event_name(event):
+    """Returns the name of an event id.
+    """
+    if event >= TRACE_USER:
+        return 'user_%d' % (event - TRACE_USER)
+
+    return EVENT_NAMES.get(event, 'unknown_%d' % event)
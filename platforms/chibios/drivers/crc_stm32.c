@@ -0,0 +1,72 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <hal.h>
+
+#include "crc.h"
+
+/* The CRC unit of the STM32F1, F2, F4 and L1 families can only calculate
+ * CRC-32. The other families can be configured for the 8 and 16 bit
+ * polynomials used by the software implementations. */
+#if !defined(CRC_CR_POLYSIZE)
+#    error "The CRC unit of this MCU does not support programmable polynomials, use CRC_DRIVER = software"
+#endif
+
+#if defined(RCC_AHBENR_CRCEN)
+#    define CRC_ENABLE_CLOCK() (RCC->AHBENR |= RCC_AHBENR_CRCEN)
+#elif defined(RCC_AHB1ENR_CRCEN)
+#    define CRC_ENABLE_CLOCK() (RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN)
+#else
+#    error "Unable to determine the CRC clock enable bit for this MCU"
+#endif
+
+void crc_init(void) { CRC_ENABLE_CLOCK(); }
+
+/* The data register consumes the most significant byte of a word first, so
+ * words read from memory are byte swapped before being written. */
+static uint32_t crc_calculate(uint32_t polynomial, uint32_t polysize, uint32_t initial_value, const void *data, size_t data_len) {
+    const uint8_t *d = (const uint8_t *)data;
+
+    /* The CRC unit is shared, so make sure the transaction handlers running in
+     * interrupt context cannot interleave with a calculation. */
+    syssts_t sts = chSysGetStatusAndLockX();
+
+    CRC->POL  = polynomial;
+    CRC->INIT = initial_value;
+    CRC->CR   = polysize | CRC_CR_RESET;
+
+    while (data_len >= 4) {
+        uint32_t word;
+        memcpy(&word, d, sizeof(word));
+        CRC->DR = __REV(word);
+        d += 4;
+        data_len -= 4;
+    }
+    while (data_len--) {
+        *(__IO uint8_t *)&CRC->DR = *d++;
+    }
+
+    uint32_t crc = CRC->DR;
+
+    chSysRestoreStatusX(sts);
+
+    return crc;
+}
+
+uint8_t crc8(const void *data, size_t data_len) { return crc_calculate(0x31, CRC_CR_POLYSIZE_1, 0xff, data, data_len); }
+
+uint16_t crc16(const void *data, size_t data_len) { return crc_calculate(0x1021, CRC_CR_POLYSIZE_0, 0xffff, data, data_len); }
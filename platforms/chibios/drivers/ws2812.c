@@ -1,5 +1,6 @@
 #include "quantum.h"
 #include "ws2812.h"
+#include "ws2812_encode.h"
 #include <ch.h>
 #include <hal.h>
 
@@ -28,6 +29,12 @@
 #    define WS2812_RES (1000 * WS2812_TRST_US)  // Width of the low gap between bits to cause a frame to latch
 #endif
 
+// Number of LEDs sent per critical section. Interrupts are serviced in the gaps
+// between them, which must stay shorter than the time the LEDs take to latch.
+#ifndef WS2812_BITBANG_CHUNK
+#    define WS2812_BITBANG_CHUNK 0  // the whole frame
+#endif
+
 #define NUMBER_NOPS 6
 #define CYCLES_PER_SEC (CPU_CLOCK / NUMBER_NOPS * NOP_FUDGE)
 #define NS_PER_SEC (1000000000L)  // Note that this has to be SIGNED since we want to be able to check for negative values of derivatives
@@ -77,28 +84,26 @@ void ws2812_setleds(LED_TYPE *ledarray, uint16_t leds) {
         s_init = true;
     }
 
+    uint16_t chunk = WS2812_BITBANG_CHUNK ? WS2812_BITBANG_CHUNK : leds;
+    uint16_t left  = chunk;
+
     // this code is very time dependent, so we need to disable interrupts
     chSysLock();
 
-    for (uint8_t i = 0; i < leds; i++) {
-        // WS2812 protocol dictates grb order
-#if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
-        sendByte(ledarray[i].g);
-        sendByte(ledarray[i].r);
-        sendByte(ledarray[i].b);
-#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
-        sendByte(ledarray[i].r);
-        sendByte(ledarray[i].g);
-        sendByte(ledarray[i].b);
-#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
-        sendByte(ledarray[i].b);
-        sendByte(ledarray[i].g);
-        sendByte(ledarray[i].r);
-#endif
+    // WS2812 protocol dictates grb order, which LED_TYPE is already in
+    const uint8_t *data = (const uint8_t *)ledarray;
 
-#ifdef RGBW
-        sendByte(ledarray[i].w);
-#endif
+    for (uint16_t i = 0; i < leds; i++) {
+        if (!left--) {
+            // let pending interrupts in, the low level holds the data until the next bit
+            chSysUnlock();
+            chSysLock();
+            left = chunk - 1;
+        }
+
+        for (uint8_t j = 0; j < WS2812_CHANNELS; j++) {
+            sendByte(*data++);
+        }
     }
 
     wait_ns(WS2812_RES);
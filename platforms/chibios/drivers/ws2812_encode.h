@@ -0,0 +1,58 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "ws2812.h"
+
+/* Waveform encoding shared by the ChibiOS WS2812 drivers. Kept free of any HAL
+ * dependency so the generated bit patterns can be tested on the host.
+ *
+ * LED_TYPE is laid out in WS2812_BYTE_ORDER, so an array of LEDs already is the
+ * byte stream sent on the wire. */
+
+#ifdef RGBW
+#    define WS2812_CHANNELS 4
+#else
+#    define WS2812_CHANNELS 3
+#endif
+
+/* Each data bit is sent as a 4 bit SPI symbol, so at WS2812_TIMING / 4 per
+ * SPI bit a one is high for 3/4 of the window and a zero for 1/4. */
+#define WS2812_SPI_BITS_PER_BIT 4
+#define WS2812_SPI_BYTES_PER_BYTE (8 * WS2812_SPI_BITS_PER_BIT / 8)
+#define WS2812_SPI_SYMBOL_1 0b1110
+#define WS2812_SPI_SYMBOL_0 0b1000
+
+/* Expands `len` bytes into the SPI waveform, most significant bit first, two
+ * data bits per SPI byte. Writes len * WS2812_SPI_BYTES_PER_BYTE bytes. */
+static inline void ws2812_encode_spi(uint8_t *dst, const uint8_t *src, uint16_t len) {
+    static const uint8_t symbols[4] = {
+        WS2812_SPI_SYMBOL_0 << 4 | WS2812_SPI_SYMBOL_0,
+        WS2812_SPI_SYMBOL_0 << 4 | WS2812_SPI_SYMBOL_1,
+        WS2812_SPI_SYMBOL_1 << 4 | WS2812_SPI_SYMBOL_0,
+        WS2812_SPI_SYMBOL_1 << 4 | WS2812_SPI_SYMBOL_1,
+    };
+
+    while (len--) {
+        uint8_t data = *src++;
+        *dst++       = symbols[data >> 6];
+        *dst++       = symbols[(data >> 4) & 3];
+        *dst++       = symbols[(data >> 2) & 3];
+        *dst++       = symbols[data & 3];
+    }
+}
@@ -0,0 +1,111 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "crc.h"
+}
+
+/* Every software implementation is built into its own test binary, see
+ * rules.mk. They are all checked against these bitwise references. */
+static uint8_t reference_crc8(const uint8_t *data, size_t length) {
+    uint8_t crc = 0xff;
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint16_t reference_crc16(const uint8_t *data, size_t length) {
+    uint16_t crc = 0xffff;
+    while (length--) {
+        crc ^= *data++ << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+class CrcTest : public testing::Test {
+   protected:
+    std::vector<uint8_t> data;
+
+    void SetUp() override {
+        uint32_t state = 0x12345678;
+        data.resize(4096 + 3);
+        for (auto &byte : data) {
+            state = state * 1664525 + 1013904223;
+            byte  = state >> 24;
+        }
+    }
+};
+
+TEST_F(CrcTest, KnownAnswers) {
+    const char *check = "123456789";
+
+    EXPECT_EQ(crc8(check, 9), 0xF7);
+    EXPECT_EQ(crc16(check, 9), 0x29B1);
+
+    EXPECT_EQ(crc8(check, 0), 0xFF);
+    EXPECT_EQ(crc16(check, 0), 0xFFFF);
+
+    const uint8_t zeros[4] = {0};
+    EXPECT_EQ(crc8(zeros, 1), 0xAC);
+    EXPECT_EQ(crc8(zeros, sizeof(zeros)), reference_crc8(zeros, sizeof(zeros)));
+    EXPECT_EQ(crc16(zeros, sizeof(zeros)), reference_crc16(zeros, sizeof(zeros)));
+}
+
+TEST_F(CrcTest, MatchesReferenceForAllLengthsAndAlignments) {
+    for (size_t offset = 0; offset < 4; offset++) {
+        for (size_t length = 0; length <= 67; length++) {
+            EXPECT_EQ(crc8(&data[offset], length), reference_crc8(&data[offset], length)) << "offset " << offset << " length " << length;
+            EXPECT_EQ(crc16(&data[offset], length), reference_crc16(&data[offset], length)) << "offset " << offset << " length " << length;
+        }
+    }
+
+    EXPECT_EQ(crc8(&data[3], 4096), reference_crc8(&data[3], 4096));
+    EXPECT_EQ(crc16(&data[3], 4096), reference_crc16(&data[3], 4096));
+}
+
+template <typename F>
+static double megabytes_per_second(F crc, const uint8_t *data, size_t length) {
+    const size_t iterations = (8 * 1024 * 1024) / length;
+    volatile uint32_t sink  = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        sink = sink + crc(data, length);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return (double)(iterations * length) / elapsed.count() / 1e6;
+}
+
+TEST_F(CrcTest, Benchmark) {
+    // Matrix sized payloads up to the size of a full RGB/OLED sync
+    for (size_t length : {8, 64, 1024}) {
+        printf("crc8  %5zu bytes: %8.1f MB/s\n", length, megabytes_per_second(crc8, data.data(), length));
+        printf("crc16 %5zu bytes: %8.1f MB/s\n", length, megabytes_per_second(crc16, data.data(), length));
+    }
+}
@@ -0,0 +1,120 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "led_compositor.h"
+}
+
+static const uint8_t LED_COUNT = 10;
+
+static std::vector<std::pair<int, std::vector<uint8_t>>> written;
+
+static void write_rgb(int index, const uint8_t *value) { written.push_back({index, {value[0], value[1], value[2]}}); }
+
+class LedCompositor : public ::testing::Test {
+   protected:
+    uint8_t          base[LED_COUNT * 3]    = {0};
+    uint8_t          overlay[LED_COUNT * 3] = {0};
+    uint8_t          overlay_mask[2]        = {0};
+    uint8_t          output[LED_COUNT * 3]  = {0};
+    led_layer_t      layers[2]              = {{base, NULL, LED_BLEND_REPLACE, true}, {overlay, overlay_mask, LED_BLEND_REPLACE, true}};
+    led_compositor_t compositor             = {layers, 2, LED_COUNT, 3, output, true};
+
+    void SetUp() override { written.clear(); }
+
+    void set(uint8_t layer, int index, std::vector<uint8_t> value) { led_layer_set(&compositor, layer, index, value.data()); }
+    void set_all(uint8_t layer, std::vector<uint8_t> value) { led_layer_set_all(&compositor, layer, value.data()); }
+
+    std::vector<uint8_t> composed(int index) { return std::vector<uint8_t>(&output[index * 3], &output[index * 3 + 3]); }
+};
+
+TEST_F(LedCompositor, FirstRenderWritesEveryLed) {
+    set_all(0, {1, 2, 3});
+    EXPECT_EQ(led_compositor_render(&compositor, write_rgb), LED_COUNT);
+    EXPECT_EQ(written.size(), LED_COUNT);
+    EXPECT_EQ(written[9].second, std::vector<uint8_t>({1, 2, 3}));
+}
+
+TEST_F(LedCompositor, OnlyChangedLedsAreWritten) {
+    set_all(0, {10, 10, 10});
+    led_compositor_render(&compositor, write_rgb);
+    written.clear();
+
+    // Redrawing the same frame is free
+    set_all(0, {10, 10, 10});
+    set(0, 4, {20, 0, 0});
+    EXPECT_EQ(led_compositor_render(&compositor, write_rgb), 1);
+    ASSERT_EQ(written.size(), 1);
+    EXPECT_EQ(written[0].first, 4);
+    EXPECT_EQ(written[0].second, std::vector<uint8_t>({20, 0, 0}));
+
+    written.clear();
+    led_compositor_invalidate(&compositor);
+    EXPECT_EQ(led_compositor_render(&compositor, write_rgb), LED_COUNT);
+}
+
+TEST_F(LedCompositor, MaskedLayerOnlyCoversDrawnLeds) {
+    set_all(0, {10, 20, 30});
+    set(1, 2, {255, 0, 0});
+    led_compositor_render(&compositor, write_rgb);
+    EXPECT_EQ(composed(1), std::vector<uint8_t>({10, 20, 30}));
+    EXPECT_EQ(composed(2), std::vector<uint8_t>({255, 0, 0}));
+
+    // Clearing the layer reveals what is below it again
+    written.clear();
+    led_layer_clear(&compositor, 1);
+    EXPECT_EQ(led_compositor_render(&compositor, write_rgb), 1);
+    EXPECT_EQ(composed(2), std::vector<uint8_t>({10, 20, 30}));
+}
+
+TEST_F(LedCompositor, BlendModes) {
+    set_all(0, {100, 200, 0});
+    set(1, 0, {100, 100, 100});
+
+    layers[1].blend = LED_BLEND_ADD;
+    led_compositor_render(&compositor, write_rgb);
+    EXPECT_EQ(composed(0), std::vector<uint8_t>({200, 255, 100}));
+
+    layers[1].blend = LED_BLEND_LIGHTEN;
+    led_compositor_render(&compositor, write_rgb);
+    EXPECT_EQ(composed(0), std::vector<uint8_t>({100, 200, 100}));
+
+    set(1, 0, {255, 128, 0});
+    layers[1].blend = LED_BLEND_MULTIPLY;
+    led_compositor_render(&compositor, write_rgb);
+    EXPECT_EQ(composed(0), std::vector<uint8_t>({100, 100, 0}));
+}
+
+TEST_F(LedCompositor, DisabledLayerIsSkipped) {
+    set_all(0, {10, 10, 10});
+    set_all(1, {50, 50, 50});
+    layers[1].enabled = false;
+    led_compositor_render(&compositor, write_rgb);
+    EXPECT_EQ(composed(0), std::vector<uint8_t>({10, 10, 10}));
+}
+
+TEST_F(LedCompositor, OutOfRangeIndexIsIgnored) {
+    set(0, -1, {1, 1, 1});
+    set(0, LED_COUNT, {1, 1, 1});
+    set(5, 0, {1, 1, 1});
+    led_compositor_render(&compositor, write_rgb);
+    for (int i = 0; i < LED_COUNT; i++) {
+        EXPECT_EQ(composed(i), std::vector<uint8_t>({0, 0, 0}));
+    }
+}
@@ -0,0 +1,193 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "led_output.h"
+#include "led_tables.h"
+}
+
+static const uint8_t LED_COUNT = 8;
+
+static std::vector<std::vector<uint8_t>> written;
+
+static void write_rgb(int index, const uint8_t *value) {
+    if ((size_t)index >= written.size()) written.resize(index + 1);
+    written[index] = {value[0], value[1], value[2]};
+}
+
+class LedOutput : public ::testing::Test {
+   protected:
+    uint8_t      frame[LED_COUNT * 3] = {0};
+    led_output_t output               = {CIE1931_CURVE_12, frame, LED_COUNT, 3, 4, 0, true};
+
+    void SetUp() override { written.clear(); }
+
+    void set(int index, std::vector<uint8_t> value) { led_output_set(&output, index, value.data()); }
+    void set_all(std::vector<uint8_t> value) { led_output_set_all(&output, value.data()); }
+
+    // Sum of the values written for one channel of one LED over `frames` renders
+    uint32_t accumulate(int index, uint8_t channel, uint16_t frames) {
+        uint32_t sum = 0;
+        for (uint16_t i = 0; i < frames; i++) {
+            led_output_render(&output, write_rgb);
+            sum += written[index][channel];
+        }
+        return sum;
+    }
+};
+
+TEST_F(LedOutput, TableMatchesEightBitCurve) {
+    // The 12 bit table is the same curve, so it never strays more than one step from the 8 bit one
+    for (int v = 0; v < 256; v++) {
+        int level = pgm_read_word(&CIE1931_CURVE_12[v]);
+        EXPECT_LE(abs((level >> LED_OUTPUT_FRACTION_BITS) - pgm_read_byte(&CIE1931_CURVE[v])), 1) << "value " << v;
+    }
+    EXPECT_EQ(pgm_read_word(&CIE1931_CURVE_12[0]), 0);
+    EXPECT_EQ(pgm_read_word(&CIE1931_CURVE_12[255]), 255 << LED_OUTPUT_FRACTION_BITS);
+}
+
+TEST_F(LedOutput, DitherAveragesToFullResolution) {
+    for (uint8_t bits = 0; bits <= LED_OUTPUT_FRACTION_BITS; bits++) {
+        uint8_t period = 1 << bits;
+        for (uint16_t level = 0; level <= 255 << LED_OUTPUT_FRACTION_BITS; level++) {
+            uint16_t sum = 0;
+            for (uint8_t phase = 0; phase < period; phase++) {
+                uint8_t value = led_output_dither(level, bits, phase);
+                EXPECT_GE(value, level >> LED_OUTPUT_FRACTION_BITS);
+                EXPECT_LE(value - (level >> LED_OUTPUT_FRACTION_BITS), 1);
+                sum += value;
+            }
+            // The fraction bits that are not dithered are truncated
+            EXPECT_EQ(sum, (level >> (LED_OUTPUT_FRACTION_BITS - bits))) << "level " << level << " bits " << (int)bits;
+        }
+    }
+}
+
+TEST_F(LedOutput, DitherSpreadsExtraSteps) {
+    // A quarter of the way to the next step lights it once every four frames
+    for (uint8_t phase = 0; phase < 16; phase += 4) {
+        uint8_t lit = 0;
+        for (uint8_t i = 0; i < 4; i++) {
+            lit += led_output_dither((10 << LED_OUTPUT_FRACTION_BITS) + 4, 4, phase + i) - 10;
+        }
+        EXPECT_EQ(lit, 1);
+    }
+}
+
+TEST_F(LedOutput, LowLevelsAreNotLost) {
+    // The 8 bit curve maps 1 through 9 to the same step, the dithered output tells them apart
+    uint32_t previous = 0;
+    for (uint8_t v = 1; v < 10; v++) {
+        set_all({v, v, v});
+        uint32_t sum = accumulate(0, 0, 16);
+        EXPECT_EQ(sum, pgm_read_word(&CIE1931_CURVE_12[v]));
+        EXPECT_GT(sum, previous);
+        previous = sum;
+    }
+}
+
+TEST_F(LedOutput, FullBrightnessIsSteady) {
+    set_all({255, 0, 128});
+    for (int i = 0; i < 16; i++) {
+        led_output_render(&output, write_rgb);
+        EXPECT_EQ(written[3][0], 255);
+        EXPECT_EQ(written[3][1], 0);
+    }
+}
+
+TEST_F(LedOutput, UnditheredOutputIsOnlyWrittenOnChange) {
+    output.dither_bits = 0;
+    set(2, {40, 80, 120});
+    EXPECT_EQ(led_output_render(&output, write_rgb), LED_COUNT);
+    EXPECT_EQ(led_output_render(&output, write_rgb), 0);
+
+    set(2, {40, 80, 121});
+    EXPECT_EQ(led_output_render(&output, write_rgb), LED_COUNT);
+    EXPECT_EQ(written[2][2], pgm_read_word(&CIE1931_CURVE_12[121]) >> LED_OUTPUT_FRACTION_BITS);
+}
+
+TEST_F(LedOutput, LinearWithoutTable) {
+    output.gamma = NULL;
+    set(0, {1, 100, 255});
+    led_output_render(&output, write_rgb);
+    EXPECT_EQ(written[0], std::vector<uint8_t>({1, 100, 255}));
+
+    // Out of range indexes are ignored
+    set(-1, {9, 9, 9});
+    set(LED_COUNT, {9, 9, 9});
+    led_output_render(&output, write_rgb);
+    EXPECT_EQ(written.size(), LED_COUNT);
+}
+
+TEST_F(LedOutput, LoadIsKeptUpToDate) {
+    set_all({10, 20, 30});
+    set(1, {255, 0, 0});
+    set(5, {0, 0, 0});
+    set(5, {1, 2, 3});
+
+    uint32_t load = 0;
+    for (int i = 0; i < LED_COUNT * 3; i++) {
+        load += pgm_read_word(&CIE1931_CURVE_12[frame[i]]);
+    }
+    EXPECT_EQ(output.load, load);
+}
+
+TEST_F(LedOutput, PowerLimitScalesFrameToBudget) {
+    output.gamma       = NULL;
+    output.dither_bits = 0;
+    output.budget      = LED_POWER_BUDGET(100, 20);  // Five channels at full brightness
+
+    set_all({255, 255, 255});
+    led_output_render(&output, write_rgb);
+
+    uint32_t total = 0;
+    for (auto &value : written) {
+        total += value[0] + value[1] + value[2];
+    }
+    EXPECT_LE(total, 5 * 255);
+    EXPECT_GT(total, 5 * 255 * 9 / 10);
+    EXPECT_EQ(written[0][0], written[7][2]);
+
+    // A frame within the budget is left alone
+    set_all({0, 0, 0});
+    set(0, {255, 0, 0});
+    led_output_render(&output, write_rgb);
+    EXPECT_EQ(output.scale, LED_POWER_SCALE_MAX);
+    EXPECT_EQ(written[0][0], 255);
+}
+
+TEST_F(LedOutput, PowerLimitHysteresis) {
+    uint32_t budget = 100000;
+
+    // Going over the budget takes effect at once
+    uint16_t scale = led_power_scale(LED_POWER_SCALE_MAX, budget * 2, budget);
+    EXPECT_EQ(scale, LED_POWER_SCALE_MAX / 2);
+
+    // Small drops in load keep the scale where it is
+    EXPECT_EQ(led_power_scale(scale, budget * 2 - budget / 100, budget), scale);
+    EXPECT_EQ(led_power_scale(scale, budget * 2 + budget / 100, budget), scale - 1);
+
+    // Larger ones raise it, but not all the way to the budget
+    uint16_t raised = led_power_scale(scale, budget, budget);
+    EXPECT_GT(raised, scale);
+    EXPECT_LT(raised, LED_POWER_SCALE_MAX);
+    EXPECT_EQ(led_power_scale(raised, budget, budget), raised);
+
+    EXPECT_EQ(led_power_scale(raised, budget / 2, budget), LED_POWER_SCALE_MAX);
+}
@@ -0,0 +1,305 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "i2c_master.h"
+#include "oled_driver.h"
+
+extern OLED_BLOCK_TYPE oled_dirty;
+}
+
+/* An SSD1306 in horizontal addressing mode, as far as the driver uses it.
+ * Data goes to the display RAM through the column and page window set by the
+ * last COLUMN_ADDR and PAGE_ADDR commands. */
+static struct {
+    uint8_t ram[8][128];
+    uint8_t column_start, column_end, page_start, page_end;
+    uint8_t column, page;
+    size_t  data_bytes;
+} display;
+
+extern "C" {
+void i2c_init(void) {}
+
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout) {
+    // Bytes of arguments that follow each command, for the commands that take any
+    static const std::vector<std::pair<uint8_t, uint8_t>> arguments = {
+        {0x20, 1}, {0x21, 2}, {0x22, 2}, {0x23, 1}, {0x26, 6}, {0x27, 6}, {0x81, 1}, {0x8D, 1}, {0xA8, 1}, {0xD3, 1}, {0xD5, 1}, {0xD9, 1}, {0xDA, 1}, {0xDB, 1},
+    };
+
+    EXPECT_EQ(data[0], 0x00) << "not a command";
+    for (uint16_t i = 1; i < length; i++) {
+        uint8_t command = data[i];
+        if (command == 0x21) {
+            display.column = display.column_start = data[i + 1];
+            display.column_end                    = data[i + 2];
+        } else if (command == 0x22) {
+            display.page = display.page_start = data[i + 1];
+            display.page_end                  = data[i + 2];
+        }
+        for (auto &argument : arguments) {
+            if (argument.first == command) i += argument.second;
+        }
+    }
+    return I2C_STATUS_SUCCESS;
+}
+
+i2c_status_t i2c_writeReg(uint8_t devaddr, uint8_t regaddr, const uint8_t *data, uint16_t length, uint16_t timeout) {
+    EXPECT_EQ(regaddr, 0x40) << "not data";
+    for (uint16_t i = 0; i < length; i++) {
+        display.ram[display.page % 8][display.column % 128] = data[i];
+        if (display.column++ == display.column_end) {
+            display.column = display.column_start;
+            if (display.page++ == display.page_end) {
+                display.page = display.page_start;
+            }
+        }
+    }
+    display.data_bytes += length;
+    return I2C_STATUS_SUCCESS;
+}
+}
+
+class Oled : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        memset(&display, 0, sizeof(display));
+        oled_init(OLED_ROTATION_0);
+        render();
+        display.data_bytes = 0;
+    }
+
+    // Sends every dirty block, as enough calls to oled_task would
+    void render() {
+        for (uint8_t i = 0; i < OLED_BLOCK_COUNT && oled_dirty; i++) {
+            oled_render();
+        }
+        EXPECT_EQ(oled_dirty, 0);
+    }
+
+    void rotate(oled_rotation_t rotation) {
+        memset(&display, 0, sizeof(display));
+        oled_init(rotation);
+        render();
+        display.data_bytes = 0;
+    }
+
+    // The display RAM inside a rectangle, one string per pixel row, '#' for lit pixels
+    std::vector<std::string> dump(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        std::vector<std::string> rows;
+        for (uint8_t row = y; row < y + height; row++) {
+            std::string pixels;
+            for (uint8_t column = x; column < x + width; column++) {
+                pixels += display.ram[row / 8][column] & (1 << (row % 8)) ? '#' : '.';
+            }
+            rows.push_back(pixels);
+        }
+        return rows;
+    }
+
+    /* The same for a display rotated by 90 degrees, with x and y as the text
+     * is read. The display RAM is written column by column, from the bottom. */
+    std::vector<std::string> dump_rotated(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+        std::vector<std::string> rows;
+        for (uint8_t row = y; row < y + height; row++) {
+            std::string pixels;
+            for (uint8_t column = x; column < x + width; column++) {
+                uint8_t ram_row = OLED_DISPLAY_HEIGHT - 1 - column;
+                pixels += display.ram[ram_row / 8][row] & (1 << (ram_row % 8)) ? '#' : '.';
+            }
+            rows.push_back(pixels);
+        }
+        return rows;
+    }
+};
+
+static const std::vector<std::string> GLYPH_H = {
+    "#...#.",
+    "#...#.",
+    "#...#.",
+    "#####.",
+    "#...#.",
+    "#...#.",
+    "#...#.",
+    "......",
+};
+
+static const std::vector<std::string> GLYPH_I = {
+    "..#...",
+    "......",
+    ".##...",
+    "..#...",
+    "..#...",
+    "..#...",
+    ".###..",
+    "......",
+};
+
+TEST_F(Oled, TextIsRendered) {
+    oled_write("Hi", false);
+    render();
+
+    EXPECT_EQ(dump(0, 0, 6, 8), GLYPH_H);
+    EXPECT_EQ(dump(6, 0, 6, 8), GLYPH_I);
+}
+
+TEST_F(Oled, InvertedTextIsRendered) {
+    oled_write_char('H', true);
+    render();
+
+    std::vector<std::string> inverted;
+    for (auto row : GLYPH_H) {
+        for (auto &pixel : row) pixel = pixel == '#' ? '.' : '#';
+        inverted.push_back(row);
+    }
+    EXPECT_EQ(dump(0, 0, 6, 8), inverted);
+
+    // The same character without inversion is a different cell
+    oled_set_cursor(0, 0);
+    oled_write_char('H', false);
+    render();
+    EXPECT_EQ(dump(0, 0, 6, 8), GLYPH_H);
+}
+
+TEST_F(Oled, UnchangedTextIsNotSentAgain) {
+    oled_write_line(0, "Layer: Base", false);
+    render();
+    EXPECT_GT(display.data_bytes, 0);
+
+    display.data_bytes = 0;
+    for (int i = 0; i < 1000; i++) {
+        oled_write_line(0, "Layer: Base", false);
+        EXPECT_EQ(oled_dirty, 0);
+    }
+    render();
+    EXPECT_EQ(display.data_bytes, 0);
+}
+
+TEST_F(Oled, OnlyBlocksWithChangedCharactersAreSent) {
+    oled_write_line(0, "Layer: Base", false);
+    render();
+
+    // Characters 7 to 11 are pixels 42 to 71, in the second and third block
+    display.data_bytes = 0;
+    oled_write_line(0, "Layer: Lower", false);
+    render();
+    EXPECT_EQ(display.data_bytes, 2 * OLED_BLOCK_SIZE);
+}
+
+TEST_F(Oled, WriteLineDoesNotWrap) {
+    oled_write_line(1, "Hi", false);
+    render();
+
+    std::string full(oled_max_chars() + 5, 'x');
+    oled_write_line(0, full.c_str(), false);
+    render();
+
+    EXPECT_EQ(dump(0, 8, 6, 8), GLYPH_H);
+    EXPECT_EQ(dump(6, 8, 6, 8), GLYPH_I);
+}
+
+TEST_F(Oled, WriteLinePadsWithSpaces) {
+    oled_write_line(0, "HiHi", false);
+    oled_write_line(0, "Hi", false);
+    render();
+
+    EXPECT_EQ(dump(12, 0, 12, 8), std::vector<std::string>(8, std::string(12, '.')));
+}
+
+TEST_F(Oled, PixelsDrawnOverTextAreRedrawn) {
+    oled_write_char('H', false);
+    render();
+
+    oled_write_pixel(1, 0, true);
+    oled_write_raw_byte(0xFF, 3);
+    render();
+    EXPECT_NE(dump(0, 0, 6, 8), GLYPH_H);
+
+    oled_set_cursor(0, 0);
+    oled_write_char('H', false);
+    render();
+    EXPECT_EQ(dump(0, 0, 6, 8), GLYPH_H);
+}
+
+TEST_F(Oled, RawWritesOverTextAreRedrawn) {
+    oled_write_char('H', false);
+    render();
+
+    static const char blank[6] = {0};
+    oled_set_cursor(0, 0);
+    oled_write_raw(blank, sizeof(blank));
+    render();
+    EXPECT_EQ(dump(0, 0, 6, 8), std::vector<std::string>(8, "......"));
+
+    oled_write_char('H', false);
+    render();
+    EXPECT_EQ(dump(0, 0, 6, 8), GLYPH_H);
+}
+
+TEST_F(Oled, ClearedTextIsRedrawn) {
+    oled_write_char('H', false);
+    render();
+
+    oled_clear();
+    oled_write_char('H', false);
+    render();
+    EXPECT_EQ(dump(0, 0, 6, 8), GLYPH_H);
+}
+
+TEST_F(Oled, RotatedTextIsRendered) {
+    rotate(OLED_ROTATION_90);
+    EXPECT_EQ(oled_max_chars(), OLED_DISPLAY_HEIGHT / OLED_FONT_WIDTH);
+
+    oled_write("Hi", false);
+    oled_set_cursor(1, 3);
+    oled_write_char('H', true);
+    render();
+
+    EXPECT_EQ(dump_rotated(0, 0, 6, 8), GLYPH_H);
+    EXPECT_EQ(dump_rotated(6, 0, 6, 8), GLYPH_I);
+
+    std::vector<std::string> inverted;
+    for (auto row : GLYPH_H) {
+        for (auto &pixel : row) pixel = pixel == '#' ? '.' : '#';
+        inverted.push_back(row);
+    }
+    EXPECT_EQ(dump_rotated(6, 24, 6, 8), inverted);
+}
+
+TEST_F(Oled, RotatedPixelsAreRendered) {
+    rotate(OLED_ROTATION_270);
+
+    // Every pixel once, in a pattern that is different in each 8x8 tile
+    for (uint8_t y = 0; y < OLED_DISPLAY_WIDTH; y++) {
+        for (uint8_t x = 0; x < OLED_DISPLAY_HEIGHT; x++) {
+            oled_write_pixel(x, y, (x * 7 + y * 3 + x * y) % 5 < 2);
+        }
+    }
+    render();
+
+    for (uint8_t y = 0; y < OLED_DISPLAY_WIDTH; y++) {
+        std::string expected;
+        for (uint8_t x = 0; x < OLED_DISPLAY_HEIGHT; x++) {
+            expected += (x * 7 + y * 3 + x * y) % 5 < 2 ? '#' : '.';
+        }
+        EXPECT_EQ(dump_rotated(0, y, OLED_DISPLAY_HEIGHT, 1)[0], expected) << "row " << (int)y;
+    }
+}
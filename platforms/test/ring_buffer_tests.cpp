@@ -0,0 +1,144 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <thread>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ring_buffer.h"
+}
+
+struct event {
+    uint16_t id;
+    uint8_t  payload[3];
+};
+
+class RingBuffer : public ::testing::Test {
+   protected:
+    event         data[5];
+    ring_buffer_t rb = RING_BUFFER_INIT(data);
+
+    bool push(uint16_t id) {
+        event e = {id, {uint8_t(id), uint8_t(id >> 8), 0xAA}};
+        return ring_buffer_push(&rb, &e);
+    }
+};
+
+TEST_F(RingBuffer, HoldsOneItemLessThanItsSlots) {
+    EXPECT_TRUE(ring_buffer_empty(&rb));
+    for (uint16_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(push(i));
+        EXPECT_EQ(ring_buffer_count(&rb), i + 1);
+        EXPECT_EQ(ring_buffer_space(&rb), 3 - i);
+    }
+    EXPECT_TRUE(ring_buffer_full(&rb));
+    EXPECT_FALSE(push(4));
+    EXPECT_EQ(ring_buffer_count(&rb), 4);
+}
+
+TEST_F(RingBuffer, ItemsComeOutInOrderAcrossTheWrap) {
+    event    e;
+    uint16_t next = 0;
+    for (uint16_t i = 0; i < 100; i++) {
+        EXPECT_TRUE(push(i));
+        if (i % 3 != 0) {
+            ASSERT_TRUE(ring_buffer_pop(&rb, &e));
+            EXPECT_EQ(e.id, next);
+            EXPECT_EQ(e.payload[2], 0xAA);
+            next++;
+        }
+        while (ring_buffer_full(&rb)) {
+            ASSERT_TRUE(ring_buffer_pop(&rb, &e));
+            EXPECT_EQ(e.id, next++);
+        }
+    }
+    while (ring_buffer_pop(&rb, &e)) {
+        EXPECT_EQ(e.id, next++);
+    }
+    EXPECT_EQ(next, 100);
+    EXPECT_FALSE(ring_buffer_pop(&rb, &e));
+}
+
+TEST_F(RingBuffer, PeekAndDrop) {
+    event e;
+    EXPECT_FALSE(ring_buffer_peek(&rb, &e));
+
+    push(7);
+    push(8);
+    push(9);
+    EXPECT_TRUE(ring_buffer_peek(&rb, &e));
+    EXPECT_EQ(e.id, 7);
+    EXPECT_TRUE(ring_buffer_peek_at(&rb, 2, &e));
+    EXPECT_EQ(e.id, 9);
+    EXPECT_FALSE(ring_buffer_peek_at(&rb, 3, &e));
+    EXPECT_EQ(ring_buffer_count(&rb), 3);
+
+    ring_buffer_drop(&rb, 2);
+    EXPECT_TRUE(ring_buffer_pop(&rb, &e));
+    EXPECT_EQ(e.id, 9);
+
+    // Dropping more than there is empties the buffer
+    push(10);
+    ring_buffer_drop(&rb, 200);
+    EXPECT_TRUE(ring_buffer_empty(&rb));
+
+    push(11);
+    ring_buffer_clear(&rb);
+    EXPECT_TRUE(ring_buffer_empty(&rb));
+    EXPECT_TRUE(push(12));
+}
+
+TEST_F(RingBuffer, MultipleInstances) {
+    uint8_t       bytes_a[4], bytes_b[8];
+    ring_buffer_t a, b;
+    ring_buffer_init(&a, bytes_a, 1, sizeof(bytes_a));
+    ring_buffer_init(&b, bytes_b, 1, sizeof(bytes_b));
+
+    for (uint8_t i = 0; i < 10; i++) {
+        ring_buffer_push(&a, &i);
+        ring_buffer_push(&b, &i);
+    }
+    EXPECT_EQ(ring_buffer_count(&a), 3);
+    EXPECT_EQ(ring_buffer_count(&b), 7);
+}
+
+TEST_F(RingBuffer, ConcurrentProducerAndConsumer) {
+    // The producer stands in for an interrupt handler and never waits on a lock
+    const uint32_t count = 50000;
+    uint32_t       slots[13];
+    ring_buffer_t  queue = RING_BUFFER_INIT(slots);
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < count; i++) {
+            while (!ring_buffer_push(&queue, &i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t value;
+    while (expected < count) {
+        if (ring_buffer_pop(&queue, &value)) {
+            ASSERT_EQ(value, expected);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring_buffer_empty(&queue));
+}
@@ -22,3 +22,54 @@ eeprom_stm32_SRC := \
 	$(PLATFORM_PATH)/chibios/eeprom_stm32.c
 eeprom_stm32_tiny_SRC := $(eeprom_stm32_SRC)
 eeprom_stm32_large_SRC := $(eeprom_stm32_SRC)
+
+crc_SRC := \
+	$(QUANTUM_PATH)/crc.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/crc_tests.cpp
+crc_bitwise_SRC := $(crc_SRC)
+crc_table_SRC := $(crc_SRC)
+crc_slice_by_4_SRC := $(crc_SRC)
+
+crc_table_DEFS := -DCRC8_USE_TABLE
+crc_slice_by_4_DEFS := -DCRC_USE_SLICE_BY_4
+
+led_compositor_SRC := \
+	$(QUANTUM_PATH)/led_compositor.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/led_compositor_tests.cpp
+
+ws2812_encode_INC := \
+	$(PLATFORM_PATH)/chibios/drivers \
+	$(TOP_DIR)/drivers
+ws2812_encode_SRC := \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/ws2812_encode_tests.cpp
+ws2812_encode_rgb_INC := $(ws2812_encode_INC)
+ws2812_encode_rgb_SRC := $(ws2812_encode_SRC)
+ws2812_encode_rgbw_INC := $(ws2812_encode_INC)
+ws2812_encode_rgbw_SRC := $(ws2812_encode_SRC)
+
+ws2812_encode_rgb_DEFS := -DWS2812_BYTE_ORDER=WS2812_BYTE_ORDER_RGB
+ws2812_encode_rgbw_DEFS := -DRGBW
+
+led_output_DEFS := -DUSE_CIE1931_CURVE
+led_output_SRC := \
+	$(QUANTUM_PATH)/led_output.c \
+	$(QUANTUM_PATH)/led_tables.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/led_output_tests.cpp
+
+ring_buffer_SRC := \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/ring_buffer_tests.cpp
+
+oled_INC := \
+	$(TOP_DIR)/drivers/oled \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/drivers
+oled_SRC := \
+	$(TOP_DIR)/drivers/oled/ssd1306_sh1106.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/timer.c \
+	$(PLATFORM_PATH)/$(PLATFORM_KEY)/oled_tests.cpp
+oled_no_text_cache_INC := $(oled_INC)
+oled_no_text_cache_SRC := $(oled_SRC)
+oled_128x64_INC := $(oled_INC)
+oled_128x64_SRC := $(oled_SRC)
+
+oled_no_text_cache_DEFS := -DOLED_TEXT_CACHE=0
+oled_128x64_DEFS := -DOLED_DISPLAY_128X64
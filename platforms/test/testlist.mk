@@ -1 +1 @@
-TEST_LIST += eeprom_stm32_tiny eeprom_stm32_large
+TEST_LIST += eeprom_stm32_tiny eeprom_stm32_large crc_bitwise crc_table crc_slice_by_4 led_compositor led_output oled oled_no_text_cache oled_128x64 ring_buffer ws2812_encode ws2812_encode_rgb ws2812_encode_rgbw
@@ -0,0 +1,127 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "ws2812_encode.h"
+}
+
+/* The per-byte encoder the SPI driver used before the table */
+static uint8_t reference_protocol_eq(uint8_t data, int pos) {
+    uint8_t eq = 0;
+    if (data & (1 << (2 * (3 - pos))))
+        eq = 0b1110;
+    else
+        eq = 0b1000;
+    if (data & (2 << (2 * (3 - pos))))
+        eq += 0b11100000;
+    else
+        eq += 0b10000000;
+    return eq;
+}
+
+/* Turns an SPI waveform back into bytes, failing on anything that is not a valid symbol */
+static std::vector<uint8_t> decode_spi(const std::vector<uint8_t> &wave) {
+    std::vector<uint8_t> data;
+    uint8_t              byte = 0;
+    uint8_t              bits = 0;
+
+    for (auto spi : wave) {
+        for (int half = 1; half >= 0; half--) {
+            uint8_t symbol = (spi >> (4 * half)) & 0xF;
+            EXPECT_TRUE(symbol == WS2812_SPI_SYMBOL_1 || symbol == WS2812_SPI_SYMBOL_0) << "symbol " << +symbol;
+            byte = byte << 1 | (symbol == WS2812_SPI_SYMBOL_1);
+            if (++bits == 8) {
+                data.push_back(byte);
+                byte = bits = 0;
+            }
+        }
+    }
+    return data;
+}
+
+static int high_time_ns(uint8_t symbol) {
+    int high = 0;
+    for (int bit = 0; bit < WS2812_SPI_BITS_PER_BIT; bit++) {
+        if (symbol & (1 << bit)) high += WS2812_TIMING / WS2812_SPI_BITS_PER_BIT;
+    }
+    return high;
+}
+
+TEST(Ws2812Encode, SpiMatchesReference) {
+    for (int data = 0; data <= 0xFF; data++) {
+        uint8_t in = data;
+        uint8_t out[WS2812_SPI_BYTES_PER_BYTE];
+        ws2812_encode_spi(out, &in, 1);
+        for (int pos = 0; pos < WS2812_SPI_BYTES_PER_BYTE; pos++) {
+            EXPECT_EQ(out[pos], reference_protocol_eq(data, pos)) << "data " << data << " pos " << pos;
+        }
+    }
+}
+
+TEST(Ws2812Encode, SpiWaveformDecodesToLeds) {
+    static_assert(sizeof(LED_TYPE) == WS2812_CHANNELS, "LED_TYPE must be packed in wire order");
+
+    LED_TYPE leds[5];
+    for (int i = 0; i < 5; i++) {
+        leds[i].r = 0x11 * i;
+        leds[i].g = 0x80 >> i;
+        leds[i].b = 0xFF - i;
+#ifdef RGBW
+        leds[i].w = 0x5A;
+#endif
+    }
+
+    std::vector<uint8_t> wave(sizeof(leds) * WS2812_SPI_BYTES_PER_BYTE);
+    ws2812_encode_spi(wave.data(), (const uint8_t *)leds, sizeof(leds));
+    auto data = decode_spi(wave);
+
+    // Every LED is sent in WS2812_BYTE_ORDER, most significant bit first
+    ASSERT_EQ(data.size(), 5 * WS2812_CHANNELS);
+    for (int i = 0; i < 5; i++) {
+        const uint8_t *led = &data[i * WS2812_CHANNELS];
+#if (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_GRB)
+        EXPECT_EQ(led[0], leds[i].g);
+        EXPECT_EQ(led[1], leds[i].r);
+        EXPECT_EQ(led[2], leds[i].b);
+#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_RGB)
+        EXPECT_EQ(led[0], leds[i].r);
+        EXPECT_EQ(led[1], leds[i].g);
+        EXPECT_EQ(led[2], leds[i].b);
+#elif (WS2812_BYTE_ORDER == WS2812_BYTE_ORDER_BGR)
+        EXPECT_EQ(led[0], leds[i].b);
+        EXPECT_EQ(led[1], leds[i].g);
+        EXPECT_EQ(led[2], leds[i].r);
+#endif
+#ifdef RGBW
+        EXPECT_EQ(led[3], leds[i].w);
+#endif
+    }
+}
+
+TEST(Ws2812Encode, SpiSymbolsMeetBitTimings) {
+    // The datasheets allow 150ns of deviation on the high times
+    EXPECT_NEAR(high_time_ns(WS2812_SPI_SYMBOL_1), WS2812_T1H, 150);
+    EXPECT_NEAR(high_time_ns(WS2812_SPI_SYMBOL_0), WS2812_T0H, 150);
+
+    // The line has to go low between bits, and every bit starts high
+    EXPECT_EQ(WS2812_SPI_SYMBOL_1 & 1, 0);
+    EXPECT_EQ(WS2812_SPI_SYMBOL_1 >> (WS2812_SPI_BITS_PER_BIT - 1), 1);
+    EXPECT_EQ(WS2812_SPI_SYMBOL_0 >> (WS2812_SPI_BITS_PER_BIT - 1), 1);
+}
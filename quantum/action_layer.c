@@ -3,6 +3,7 @@
 #include "action.h"
 #include "util.h"
 #include "action_layer.h"
+#include "trace.h"
 
 #ifdef DEBUG_ACTION
 #    include "debug.h"
@@ -38,6 +39,7 @@ static void default_layer_state_set(layer_state_t state) {
     default_layer_state = state;
     default_layer_debug();
     debug("\n");
+    trace_event(TRACE_DEFAULT_LAYER_STATE, 0, (uint32_t)state & 0xFFFF, (uint32_t)state >> 16);
 #ifdef STRICT_LAYER_RELEASE
     clear_keyboard_but_mods();  // To avoid stuck keys
 #else
@@ -104,6 +106,7 @@ void layer_state_set(layer_state_t state) {
     layer_state = state;
     layer_debug();
     dprintln();
+    trace_event(TRACE_LAYER_STATE, 0, (uint32_t)state & 0xFFFF, (uint32_t)state >> 16);
 #    ifdef STRICT_LAYER_RELEASE
     clear_keyboard_but_mods();  // To avoid stuck keys
 #    else
@@ -5,6 +5,7 @@
 #include "action_tapping.h"
 #include "keycode.h"
 #include "timer.h"
+#include "trace.h"
 
 #ifdef DEBUG_ACTION
 #    include "debug.h"
@@ -525,6 +526,7 @@ static void debug_tapping_key(void) {
     debug("TAPPING_KEY=");
     debug_record(tapping_key);
     debug("\n");
+    trace_event(TRACE_TAPPING_KEY, tapping_key.event.pressed << 7 | tapping_key.tap.interrupted << 6 | tapping_key.tap.count, tapping_key.event.key.row << 8 | tapping_key.event.key.col, tapping_key.event.time);
 }
 
 /** \brief Waiting buffer debug print
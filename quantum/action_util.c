@@ -36,9 +36,43 @@ static uint8_t suppressed_mods    = 0;
 // report_keyboard_t keyboard_report = {};
 report_keyboard_t *keyboard_report = &(report_keyboard_t){};
 
-extern inline void add_key(uint8_t key);
-extern inline void del_key(uint8_t key);
-extern inline void clear_keys(void);
+/* Number of keys in keyboard_report. add_key(), del_key() and clear_keys()
+ * keep it up to date, so send_keyboard_report() does not have to count the
+ * keys in a NKRO report every time. */
+static uint8_t keyboard_report_keys = 0;
+
+/** \brief add key
+ *
+ * Adds a key to keyboard_report
+ */
+void add_key(uint8_t key) {
+    bool pressed = is_key_pressed(keyboard_report, key);
+    add_key_to_report(keyboard_report, key);
+    if (!pressed && is_key_pressed(keyboard_report, key)) {
+        keyboard_report_keys++;
+    }
+}
+
+/** \brief del key
+ *
+ * Removes a key from keyboard_report
+ */
+void del_key(uint8_t key) {
+    bool pressed = is_key_pressed(keyboard_report, key);
+    del_key_from_report(keyboard_report, key);
+    if (pressed && !is_key_pressed(keyboard_report, key)) {
+        keyboard_report_keys--;
+    }
+}
+
+/** \brief clear keys
+ *
+ * Removes all keys, but not the modifiers, from keyboard_report
+ */
+void clear_keys(void) {
+    clear_keys_from_report(keyboard_report);
+    keyboard_report_keys = 0;
+}
 
 #ifndef NO_ACTION_ONESHOT
 static uint8_t oneshot_mods        = 0;
@@ -234,7 +268,7 @@ void send_keyboard_report(void) {
         }
 #    endif
         keyboard_report->mods |= oneshot_mods;
-        if (has_anykey(keyboard_report)) {
+        if (keyboard_report_keys) {
             clear_oneshot_mods();
         }
     }
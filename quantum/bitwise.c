@@ -35,9 +35,16 @@ uint8_t bitpop16(uint16_t bits) {
 }
 
 uint8_t bitpop32(uint32_t bits) {
+#if defined(__AVR__)
     uint8_t c;
     for (c = 0; bits; c++) bits &= bits - 1;
     return c;
+#else
+    // count in parallel within the word, cores without a 32 bit multiplier loop above instead
+    bits = bits - ((bits >> 1) & 0x55555555);
+    bits = (bits & 0x33333333) + ((bits >> 2) & 0x33333333);
+    return (((bits + (bits >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
 }
 
 // most significant on-bit - return highest location of on-bit
@@ -81,6 +88,9 @@ uint8_t biton16(uint16_t bits) {
 }
 
 uint8_t biton32(uint32_t bits) {
+#if defined(__ARM_FEATURE_CLZ)
+    return bits ? 31 - __builtin_clz(bits) : 0;
+#else
     uint8_t n = 0;
     if (bits >> 16) {
         bits >>= 16;
@@ -103,6 +113,7 @@ uint8_t biton32(uint32_t bits) {
         n += 1;
     }
     return n;
+#endif
 }
 
 __attribute__((noinline)) uint8_t bitrev(uint8_t bits) {
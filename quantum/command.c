@@ -577,7 +577,7 @@ static bool command_console(uint8_t code) {
 static void mousekey_param_print(void) {
     xprintf(/* clang-format off */
 
-#ifndef MK_3_SPEED
+#if !defined(MK_3_SPEED) && !defined(MK_INERTIA)
         "1:	delay(*10ms): %u\n"
         "2:	interval(ms): %u\n"
         "3:	max_speed: %u\n"
@@ -611,7 +611,7 @@ static void mousekey_console_help(void) {
         "rt:	-10\n"
         "ESC/q:	quit\n"
 
-#ifndef MK_3_SPEED
+#if !defined(MK_3_SPEED) && !defined(MK_INERTIA)
         "\n"
         "speed = delta * max_speed * (repeat / time_to_max)\n"
         "where delta: cursor=%d, wheel=%d\n"
@@ -667,7 +667,7 @@ bool mousekey_console(uint8_t code) {
             switch (param) { /* clang-format off */
 #               define PARAM(n, v) case n: pp = &(v); desc = #v; break
 
-#ifndef MK_3_SPEED
+#if !defined(MK_3_SPEED) && !defined(MK_INERTIA)
                 PARAM(1, mk_delay);
                 PARAM(2, mk_interval);
                 PARAM(3, mk_max_speed);
@@ -694,7 +694,7 @@ bool mousekey_console(uint8_t code) {
 
         case KC_D:
 
-#    ifndef MK_3_SPEED
+#    if !defined(MK_3_SPEED) && !defined(MK_INERTIA)
             mk_delay             = MOUSEKEY_DELAY / 10;
             mk_interval          = MOUSEKEY_INTERVAL;
             mk_max_speed         = MOUSEKEY_MAX_SPEED;
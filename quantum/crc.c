@@ -20,16 +20,106 @@ __attribute__((weak)) void crc_init(void){
     /* Software implementation nothing todo here. */
 };
 
-#if defined(CRC8_USE_TABLE)
+#define CRC8_POLYNOMIAL 0x31
+#define CRC8_INITIAL_VALUE 0xff
+#define CRC16_POLYNOMIAL 0x1021
+#define CRC16_INITIAL_VALUE 0xffff
+
+#if defined(CRC_USE_SLICE_BY_4)
+/**
+ * Tables used for the slice-by-4 implementation, built on first use. Slice n
+ * holds the CRC of a byte followed by n zero bytes, so four bytes can be
+ * folded into the CRC with four independent lookups.
+ */
+static uint8_t  crc8_slices[4][256];
+static uint16_t crc16_slices[4][256];
+
+__attribute__((weak)) uint8_t crc8(const void *data, size_t data_len) {
+    const uint8_t *d   = (const uint8_t *)data;
+    crc_t          crc = CRC8_INITIAL_VALUE;
+
+    if (crc8_slices[0][1] == 0) {
+        for (size_t i = 0; i < 256; i++) {
+            uint8_t c = i;
+            for (uint8_t j = 0; j < 8; j++) {
+                c = (c & 0x80) ? (c << 1) ^ CRC8_POLYNOMIAL : c << 1;
+            }
+            crc8_slices[0][i] = c;
+        }
+        for (size_t i = 0; i < 256; i++) {
+            for (uint8_t n = 1; n < 4; n++) {
+                crc8_slices[n][i] = crc8_slices[0][crc8_slices[n - 1][i]];
+            }
+        }
+    }
+
+    while (data_len >= 4) {
+        crc = crc8_slices[3][(uint8_t)(crc ^ d[0])] ^ crc8_slices[2][d[1]] ^ crc8_slices[1][d[2]] ^ crc8_slices[0][d[3]];
+        d += 4;
+        data_len -= 4;
+    }
+    while (data_len--) {
+        crc = crc8_slices[0][(uint8_t)(crc ^ *d++)];
+    }
+    return crc & 0xff;
+}
+
+__attribute__((weak)) uint16_t crc16(const void *data, size_t data_len) {
+    const uint8_t *d   = (const uint8_t *)data;
+    uint16_t       crc = CRC16_INITIAL_VALUE;
+
+    if (crc16_slices[0][1] == 0) {
+        for (size_t i = 0; i < 256; i++) {
+            uint16_t c = i << 8;
+            for (uint8_t j = 0; j < 8; j++) {
+                c = (c & 0x8000) ? (c << 1) ^ CRC16_POLYNOMIAL : c << 1;
+            }
+            crc16_slices[0][i] = c;
+        }
+        for (size_t i = 0; i < 256; i++) {
+            for (uint8_t n = 1; n < 4; n++) {
+                crc16_slices[n][i] = (crc16_slices[n - 1][i] << 8) ^ crc16_slices[0][crc16_slices[n - 1][i] >> 8];
+            }
+        }
+    }
+
+    while (data_len >= 4) {
+        crc = crc16_slices[3][(crc >> 8) ^ d[0]] ^ crc16_slices[2][(crc & 0xff) ^ d[1]] ^ crc16_slices[1][d[2]] ^ crc16_slices[0][d[3]];
+        d += 4;
+        data_len -= 4;
+    }
+    while (data_len--) {
+        crc = (crc << 8) ^ crc16_slices[0][(crc >> 8) ^ *d++];
+    }
+    return crc;
+}
+#else
+#    if defined(CRC8_USE_TABLE)
 /**
  * Static table used for the table_driven implementation.
  */
-static const crc_t crc_table[256] = {0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31, 0x24, 0x23, 0x2a, 0x2d, 0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65, 0x48, 0x4f, 0x46, 0x41, 0x54, 0x53, 0x5a, 0x5d, 0xe0, 0xe7, 0xee, 0xe9, 0xfc, 0xfb, 0xf2, 0xf5, 0xd8, 0xdf, 0xd6, 0xd1, 0xc4, 0xc3, 0xca, 0xcd, 0x90, 0x97, 0x9e, 0x99, 0x8c, 0x8b, 0x82, 0x85, 0xa8, 0xaf, 0xa6, 0xa1, 0xb4, 0xb3, 0xba, 0xbd, 0xc7, 0xc0, 0xc9, 0xce, 0xdb, 0xdc, 0xd5, 0xd2, 0xff, 0xf8, 0xf1, 0xf6, 0xe3, 0xe4, 0xed, 0xea, 0xb7, 0xb0, 0xb9, 0xbe, 0xab, 0xac, 0xa5, 0xa2, 0x8f, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9d, 0x9a, 0x27, 0x20, 0x29, 0x2e, 0x3b, 0x3c, 0x35, 0x32, 0x1f, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0d, 0x0a, 0x57, 0x50, 0x59, 0x5e, 0x4b, 0x4c, 0x45, 0x42, 0x6f, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7d, 0x7a,
-                                     0x89, 0x8e, 0x87, 0x80, 0x95, 0x92, 0x9b, 0x9c, 0xb1, 0xb6, 0xbf, 0xb8, 0xad, 0xaa, 0xa3, 0xa4, 0xf9, 0xfe, 0xf7, 0xf0, 0xe5, 0xe2, 0xeb, 0xec, 0xc1, 0xc6, 0xcf, 0xc8, 0xdd, 0xda, 0xd3, 0xd4, 0x69, 0x6e, 0x67, 0x60, 0x75, 0x72, 0x7b, 0x7c, 0x51, 0x56, 0x5f, 0x58, 0x4d, 0x4a, 0x43, 0x44, 0x19, 0x1e, 0x17, 0x10, 0x05, 0x02, 0x0b, 0x0c, 0x21, 0x26, 0x2f, 0x28, 0x3d, 0x3a, 0x33, 0x34, 0x4e, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5c, 0x5b, 0x76, 0x71, 0x78, 0x7f, 0x6a, 0x6d, 0x64, 0x63, 0x3e, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2c, 0x2b, 0x06, 0x01, 0x08, 0x0f, 0x1a, 0x1d, 0x14, 0x13, 0xae, 0xa9, 0xa0, 0xa7, 0xb2, 0xb5, 0xbc, 0xbb, 0x96, 0x91, 0x98, 0x9f, 0x8a, 0x8d, 0x84, 0x83, 0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef, 0xfa, 0xfd, 0xf4, 0xf3};
+static const crc_t crc_table[256] = {
+    0x00, 0x31, 0x62, 0x53, 0xc4, 0xf5, 0xa6, 0x97, 0xb9, 0x88, 0xdb, 0xea, 0x7d, 0x4c, 0x1f, 0x2e,
+    0x43, 0x72, 0x21, 0x10, 0x87, 0xb6, 0xe5, 0xd4, 0xfa, 0xcb, 0x98, 0xa9, 0x3e, 0x0f, 0x5c, 0x6d,
+    0x86, 0xb7, 0xe4, 0xd5, 0x42, 0x73, 0x20, 0x11, 0x3f, 0x0e, 0x5d, 0x6c, 0xfb, 0xca, 0x99, 0xa8,
+    0xc5, 0xf4, 0xa7, 0x96, 0x01, 0x30, 0x63, 0x52, 0x7c, 0x4d, 0x1e, 0x2f, 0xb8, 0x89, 0xda, 0xeb,
+    0x3d, 0x0c, 0x5f, 0x6e, 0xf9, 0xc8, 0x9b, 0xaa, 0x84, 0xb5, 0xe6, 0xd7, 0x40, 0x71, 0x22, 0x13,
+    0x7e, 0x4f, 0x1c, 0x2d, 0xba, 0x8b, 0xd8, 0xe9, 0xc7, 0xf6, 0xa5, 0x94, 0x03, 0x32, 0x61, 0x50,
+    0xbb, 0x8a, 0xd9, 0xe8, 0x7f, 0x4e, 0x1d, 0x2c, 0x02, 0x33, 0x60, 0x51, 0xc6, 0xf7, 0xa4, 0x95,
+    0xf8, 0xc9, 0x9a, 0xab, 0x3c, 0x0d, 0x5e, 0x6f, 0x41, 0x70, 0x23, 0x12, 0x85, 0xb4, 0xe7, 0xd6,
+    0x7a, 0x4b, 0x18, 0x29, 0xbe, 0x8f, 0xdc, 0xed, 0xc3, 0xf2, 0xa1, 0x90, 0x07, 0x36, 0x65, 0x54,
+    0x39, 0x08, 0x5b, 0x6a, 0xfd, 0xcc, 0x9f, 0xae, 0x80, 0xb1, 0xe2, 0xd3, 0x44, 0x75, 0x26, 0x17,
+    0xfc, 0xcd, 0x9e, 0xaf, 0x38, 0x09, 0x5a, 0x6b, 0x45, 0x74, 0x27, 0x16, 0x81, 0xb0, 0xe3, 0xd2,
+    0xbf, 0x8e, 0xdd, 0xec, 0x7b, 0x4a, 0x19, 0x28, 0x06, 0x37, 0x64, 0x55, 0xc2, 0xf3, 0xa0, 0x91,
+    0x47, 0x76, 0x25, 0x14, 0x83, 0xb2, 0xe1, 0xd0, 0xfe, 0xcf, 0x9c, 0xad, 0x3a, 0x0b, 0x58, 0x69,
+    0x04, 0x35, 0x66, 0x57, 0xc0, 0xf1, 0xa2, 0x93, 0xbd, 0x8c, 0xdf, 0xee, 0x79, 0x48, 0x1b, 0x2a,
+    0xc1, 0xf0, 0xa3, 0x92, 0x05, 0x34, 0x67, 0x56, 0x78, 0x49, 0x1a, 0x2b, 0xbc, 0x8d, 0xde, 0xef,
+    0x82, 0xb3, 0xe0, 0xd1, 0x46, 0x77, 0x24, 0x15, 0x3b, 0x0a, 0x59, 0x68, 0xff, 0xce, 0x9d, 0xac
+};
 
 __attribute__((weak)) uint8_t crc8(const void *data, size_t data_len) {
     const uint8_t *d   = (const uint8_t *)data;
-    crc_t          crc = 0xff;
+    crc_t          crc = CRC8_INITIAL_VALUE;
     size_t         tbl_idx;
 
     while (data_len--) {
@@ -39,21 +129,39 @@ __attribute__((weak)) uint8_t crc8(const void *data, size_t data_len) {
     }
     return crc & 0xff;
 }
-#else
+#    else
 __attribute__((weak)) uint8_t crc8(const void *data, size_t data_len) {
     const uint8_t *d   = (const uint8_t *)data;
-    crc_t          crc = 0xff;
+    crc_t          crc = CRC8_INITIAL_VALUE;
     size_t         i, j;
 
     for (i = 0; i < data_len; i++) {
         crc ^= d[i];
         for (j = 0; j < 8; j++) {
             if ((crc & 0x80) != 0)
-                crc = (crc_t)((crc << 1) ^ 0x31);
+                crc = (crc_t)((crc << 1) ^ CRC8_POLYNOMIAL);
+            else
+                crc <<= 1;
+        }
+    }
+    return crc;
+}
+#    endif
+
+__attribute__((weak)) uint16_t crc16(const void *data, size_t data_len) {
+    const uint8_t *d   = (const uint8_t *)data;
+    uint16_t       crc = CRC16_INITIAL_VALUE;
+    size_t         i, j;
+
+    for (i = 0; i < data_len; i++) {
+        crc ^= (uint16_t)d[i] << 8;
+        for (j = 0; j < 8; j++) {
+            if ((crc & 0x8000) != 0)
+                crc = (crc << 1) ^ CRC16_POLYNOMIAL;
             else
                 crc <<= 1;
         }
     }
     return crc;
 }
-#endif
\ No newline at end of file
+#endif
@@ -16,7 +16,8 @@
 
 #pragma once
 
-#include "quantum.h"
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * The type of the CRC values.
@@ -37,8 +38,22 @@ __attribute__((weak)) void crc_init(void);
 /**
  * Generate CRC8 value from given data.
  *
+ * Polynomial 0x31, initial value 0xff, no reflection and no final xor.
+ *
+ * \param[in] data     Pointer to a buffer of \a data_len bytes.
+ * \param[in] data_len Number of bytes in the \a data buffer.
+ * \return             The calculated crc value.
+ */
+__attribute__((weak)) uint8_t crc8(const void *data, size_t data_len);
+
+/**
+ * Generate CRC16 value from given data.
+ *
+ * CRC-16/CCITT-FALSE: polynomial 0x1021, initial value 0xffff, no reflection
+ * and no final xor.
+ *
  * \param[in] data     Pointer to a buffer of \a data_len bytes.
  * \param[in] data_len Number of bytes in the \a data buffer.
  * \return             The calculated crc value.
  */
-__attribute__((weak)) uint8_t crc8(const void *data, size_t data_len);
\ No newline at end of file
+__attribute__((weak)) uint16_t crc16(const void *data, size_t data_len);
@@ -55,6 +55,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef STENO_ENABLE
 #    include "process_steno.h"
 #endif
+#ifdef LEADER_ENABLE
+#    include "process_leader.h"
+#endif
+#ifdef DYNAMIC_MACRO_ENABLE
+#    include "process_dynamic_macro.h"
+#endif
 #ifdef POINTING_DEVICE_ENABLE
 #    include "pointing_device.h"
 #endif
@@ -100,6 +106,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef SLEEP_LED_ENABLE
 #    include "sleep_led.h"
 #endif
+#ifdef TRACE_ENABLE
+#    include "trace.h"
+#endif
 
 static uint32_t last_input_modification_time = 0;
 uint32_t        last_input_activity_time(void) { return last_input_modification_time; }
@@ -325,6 +334,9 @@ void keyboard_init(void) {
 #ifdef STENO_ENABLE
     steno_init();
 #endif
+#ifdef DYNAMIC_MACRO_ENABLE
+    dynamic_macro_init();
+#endif
 #ifdef POINTING_DEVICE_ENABLE
     pointing_device_init();
 #endif
@@ -457,6 +469,14 @@ MATRIX_LOOP_END:
     if (encoders_changed) last_encoder_activity_trigger();
 #endif
 
+#ifdef STENO_ENABLE
+    steno_task();
+#endif
+
+#ifdef LEADER_ENABLE
+    leader_task();
+#endif
+
 #ifdef OLED_ENABLE
     oled_task();
 #    if OLED_TIMEOUT > 0
@@ -516,6 +536,10 @@ MATRIX_LOOP_END:
     programmable_button_send();
 #endif
 
+#ifdef TRACE_ENABLE
+    trace_task();
+#endif
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
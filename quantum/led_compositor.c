@@ -0,0 +1,108 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "led_compositor.h"
+#include <string.h>
+
+#define LED_COMPOSITOR_MAX_CHANNELS 3
+
+static inline bool mask_get(const uint8_t *mask, uint8_t index) { return mask[index / 8] & (1 << (index % 8)); }
+
+void led_layer_set(led_compositor_t *compositor, uint8_t layer, int index, const uint8_t *value) {
+    if (layer >= compositor->layer_count || index < 0 || index >= compositor->led_count) {
+        return;
+    }
+
+    led_layer_t *l = &compositor->layers[layer];
+    memcpy(&l->pixels[index * compositor->channels], value, compositor->channels);
+    if (l->mask) {
+        l->mask[index / 8] |= 1 << (index % 8);
+    }
+}
+
+void led_layer_set_all(led_compositor_t *compositor, uint8_t layer, const uint8_t *value) {
+    if (layer >= compositor->layer_count) {
+        return;
+    }
+
+    led_layer_t *l = &compositor->layers[layer];
+    for (uint8_t i = 0; i < compositor->led_count; i++) {
+        memcpy(&l->pixels[i * compositor->channels], value, compositor->channels);
+    }
+    if (l->mask) {
+        memset(l->mask, 0xFF, (compositor->led_count + 7) / 8);
+    }
+}
+
+void led_layer_clear(led_compositor_t *compositor, uint8_t layer) {
+    if (layer >= compositor->layer_count) {
+        return;
+    }
+
+    led_layer_t *l = &compositor->layers[layer];
+    if (l->mask) {
+        memset(l->mask, 0, (compositor->led_count + 7) / 8);
+    } else {
+        memset(l->pixels, 0, compositor->led_count * compositor->channels);
+    }
+}
+
+void led_compositor_invalidate(led_compositor_t *compositor) { compositor->invalid = true; }
+
+static uint8_t blend_channel(led_blend_t blend, uint8_t below, uint8_t above) {
+    switch (blend) {
+        case LED_BLEND_ADD: {
+            uint16_t sum = below + above;
+            return sum > UINT8_MAX ? UINT8_MAX : sum;
+        }
+        case LED_BLEND_MULTIPLY:
+            return (below * (above + 1)) >> 8;
+        case LED_BLEND_LIGHTEN:
+            return above > below ? above : below;
+        default:
+            return above;
+    }
+}
+
+uint8_t led_compositor_render(led_compositor_t *compositor, led_compositor_write_t write) {
+    uint8_t channels = compositor->channels;
+    uint8_t changed  = 0;
+
+    for (uint8_t i = 0; i < compositor->led_count; i++) {
+        uint8_t value[LED_COMPOSITOR_MAX_CHANNELS] = {0};
+
+        for (uint8_t layer = 0; layer < compositor->layer_count; layer++) {
+            const led_layer_t *l = &compositor->layers[layer];
+            if (!l->enabled || (l->mask && !mask_get(l->mask, i))) {
+                continue;
+            }
+            const uint8_t *pixel = &l->pixels[i * channels];
+            for (uint8_t c = 0; c < channels; c++) {
+                value[c] = blend_channel(l->blend, value[c], pixel[c]);
+            }
+        }
+
+        uint8_t *output = &compositor->output[i * channels];
+        if (compositor->invalid || memcmp(output, value, channels) != 0) {
+            memcpy(output, value, channels);
+            write(i, value);
+            changed++;
+        }
+    }
+
+    compositor->invalid = false;
+    return changed;
+}
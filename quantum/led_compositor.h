@@ -0,0 +1,57 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Composes the frames of rgb_matrix and led_matrix in RAM before they reach
+ * the driver. Each layer holds `channels` bytes per LED (3 for RGB, 1 for
+ * single color LEDs), and is blended over the layers below it. Only the LEDs
+ * whose composed value changed since the last render are written out. */
+
+typedef enum {
+    LED_BLEND_REPLACE,   // The layer replaces what is below it
+    LED_BLEND_ADD,       // Saturating addition
+    LED_BLEND_MULTIPLY,  // The layer scales what is below it, 255 keeps it unchanged
+    LED_BLEND_LIGHTEN,   // The brighter of the two, per channel
+} led_blend_t;
+
+typedef struct {
+    uint8_t *   pixels;  // led_count * channels bytes
+    uint8_t *   mask;    // One bit per LED the layer has drawn, NULL if the layer covers every LED
+    led_blend_t blend;
+    bool        enabled;
+} led_layer_t;
+
+typedef struct {
+    led_layer_t *layers;  // Bottom layer first
+    uint8_t      layer_count;
+    uint8_t      led_count;
+    uint8_t      channels;
+    uint8_t *    output;   // The last frame that was written out
+    bool         invalid;  // Write every LED on the next render
+} led_compositor_t;
+
+typedef void (*led_compositor_write_t)(int index, const uint8_t *value);
+
+void led_layer_set(led_compositor_t *compositor, uint8_t layer, int index, const uint8_t *value);
+void led_layer_set_all(led_compositor_t *compositor, uint8_t layer, const uint8_t *value);
+void led_layer_clear(led_compositor_t *compositor, uint8_t layer);
+
+void    led_compositor_invalidate(led_compositor_t *compositor);
+uint8_t led_compositor_render(led_compositor_t *compositor, led_compositor_write_t write);
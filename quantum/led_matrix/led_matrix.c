@@ -118,6 +118,32 @@ static last_hit_t last_hit_buffer;
 const uint8_t k_led_matrix_split[2] = LED_MATRIX_SPLIT;
 #endif
 
+// composed frame
+#ifdef LED_MATRIX_COMPOSITOR
+static uint8_t     led_layer_values[LED_MATRIX_LAYER_COUNT][DRIVER_LED_TOTAL];
+static uint8_t     led_indicator_mask[(DRIVER_LED_TOTAL + 7) / 8];
+static uint8_t     led_composed[DRIVER_LED_TOTAL];
+static led_layer_t led_layers[LED_MATRIX_LAYER_COUNT] = {
+    [LED_MATRIX_LAYER_EFFECT]     = {led_layer_values[LED_MATRIX_LAYER_EFFECT], NULL, LED_BLEND_REPLACE, true},
+    [LED_MATRIX_LAYER_OVERLAY]    = {led_layer_values[LED_MATRIX_LAYER_OVERLAY], NULL, LED_BLEND_ADD, false},
+    [LED_MATRIX_LAYER_INDICATORS] = {led_layer_values[LED_MATRIX_LAYER_INDICATORS], led_indicator_mask, LED_BLEND_REPLACE, true},
+};
+static led_compositor_t led_compositor     = {led_layers, LED_MATRIX_LAYER_COUNT, DRIVER_LED_TOTAL, 1, led_composed, true};
+static uint8_t          led_target_layer   = LED_MATRIX_LAYER_EFFECT;
+static uint8_t          led_overlay_effect = LED_MATRIX_NONE;
+static uint8_t          led_last_overlay   = LED_MATRIX_NONE;
+static effect_params_t  led_overlay_params = {0, LED_FLAG_ALL, false};
+
+// Layers are blended in linear brightness, the curve is only applied on the way to the driver
+static void led_matrix_write_led(int index, const uint8_t *value) {
+#    ifdef USE_CIE1931_CURVE
+    led_matrix_driver.set_value(index, pgm_read_byte(&CIE1931_CURVE[*value]));
+#    else
+    led_matrix_driver.set_value(index, *value);
+#    endif
+}
+#endif  // LED_MATRIX_COMPOSITOR
+
 EECONFIG_DEBOUNCE_HELPER(led_matrix, EECONFIG_LED_MATRIX, led_matrix_eeconfig);
 
 void eeconfig_update_led_matrix(void) { eeconfig_flush_led_matrix(true); }
@@ -153,17 +179,29 @@ uint8_t led_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
-void led_matrix_update_pwm_buffers(void) { led_matrix_driver.flush(); }
+void led_matrix_update_pwm_buffers(void) {
+#ifdef LED_MATRIX_COMPOSITOR
+    // Only the LEDs that changed since the last frame reach the driver
+    led_compositor_render(&led_compositor, led_matrix_write_led);
+#endif
+    led_matrix_driver.flush();
+}
 
 void led_matrix_set_value(int index, uint8_t value) {
-#ifdef USE_CIE1931_CURVE
+#ifdef LED_MATRIX_COMPOSITOR
+    led_layer_set(&led_compositor, led_target_layer, index, &value);
+#else
+#    ifdef USE_CIE1931_CURVE
     value = pgm_read_byte(&CIE1931_CURVE[value]);
-#endif
+#    endif
     led_matrix_driver.set_value(index, value);
+#endif
 }
 
 void led_matrix_set_value_all(uint8_t value) {
-#if defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
+#if defined(LED_MATRIX_COMPOSITOR)
+    led_layer_set_all(&led_compositor, led_target_layer, &value);
+#elif defined(LED_MATRIX_ENABLE) && defined(LED_MATRIX_SPLIT)
     for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) led_matrix_set_value(i, value);
 #else
 #    ifdef USE_CIE1931_CURVE
@@ -275,39 +313,34 @@ static void led_task_start(void) {
     g_last_hit_tracker = last_hit_buffer;
 #endif  // LED_MATRIX_KEYREACTIVE_ENABLED
 
+#ifdef LED_MATRIX_COMPOSITOR
+    // indicators are drawn again for every frame
+    led_layer_clear(&led_compositor, LED_MATRIX_LAYER_INDICATORS);
+#endif  // LED_MATRIX_COMPOSITOR
+
     // next task
     led_task_state = RENDERING;
 }
 
-static void led_task_render(uint8_t effect) {
-    bool rendering         = false;
-    led_effect_params.init = (effect != led_last_effect) || (led_matrix_eeconfig.enable != led_last_enable);
-    if (led_effect_params.flags != led_matrix_eeconfig.flags) {
-        led_effect_params.flags = led_matrix_eeconfig.flags;
-        led_matrix_set_value_all(0);
-    }
-
+static bool led_matrix_run_effect(uint8_t effect, effect_params_t *params) {
     // each effect can opt to do calculations
     // and/or request PWM buffer updates.
     switch (effect) {
         case LED_MATRIX_NONE:
-            rendering = led_matrix_none(&led_effect_params);
-            break;
+            return led_matrix_none(params);
 
 // ---------------------------------------------
 // -----Begin led effect switch case macros-----
-#define LED_MATRIX_EFFECT(name, ...)          \
-    case LED_MATRIX_##name:                   \
-        rendering = name(&led_effect_params); \
-        break;
+#define LED_MATRIX_EFFECT(name, ...) \
+    case LED_MATRIX_##name:          \
+        return name(params);
 #include "led_matrix_effects.inc"
 #undef LED_MATRIX_EFFECT
 
 #if defined(LED_MATRIX_CUSTOM_KB) || defined(LED_MATRIX_CUSTOM_USER)
-#    define LED_MATRIX_EFFECT(name, ...)          \
-        case LED_MATRIX_CUSTOM_##name:            \
-            rendering = name(&led_effect_params); \
-            break;
+#    define LED_MATRIX_EFFECT(name, ...) \
+        case LED_MATRIX_CUSTOM_##name:   \
+            return name(params);
 #    ifdef LED_MATRIX_CUSTOM_KB
 #        include "led_matrix_kb.inc"
 #    endif
@@ -320,6 +353,35 @@ static void led_task_render(uint8_t effect) {
             // ---------------------------------------------
     }
 
+    return false;
+}
+
+static void led_task_render(uint8_t effect) {
+    bool rendering         = false;
+    led_effect_params.init = (effect != led_last_effect) || (led_matrix_eeconfig.enable != led_last_enable);
+    if (led_effect_params.flags != led_matrix_eeconfig.flags) {
+        led_effect_params.flags = led_matrix_eeconfig.flags;
+        led_matrix_set_value_all(0);
+#ifdef LED_MATRIX_COMPOSITOR
+        led_layer_clear(&led_compositor, LED_MATRIX_LAYER_OVERLAY);
+#endif  // LED_MATRIX_COMPOSITOR
+    }
+
+    rendering = led_matrix_run_effect(effect, &led_effect_params);
+
+#ifdef LED_MATRIX_COMPOSITOR
+    // The overlay renders the same slice of LEDs in the same pass as the effect below it
+    led_layers[LED_MATRIX_LAYER_OVERLAY].enabled = effect != LED_MATRIX_NONE && led_overlay_effect != LED_MATRIX_NONE;
+    if (led_layers[LED_MATRIX_LAYER_OVERLAY].enabled) {
+        led_overlay_params.iter  = led_effect_params.iter;
+        led_overlay_params.flags = led_effect_params.flags;
+        led_overlay_params.init  = led_effect_params.init || (led_overlay_effect != led_last_overlay);
+        led_target_layer         = LED_MATRIX_LAYER_OVERLAY;
+        rendering |= led_matrix_run_effect(led_overlay_effect, &led_overlay_params);
+        led_target_layer = LED_MATRIX_LAYER_EFFECT;
+    }
+#endif  // LED_MATRIX_COMPOSITOR
+
     led_effect_params.iter++;
 
     // next task
@@ -336,6 +398,9 @@ static void led_task_flush(uint8_t effect) {
     // update last trackers after the first full render so we can init over several frames
     led_last_effect = effect;
     led_last_enable = led_matrix_eeconfig.enable;
+#ifdef LED_MATRIX_COMPOSITOR
+    led_last_overlay = led_overlay_effect;
+#endif  // LED_MATRIX_COMPOSITOR
 
     // update pwm buffers
     led_matrix_update_pwm_buffers();
@@ -364,8 +429,14 @@ void led_matrix_task(void) {
         case RENDERING:
             led_task_render(effect);
             if (effect) {
+#ifdef LED_MATRIX_COMPOSITOR
+                led_target_layer = LED_MATRIX_LAYER_INDICATORS;
+#endif  // LED_MATRIX_COMPOSITOR
                 led_matrix_indicators();
                 led_matrix_indicators_advanced(&led_effect_params);
+#ifdef LED_MATRIX_COMPOSITOR
+                led_target_layer = LED_MATRIX_LAYER_EFFECT;
+#endif  // LED_MATRIX_COMPOSITOR
             }
             break;
         case FLUSHING:
@@ -410,6 +481,10 @@ __attribute__((weak)) void led_matrix_indicators_advanced_user(uint8_t led_min,
 
 void led_matrix_init(void) {
     led_matrix_driver.init();
+#ifdef LED_MATRIX_COMPOSITOR
+    // The driver starts out blank, whatever was composed before
+    led_compositor_invalidate(&led_compositor);
+#endif
 
 #ifdef LED_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
@@ -440,8 +515,11 @@ void led_matrix_init(void) {
 void led_matrix_set_suspend_state(bool state) {
 #ifdef LED_DISABLE_WHEN_USB_SUSPENDED
     if (state && !suspend_state && is_keyboard_master()) {  // only run if turning off, and only once
-        led_task_render(0);                                 // turn off all LEDs when suspending
-        led_task_flush(0);                                  // and actually flash led state to LEDs
+#    ifdef LED_MATRIX_COMPOSITOR
+        led_layer_clear(&led_compositor, LED_MATRIX_LAYER_INDICATORS);
+#    endif
+        led_task_render(0);  // turn off all LEDs when suspending
+        led_task_flush(0);   // and actually flash led state to LEDs
     }
     suspend_state = state;
 #endif
@@ -556,3 +634,21 @@ void led_matrix_decrease_speed(void) { led_matrix_decrease_speed_helper(true); }
 led_flags_t led_matrix_get_flags(void) { return led_matrix_eeconfig.flags; }
 
 void led_matrix_set_flags(led_flags_t flags) { led_matrix_eeconfig.flags = flags; }
+
+#ifdef LED_MATRIX_COMPOSITOR
+void led_matrix_set_overlay(uint8_t mode, led_blend_t blend) {
+    led_overlay_effect                         = mode < LED_MATRIX_EFFECT_MAX ? mode : LED_MATRIX_NONE;
+    led_layers[LED_MATRIX_LAYER_OVERLAY].blend = blend;
+    led_layer_clear(&led_compositor, LED_MATRIX_LAYER_OVERLAY);
+    led_task_state = STARTING;
+    dprintf("led matrix overlay: %u\n", led_overlay_effect);
+}
+
+uint8_t led_matrix_get_overlay(void) { return led_overlay_effect; }
+
+void led_matrix_set_layer_blend(uint8_t layer, led_blend_t blend) {
+    if (layer < LED_MATRIX_LAYER_COUNT) {
+        led_layers[layer].blend = blend;
+    }
+}
+#endif  // LED_MATRIX_COMPOSITOR
@@ -23,6 +23,9 @@
 #include <stdbool.h>
 #include "led_matrix_types.h"
 #include "quantum.h"
+#ifdef LED_MATRIX_COMPOSITOR
+#    include "led_compositor.h"
+#endif
 
 #ifdef IS31FL3731
 #    include "is31fl3731-simple.h"
@@ -153,6 +156,20 @@ void        led_matrix_decrease_speed_noeeprom(void);
 led_flags_t led_matrix_get_flags(void);
 void        led_matrix_set_flags(led_flags_t flags);
 
+#ifdef LED_MATRIX_COMPOSITOR
+// Layers of the composed frame, bottom first
+enum led_matrix_layers {
+    LED_MATRIX_LAYER_EFFECT,      // The current mode
+    LED_MATRIX_LAYER_OVERLAY,     // A second effect stacked on top, see led_matrix_set_overlay()
+    LED_MATRIX_LAYER_INDICATORS,  // Everything drawn by the indicator callbacks
+    LED_MATRIX_LAYER_COUNT
+};
+
+void    led_matrix_set_overlay(uint8_t mode, led_blend_t blend);
+uint8_t led_matrix_get_overlay(void);
+void    led_matrix_set_layer_blend(uint8_t layer, led_blend_t blend);
+#endif
+
 typedef struct {
     /* Perform any initialisation required for the other driver functions to work. */
     void (*init)(void);
@@ -0,0 +1,102 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "led_output.h"
+#include "progmem.h"
+#include <string.h>
+
+#define LED_OUTPUT_MAX_CHANNELS 3
+
+/* Frame counter values with their bits reversed. Used as dither thresholds
+ * they visit the fraction range evenly, so a fraction of f / 2^n lights the
+ * extra step in exactly f frames out of every 2^n, spread as far apart as
+ * possible. */
+static const uint8_t dither_thresholds[1 << LED_OUTPUT_FRACTION_BITS] = {0, 8, 4, 12, 2, 10, 6, 14, 1, 9, 5, 13, 3, 11, 7, 15};
+
+static inline uint16_t output_level(const led_output_t *output, uint8_t value) { return output->gamma ? pgm_read_word(&output->gamma[value]) : value << LED_OUTPUT_FRACTION_BITS; }
+
+void led_output_set(led_output_t *output, int index, const uint8_t *value) {
+    if (index < 0 || index >= output->led_count) {
+        return;
+    }
+
+    uint8_t *pixel = &output->frame[index * output->channels];
+    for (uint8_t c = 0; c < output->channels; c++) {
+        if (pixel[c] != value[c]) {
+            output->load += output_level(output, value[c]) - output_level(output, pixel[c]);
+            pixel[c]      = value[c];
+            output->dirty = true;
+        }
+    }
+}
+
+void led_output_set_all(led_output_t *output, const uint8_t *value) {
+    uint32_t load = 0;
+    for (uint8_t c = 0; c < output->channels; c++) {
+        load += output_level(output, value[c]);
+    }
+
+    for (uint8_t i = 0; i < output->led_count; i++) {
+        memcpy(&output->frame[i * output->channels], value, output->channels);
+    }
+    output->load  = load * output->led_count;
+    output->dirty = true;
+}
+
+uint8_t led_output_dither(uint16_t level, uint8_t dither_bits, uint8_t phase) {
+    uint8_t shift     = LED_OUTPUT_FRACTION_BITS - dither_bits;
+    uint8_t step      = level >> LED_OUTPUT_FRACTION_BITS;
+    uint8_t fraction  = (level & ((1 << LED_OUTPUT_FRACTION_BITS) - 1)) >> shift;
+    uint8_t threshold = dither_thresholds[phase & ((1 << dither_bits) - 1)] >> shift;
+    return (fraction > threshold && step < UINT8_MAX) ? step + 1 : step;
+}
+
+uint8_t led_output_render(led_output_t *output, led_output_write_t write) {
+    uint8_t channels = output->channels;
+    uint8_t written  = 0;
+
+    // Without dithering, or with every LED off, the output only changes along with the frame
+    if (!output->dirty && (output->dither_bits == 0 || output->load == 0)) {
+        return 0;
+    }
+
+    uint16_t scale = LED_POWER_SCALE_MAX;
+    if (output->budget) {
+        scale = output->scale = led_power_scale(output->scale, output->load, output->budget);
+    }
+
+    for (uint8_t i = 0; i < output->led_count; i++) {
+        const uint8_t *pixel                          = &output->frame[i * channels];
+        uint8_t        value[LED_OUTPUT_MAX_CHANNELS] = {0};
+
+        // Neighbouring LEDs start the cycle at different frames, so a large
+        // area of one color does not pulse at the dither frequency as a whole
+        uint8_t phase = output->phase + i;
+        for (uint8_t c = 0; c < channels; c++) {
+            uint16_t level = output_level(output, pixel[c]);
+            if (scale < LED_POWER_SCALE_MAX) {
+                level = ((uint32_t)level * scale) >> 8;
+            }
+            value[c] = led_output_dither(level, output->dither_bits, phase);
+        }
+        write(i, value);
+        written++;
+    }
+
+    output->phase++;
+    output->dirty = false;
+    return written;
+}
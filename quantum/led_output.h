@@ -0,0 +1,82 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Sits between a lighting feature and its 8 bit driver. The uncorrected values set
+ * by the feature are kept in RAM, and on every render each channel is looked
+ * up in a gamma table with LED_OUTPUT_FRACTION_BITS of extra resolution. The
+ * fraction is spread over consecutive frames by ordered dithering, so on
+ * average the LEDs show the full resolution of the table.
+ *
+ * The output can also be held to a power budget. The sum of all output levels
+ * (the load) is kept up to date as LEDs are set, and when it exceeds the
+ * budget the whole frame is scaled down to fit. */
+
+#define LED_OUTPUT_FRACTION_BITS 4
+
+// Full brightness for the power limit scale
+#define LED_POWER_SCALE_MAX 256
+
+// How far the load has to fall below the budget, in 1/256ths, before the scale is raised again
+#ifndef LED_POWER_HYSTERESIS
+#    define LED_POWER_HYSTERESIS 8
+#endif
+
+// Converts a budget in mA to load units, given the current drawn by one channel at full brightness
+#define LED_POWER_BUDGET(budget_ma, channel_ma) ((uint32_t)(budget_ma) * (UINT8_MAX << LED_OUTPUT_FRACTION_BITS) / (channel_ma))
+
+typedef struct {
+    const uint16_t *gamma;        // 256 entries in PROGMEM, 255 << LED_OUTPUT_FRACTION_BITS at most. NULL for linear output
+    uint8_t *       frame;        // led_count * channels bytes of uncorrected values
+    uint8_t         led_count;
+    uint8_t         channels;
+    uint8_t         dither_bits;  // Fraction bits dithered over 1 << dither_bits frames, the rest are truncated
+    uint8_t         phase;        // Frame counter
+    bool            dirty;        // The frame changed since the last render
+    uint32_t        budget;       // Highest load allowed, see LED_POWER_BUDGET(). 0 for no limit
+    uint32_t        load;         // Sum of the levels of every channel, before scaling
+    uint16_t        scale;        // Applied to every level, LED_POWER_SCALE_MAX is full brightness
+} led_output_t;
+
+typedef void (*led_output_write_t)(int index, const uint8_t *value);
+
+void led_output_set(led_output_t *output, int index, const uint8_t *value);
+void led_output_set_all(led_output_t *output, const uint8_t *value);
+
+uint8_t led_output_dither(uint16_t level, uint8_t dither_bits, uint8_t phase);
+uint8_t led_output_render(led_output_t *output, led_output_write_t write);
+
+/* Returns the scale that fits `load` into `budget`, starting from the scale
+ * used for the last frame. Going over the budget lowers the scale at once.
+ * It is only raised again to what would fit a budget LED_POWER_HYSTERESIS
+ * lower, so a load that hovers around the budget does not make the whole
+ * frame flicker. Inline, so rgblight can use it without the output stage. */
+static inline uint16_t led_power_scale(uint16_t scale, uint32_t load, uint32_t budget) {
+    if (load > budget) {
+        uint16_t fit = budget * LED_POWER_SCALE_MAX / load;
+        if (fit < scale) {
+            return fit;
+        }
+    }
+
+    uint32_t lowered = budget - (budget * LED_POWER_HYSTERESIS / LED_POWER_SCALE_MAX);
+    uint16_t raised  = load > lowered ? lowered * LED_POWER_SCALE_MAX / load : LED_POWER_SCALE_MAX;
+    return raised > scale ? raised : scale;
+}
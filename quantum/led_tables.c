@@ -38,6 +38,27 @@ const uint8_t CIE1931_CURVE[256] PROGMEM = {
   183, 186, 188, 190, 192, 194, 196, 198, 201, 203, 205, 207, 209, 212, 214, 216,
   219, 221, 223, 226, 228, 231, 233, 235, 238, 240, 243, 245, 248, 250, 253, 255
 };
+
+// The same curve at 12 bit resolution, scaled so that 255 maps to 255 << 4.
+// The low 4 bits are the fraction that led_output.c dithers over frames.
+const uint16_t CIE1931_CURVE_12[256] PROGMEM = {
+     0,    2,    4,    5,    7,    9,   11,   12,   14,   16,   18,   19,   21,   23,   25,   27,
+    28,   30,   32,   34,   35,   37,   39,   41,   43,   45,   47,   49,   51,   54,   56,   58,
+    61,   63,   66,   69,   71,   74,   77,   80,   83,   86,   89,   93,   96,  100,  103,  107,
+   110,  114,  118,  122,  126,  130,  134,  139,  143,  147,  152,  157,  161,  166,  171,  176,
+   181,  187,  192,  197,  203,  209,  214,  220,  226,  232,  239,  245,  251,  258,  264,  271,
+   278,  285,  292,  299,  306,  314,  321,  329,  337,  345,  353,  361,  369,  378,  386,  395,
+   404,  412,  422,  431,  440,  449,  459,  469,  479,  489,  499,  509,  519,  530,  541,  551,
+   562,  574,  585,  596,  608,  619,  631,  643,  655,  668,  680,  693,  706,  718,  732,  745,
+   758,  772,  785,  799,  813,  828,  842,  856,  871,  886,  901,  916,  932,  947,  963,  979,
+   995, 1011, 1028, 1044, 1061, 1078, 1095, 1112, 1130, 1147, 1165, 1183, 1202, 1220, 1239, 1257,
+  1276, 1295, 1315, 1334, 1354, 1374, 1394, 1414, 1435, 1456, 1477, 1498, 1519, 1541, 1562, 1584,
+  1606, 1629, 1651, 1674, 1697, 1720, 1743, 1767, 1791, 1815, 1839, 1863, 1888, 1913, 1938, 1963,
+  1989, 2015, 2041, 2067, 2093, 2120, 2147, 2174, 2201, 2229, 2256, 2284, 2313, 2341, 2370, 2399,
+  2428, 2457, 2487, 2517, 2547, 2577, 2608, 2639, 2670, 2701, 2732, 2764, 2796, 2829, 2861, 2894,
+  2927, 2960, 2994, 3028, 3062, 3096, 3130, 3165, 3200, 3236, 3271, 3307, 3343, 3380, 3416, 3453,
+  3490, 3528, 3565, 3603, 3642, 3680, 3719, 3758, 3797, 3837, 3877, 3917, 3957, 3998, 4039, 4080
+};
 #endif
 
 // clang-format on
@@ -18,3 +18,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 /* default noop "null" implementation */
 __attribute__((weak)) int8_t sendchar(uint8_t c) { return 0; }
+
+// Outputs that wait for the host, or that cannot tell, take any amount
+__attribute__((weak)) uint8_t sendchar_space(void) { return UINT8_MAX; }
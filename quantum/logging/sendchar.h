@@ -28,6 +28,10 @@ typedef int8_t (*sendchar_func_t)(uint8_t c);
 /* transmit a character.  return 0 on success, -1 on error. */
 int8_t sendchar(uint8_t c);
 
+/* Number of bytes sendchar() can take right now without dropping any, so
+ * that output which must not be split up can be held back instead. */
+uint8_t sendchar_space(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,130 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "trace.h"
+#include "ring_buffer.h"
+#include "timer.h"
+
+#if defined(RAW_ENABLE) && !defined(TRACE_OUTPUT_CONSOLE)
+#    include "raw_hid.h"
+#else
+#    include "sendchar.h"
+#endif
+
+#ifndef TRACE_BUFFER_SIZE
+#    define TRACE_BUFFER_SIZE 32
+#endif
+
+#if TRACE_BUFFER_SIZE < 2 || TRACE_BUFFER_SIZE > 255
+#    error "TRACE_BUFFER_SIZE must be between 2 and 255"
+#endif
+
+_Static_assert(sizeof(trace_record_t) == 8, "trace_record_t must be 8 bytes, the host decoder depends on it");
+
+static trace_record_t trace_buf_data[TRACE_BUFFER_SIZE];
+static ring_buffer_t  trace_buf = RING_BUFFER_INIT(trace_buf_data);
+
+static uint16_t trace_dropped;       // Total since boot
+static uint16_t trace_overflow;      // Not yet reported with a TRACE_OVERFLOW record
+static uint8_t  trace_last_pending;  // Records left over by the previous trace_task()
+
+void trace_record(uint8_t event, uint8_t arg, uint16_t data0, uint16_t data1) {
+    uint16_t now = timer_read();
+
+    /* The gap is reported before the next event that fits, so the decoder can
+     * tell where the stream is missing events. */
+    if (trace_overflow) {
+        if (ring_buffer_count(&trace_buf) + 2 >= TRACE_BUFFER_SIZE) {
+            trace_overflow++;
+            trace_dropped++;
+            return;
+        }
+        trace_record_t overflow = {.time = now, .event = TRACE_OVERFLOW, .data = {trace_overflow, 0}};
+        ring_buffer_push(&trace_buf, &overflow);
+        trace_overflow = 0;
+    }
+
+    trace_record_t record = {.time = now, .event = event, .arg = arg, .data = {data0, data1}};
+    if (!ring_buffer_push(&trace_buf, &record)) {
+        trace_overflow++;
+        trace_dropped++;
+    }
+}
+
+uint16_t trace_dropped_count(void) { return trace_dropped; }
+
+bool trace_peek(trace_record_t *record) { return ring_buffer_peek(&trace_buf, record); }
+
+void trace_clear(void) {
+    ring_buffer_clear(&trace_buf);
+    trace_overflow     = 0;
+    trace_last_pending = 0;
+}
+
+/** \brief Sends one packet of TRACE_PACKET_SIZE bytes to the host
+ *
+ * Uses raw HID when it is enabled, the console otherwise. Can be replaced to
+ * send the trace somewhere else. Returns false if the packet was not sent, it
+ * is then offered again by the next trace_task().
+ */
+__attribute__((weak)) bool trace_send_packet(uint8_t *packet) {
+#if defined(RAW_ENABLE) && !defined(TRACE_OUTPUT_CONSOLE)
+    // Nothing may be reading the interface, so this must not wait for the host
+    return raw_hid_try_send(packet, TRACE_PACKET_SIZE);
+#else
+    // Queued whole or not at all, a packet that is cut short is lost to the decoder
+    if (sendchar_space() < TRACE_PACKET_SIZE) {
+        return false;
+    }
+    for (uint8_t i = 0; i < TRACE_PACKET_SIZE; i++) {
+        sendchar(packet[i]);
+    }
+    return true;
+#endif
+}
+
+/** \brief Streams buffered records to the host
+ *
+ * Sends at most one packet per call. A packet that is not full is only sent
+ * once no new records have arrived since the previous call, so bursts of
+ * events go out in as few packets as possible.
+ */
+void trace_task(void) {
+    uint8_t pending = ring_buffer_count(&trace_buf);
+    if (pending == 0) return;
+    if (pending < TRACE_RECORDS_PER_PACKET && pending != trace_last_pending) {
+        trace_last_pending = pending;
+        return;
+    }
+
+    uint8_t packet[TRACE_PACKET_SIZE] = {TRACE_PACKET_MAGIC};
+    uint8_t count                     = pending < TRACE_RECORDS_PER_PACKET ? pending : TRACE_RECORDS_PER_PACKET;
+    for (uint8_t i = 0; i < count; i++) {
+        trace_record_t record;
+        ring_buffer_peek_at(&trace_buf, i, &record);
+        memcpy(&packet[TRACE_PACKET_HEADER_SIZE + i * sizeof(record)], &record, sizeof(record));
+    }
+    packet[1] = count;
+    if (!trace_send_packet(packet)) {
+        // Kept until the output has room, new events meanwhile count as overflow
+        trace_last_pending = pending;
+        return;
+    }
+    ring_buffer_drop(&trace_buf, count);
+    trace_last_pending = pending - count;
+}
@@ -0,0 +1,81 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Binary event trace.
+ *
+ * Each event is stored as a fixed size record in a RAM buffer, which takes a
+ * few cycles instead of the milliseconds a formatted debug line costs, and is
+ * streamed to the host in packets by trace_task(). `qmk trace` decodes them.
+ *
+ * Packet layout, TRACE_PACKET_SIZE bytes:
+ *   [0] TRACE_PACKET_MAGIC
+ *   [1] number of records that follow
+ *   [2] records, little endian, unused space is zero
+ */
+
+#define TRACE_PACKET_SIZE 32
+#define TRACE_PACKET_MAGIC 0x54
+#define TRACE_PACKET_HEADER_SIZE 2
+#define TRACE_RECORDS_PER_PACKET ((TRACE_PACKET_SIZE - TRACE_PACKET_HEADER_SIZE) / sizeof(trace_record_t))
+
+typedef struct __attribute__((packed)) {
+    uint16_t time;     // timer_read() when the event was recorded
+    uint8_t  event;    // trace_event_id_t
+    uint8_t  arg;      // Event specific
+    uint16_t data[2];  // Event specific
+} trace_record_t;
+
+/* The arguments of each event are documented in docs/faq_debug.md, under
+ * Tracing Events, and have to be kept in sync with lib/python/qmk/trace.py. */
+typedef enum {
+    TRACE_OVERFLOW,             // data[0]: number of events that were dropped
+    TRACE_KEY,                  // arg: pressed, data[0]: row << 8 | col, data[1]: event time
+    TRACE_LAYER_STATE,          // data[0]: low word, data[1]: high word
+    TRACE_DEFAULT_LAYER_STATE,  // data[0]: low word, data[1]: high word
+    TRACE_TAPPING_KEY,          // arg: pressed << 7 | interrupted << 6 | tap count, data[0]: row << 8 | col, data[1]: event time
+    TRACE_REPORT_KEYBOARD,      // arg: mods, data[0]: first key, data[1]: number of keys
+    TRACE_REPORT_MOUSE,         // arg: buttons, data[0]: x, data[1]: y (signed)
+    TRACE_REPORT_SYSTEM,        // data[0]: usage
+    TRACE_REPORT_CONSUMER,      // data[0]: usage
+    TRACE_SPLIT_TRANSACTION,    // arg: transaction id, data[0]: success, data[1]: bytes sent << 8 | bytes received
+    TRACE_USER = 0x80,          // First id free for keyboard and user code
+} trace_event_id_t;
+
+#ifdef TRACE_ENABLE
+
+void trace_record(uint8_t event, uint8_t arg, uint16_t data0, uint16_t data1);
+void trace_task(void);
+bool trace_send_packet(uint8_t *packet);
+
+// Number of events lost because the buffer was full
+uint16_t trace_dropped_count(void);
+
+// Take a copy of the oldest buffered record without streaming it
+bool trace_peek(trace_record_t *record);
+void trace_clear(void);
+
+#    define trace_event(event, arg, data0, data1) trace_record((event), (arg), (data0), (data1))
+
+#else
+
+#    define trace_event(event, arg, data0, data1)
+
+#endif
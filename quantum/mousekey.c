@@ -16,6 +16,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 #include "keycode.h"
 #include "host.h"
 #include "timer.h"
@@ -23,12 +24,23 @@
 #include "debug.h"
 #include "mousekey.h"
 
-inline int8_t times_inv_sqrt2(int8_t x) {
+/* wheel movement is kept in 1/MULTIPLIER detents, mousekey_send() converts it for the host */
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+#    define MOUSEKEY_WHEEL_UNIT POINTING_DEVICE_HIRES_SCROLL_MULTIPLIER
+#else
+#    define MOUSEKEY_WHEEL_UNIT 1
+#endif
+
+inline int16_t times_inv_sqrt2(int16_t x) {
     // 181/256 is pretty close to 1/sqrt(2)
     // 0.70703125                 0.707106781
     // 1 too small for x=99 and x=198
     // This ends up being a mult and discard lower 8 bits
+#if defined(MOUSE_EXTENDED_REPORT) || defined(WHEEL_EXTENDED_REPORT)
+    return ((int32_t)x * 181) >> 8;
+#else
     return (x * 181) >> 8;
+#endif
 }
 
 static report_mouse_t mouse_report = {0};
@@ -39,8 +51,236 @@ static uint8_t        mousekey_wheel_repeat = 0;
 #ifdef MK_KINETIC_SPEED
 static uint16_t mouse_timer = 0;
 #endif
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+static int16_t mousekey_wheel_remainder_v = 0;
+static int16_t mousekey_wheel_remainder_h = 0;
+#endif
+
+#ifdef MK_INERTIA
+
+/*
+ * Inertia mode
+ *
+ * Every axis is simulated with a fixed 1 ms time step, so the cursor path only
+ * depends on when keys are pressed and released, not on how often
+ * mousekey_task() runs. Velocities and positions are Q20 fixed point in report
+ * units per millisecond and report units. Holding a key accelerates the axis
+ * linearly from the initial to the maximum speed, releasing it decelerates the
+ * axis to a stop over MOUSEKEY_INERTIA_STOP_TIME (0 stops immediately).
+ */
+#    define MK_FRAC_BITS 20
+#    define MK_FIXED(x) ((int32_t)(x) << MK_FRAC_BITS)
+#    define MK_SPEED(units_per_s) ((int32_t)(((int64_t)(units_per_s) << MK_FRAC_BITS) / 1000))
+#    define MK_RATE_ROUNDED(from, to, ms) ((MK_SPEED(to) - MK_SPEED(from) + (ms) / 2) / (ms))
+#    define MK_RATE(from, to, ms) ((ms) > 0 ? (MK_RATE_ROUNDED(from, to, ms) > 0 ? MK_RATE_ROUNDED(from, to, ms) : 1) : 0)
+/* the longest stretch advanced in one go, keeps the closed form inside int32_t */
+#    define MK_MAX_STEPS 32
+/* Movement not yet reported is capped to this, so a long stall is not made up
+ * for and MK_MAX_STEPS at the highest speed still fits inside int32_t */
+#    define MK_POSITION_MAX MK_FIXED(1023)
+/* units per second that move at most 1024 units in MK_MAX_STEPS */
+#    define MK_SPEED_LIMIT 32000
+
+#    if MOUSEKEY_INERTIA_MAX_SPEED > MK_SPEED_LIMIT
+#        error "MOUSEKEY_INERTIA_MAX_SPEED is too large"
+#    endif
+#    if MOUSEKEY_INERTIA_WHEEL_MAX_SPEED * MOUSEKEY_WHEEL_UNIT > MK_SPEED_LIMIT
+#        error "MOUSEKEY_INERTIA_WHEEL_MAX_SPEED is too large for the wheel resolution multiplier"
+#    endif
+
+typedef struct {
+    int32_t initial; /* Q20 units per ms */
+    int32_t max;     /* Q20 units per ms */
+    int32_t accel;   /* Q20 units per ms per ms, 0 jumps to the maximum */
+    int32_t decel;   /* Q20 units per ms per ms, 0 stops immediately */
+} mousekey_kinematics_t;
+
+typedef struct {
+    int32_t velocity;  /* Q20 units per ms */
+    int32_t position;  /* Q20 units not yet reported */
+    int8_t  direction; /* held direction: -1, 0 or 1 */
+} mousekey_axis_t;
+
+enum { MK_AXIS_X, MK_AXIS_Y, MK_AXIS_V, MK_AXIS_H, MK_AXIS_COUNT };
+
+static const mousekey_kinematics_t mk_cursor_kinematics = {
+    .initial = MK_SPEED(MOUSEKEY_INERTIA_INITIAL_SPEED),
+    .max     = MK_SPEED(MOUSEKEY_INERTIA_MAX_SPEED),
+    .accel   = MK_RATE(MOUSEKEY_INERTIA_INITIAL_SPEED, MOUSEKEY_INERTIA_MAX_SPEED, MOUSEKEY_INERTIA_TIME_TO_MAX),
+    .decel   = MK_RATE(0, MOUSEKEY_INERTIA_MAX_SPEED, MOUSEKEY_INERTIA_STOP_TIME),
+};
+static const mousekey_kinematics_t mk_wheel_kinematics = {
+    .initial = MK_SPEED(MOUSEKEY_INERTIA_WHEEL_INITIAL_SPEED * MOUSEKEY_WHEEL_UNIT),
+    .max     = MK_SPEED(MOUSEKEY_INERTIA_WHEEL_MAX_SPEED * MOUSEKEY_WHEEL_UNIT),
+    .accel   = MK_RATE(MOUSEKEY_INERTIA_WHEEL_INITIAL_SPEED * MOUSEKEY_WHEEL_UNIT, MOUSEKEY_INERTIA_WHEEL_MAX_SPEED * MOUSEKEY_WHEEL_UNIT, MOUSEKEY_INERTIA_WHEEL_TIME_TO_MAX),
+    .decel   = MK_RATE(0, MOUSEKEY_INERTIA_WHEEL_MAX_SPEED * MOUSEKEY_WHEEL_UNIT, MOUSEKEY_INERTIA_WHEEL_STOP_TIME),
+};
+
+static mousekey_axis_t mk_axes[MK_AXIS_COUNT];
+static uint16_t        mk_last_update = 0;
+
+static bool mousekey_axis_is_idle(const mousekey_axis_t *axis) { return !axis->velocity && !axis->direction; }
+
+static int32_t mousekey_axis_target(const mousekey_axis_t *axis, const mousekey_axis_t *other, const mousekey_kinematics_t *k) {
+    int32_t speed = k->max;
+    if (mousekey_accel & (1 << 0)) {
+        speed /= 4;
+    } else if (mousekey_accel & (1 << 1)) {
+        speed /= 2;
+    }
+    /* diagonal move [1/sqrt(2)] */
+    if (other->direction) {
+        speed = (speed >> 8) * 181;
+    }
+    return axis->direction * speed;
+}
+
+/* Advances one axis by `steps` 1 ms steps, moving its velocity towards `target` by at most `rate` per step. */
+static void mousekey_axis_advance(mousekey_axis_t *axis, int32_t target, int32_t rate, uint16_t steps) {
+    int32_t gap = target - axis->velocity;
+
+    if (gap && rate) {
+        int32_t  step = gap > 0 ? rate : -rate;
+        uint32_t ramp = (uint32_t)(gap > 0 ? gap : -gap) / (uint32_t)rate;
+        if (ramp > steps) ramp = steps;
+        /* sum of velocity + k * step for k = 1..ramp */
+        axis->position += (int32_t)ramp * axis->velocity + (int32_t)(ramp * (ramp + 1) / 2) * step;
+        axis->velocity += (int32_t)ramp * step;
+        steps -= ramp;
+    }
+    if (steps) {
+        axis->velocity = target;
+        axis->position += target * steps;
+    }
+}
+
+static void mousekey_inertia_update(void) {
+    uint16_t elapsed = timer_elapsed(mk_last_update);
+    mk_last_update += elapsed;
+
+    bool idle = true;
+    for (uint8_t i = 0; i < MK_AXIS_COUNT; i++) {
+        idle &= mousekey_axis_is_idle(&mk_axes[i]);
+    }
+    if (idle) return;
+
+    while (elapsed) {
+        uint16_t steps = elapsed > MK_MAX_STEPS ? MK_MAX_STEPS : elapsed;
+        elapsed -= steps;
+
+        for (uint8_t i = 0; i < MK_AXIS_COUNT; i++) {
+            mousekey_axis_t *axis = &mk_axes[i];
+            if (mousekey_axis_is_idle(axis)) continue;
+
+            const mousekey_kinematics_t *k      = i < MK_AXIS_V ? &mk_cursor_kinematics : &mk_wheel_kinematics;
+            int32_t                      target = mousekey_axis_target(axis, &mk_axes[i ^ 1], k);
+            mousekey_axis_advance(axis, target, axis->direction ? k->accel : k->decel, steps);
+            if (axis->position > MK_POSITION_MAX) {
+                axis->position = MK_POSITION_MAX;
+            } else if (axis->position < -MK_POSITION_MAX) {
+                axis->position = -MK_POSITION_MAX;
+            }
+        }
+    }
+}
+
+/* Takes the whole units accumulated on an axis, leaving the sub-unit remainder behind. */
+static int16_t mousekey_axis_take(mousekey_axis_t *axis, int16_t limit) {
+    int32_t units = axis->position >> MK_FRAC_BITS;
+    if (units > limit) {
+        units = limit;
+    } else if (units < -limit) {
+        units = -limit;
+    }
+    axis->position -= MK_FIXED(units);
+    return units;
+}
+
+void mousekey_task(void) {
+    mousekey_inertia_update();
+
+    mouse_report.x = mousekey_axis_take(&mk_axes[MK_AXIS_X], MOUSE_REPORT_XY_MAX);
+    mouse_report.y = mousekey_axis_take(&mk_axes[MK_AXIS_Y], MOUSE_REPORT_XY_MAX);
+    mouse_report.v = mousekey_axis_take(&mk_axes[MK_AXIS_V], MOUSE_REPORT_HV_MAX);
+    mouse_report.h = mousekey_axis_take(&mk_axes[MK_AXIS_H], MOUSE_REPORT_HV_MAX);
+
+    if (mouse_report.x || mouse_report.y || mouse_report.v || mouse_report.h) mousekey_send();
+}
+
+static void mousekey_axis_on(mousekey_axis_t *axis, int8_t direction, const mousekey_kinematics_t *k) {
+    axis->direction = direction;
+    /* start at the initial speed, and move by one unit straight away when starting from rest */
+    if (axis->velocity * direction < k->initial) {
+        if (!axis->velocity) axis->position = MK_FIXED(direction);
+        axis->velocity = direction * k->initial;
+    }
+}
+
+static void mousekey_axis_off(mousekey_axis_t *axis, int8_t direction, const mousekey_kinematics_t *k) {
+    if (axis->direction != direction) return;
+    axis->direction = 0;
+    if (!k->decel) axis->velocity = 0;
+}
+
+void mousekey_on(uint8_t code) {
+    mousekey_inertia_update();
+
+    if (code == KC_MS_UP)
+        mousekey_axis_on(&mk_axes[MK_AXIS_Y], -1, &mk_cursor_kinematics);
+    else if (code == KC_MS_DOWN)
+        mousekey_axis_on(&mk_axes[MK_AXIS_Y], 1, &mk_cursor_kinematics);
+    else if (code == KC_MS_LEFT)
+        mousekey_axis_on(&mk_axes[MK_AXIS_X], -1, &mk_cursor_kinematics);
+    else if (code == KC_MS_RIGHT)
+        mousekey_axis_on(&mk_axes[MK_AXIS_X], 1, &mk_cursor_kinematics);
+    else if (code == KC_MS_WH_UP)
+        mousekey_axis_on(&mk_axes[MK_AXIS_V], 1, &mk_wheel_kinematics);
+    else if (code == KC_MS_WH_DOWN)
+        mousekey_axis_on(&mk_axes[MK_AXIS_V], -1, &mk_wheel_kinematics);
+    else if (code == KC_MS_WH_LEFT)
+        mousekey_axis_on(&mk_axes[MK_AXIS_H], -1, &mk_wheel_kinematics);
+    else if (code == KC_MS_WH_RIGHT)
+        mousekey_axis_on(&mk_axes[MK_AXIS_H], 1, &mk_wheel_kinematics);
+    else if (IS_MOUSEKEY_BUTTON(code))
+        mouse_report.buttons |= 1 << (code - KC_MS_BTN1);
+    else if (code == KC_MS_ACCEL0)
+        mousekey_accel |= (1 << 0);
+    else if (code == KC_MS_ACCEL1)
+        mousekey_accel |= (1 << 1);
+    else if (code == KC_MS_ACCEL2)
+        mousekey_accel |= (1 << 2);
+}
 
-#ifndef MK_3_SPEED
+void mousekey_off(uint8_t code) {
+    mousekey_inertia_update();
+
+    if (code == KC_MS_UP)
+        mousekey_axis_off(&mk_axes[MK_AXIS_Y], -1, &mk_cursor_kinematics);
+    else if (code == KC_MS_DOWN)
+        mousekey_axis_off(&mk_axes[MK_AXIS_Y], 1, &mk_cursor_kinematics);
+    else if (code == KC_MS_LEFT)
+        mousekey_axis_off(&mk_axes[MK_AXIS_X], -1, &mk_cursor_kinematics);
+    else if (code == KC_MS_RIGHT)
+        mousekey_axis_off(&mk_axes[MK_AXIS_X], 1, &mk_cursor_kinematics);
+    else if (code == KC_MS_WH_UP)
+        mousekey_axis_off(&mk_axes[MK_AXIS_V], 1, &mk_wheel_kinematics);
+    else if (code == KC_MS_WH_DOWN)
+        mousekey_axis_off(&mk_axes[MK_AXIS_V], -1, &mk_wheel_kinematics);
+    else if (code == KC_MS_WH_LEFT)
+        mousekey_axis_off(&mk_axes[MK_AXIS_H], -1, &mk_wheel_kinematics);
+    else if (code == KC_MS_WH_RIGHT)
+        mousekey_axis_off(&mk_axes[MK_AXIS_H], 1, &mk_wheel_kinematics);
+    else if (IS_MOUSEKEY_BUTTON(code))
+        mouse_report.buttons &= ~(1 << (code - KC_MS_BTN1));
+    else if (code == KC_MS_ACCEL0)
+        mousekey_accel &= ~(1 << 0);
+    else if (code == KC_MS_ACCEL1)
+        mousekey_accel &= ~(1 << 1);
+    else if (code == KC_MS_ACCEL2)
+        mousekey_accel &= ~(1 << 2);
+}
+
+#elif !defined(MK_3_SPEED)
 
 static uint16_t last_timer_c = 0;
 static uint16_t last_timer_w = 0;
@@ -71,7 +311,7 @@ uint8_t mk_wheel_time_to_max = MOUSEKEY_WHEEL_TIME_TO_MAX;
 
 #    ifndef MK_COMBINED
 
-static uint8_t move_unit(void) {
+static uint16_t move_unit(void) {
     uint16_t unit;
     if (mousekey_accel & (1 << 0)) {
         unit = (MOUSEKEY_MOVE_DELTA * mk_max_speed) / 4;
@@ -89,7 +329,7 @@ static uint8_t move_unit(void) {
     return (unit > MOUSEKEY_MOVE_MAX ? MOUSEKEY_MOVE_MAX : (unit == 0 ? 1 : unit));
 }
 
-static uint8_t wheel_unit(void) {
+static uint16_t wheel_unit(void) {
     uint16_t unit;
     if (mousekey_accel & (1 << 0)) {
         unit = (MOUSEKEY_WHEEL_DELTA * mk_wheel_max_speed) / 4;
@@ -104,7 +344,7 @@ static uint8_t wheel_unit(void) {
     } else {
         unit = (MOUSEKEY_WHEEL_DELTA * mk_wheel_max_speed * mousekey_wheel_repeat) / mk_wheel_time_to_max;
     }
-    return (unit > MOUSEKEY_WHEEL_MAX ? MOUSEKEY_WHEEL_MAX : (unit == 0 ? 1 : unit));
+    return (unit > MOUSEKEY_WHEEL_MAX ? MOUSEKEY_WHEEL_MAX : (unit == 0 ? 1 : unit)) * MOUSEKEY_WHEEL_UNIT;
 }
 
 #    else /* #ifndef MK_COMBINED */
@@ -127,7 +367,7 @@ const uint16_t mk_base_speed        = MOUSEKEY_BASE_SPEED;
 const uint16_t mk_decelerated_speed = MOUSEKEY_DECELERATED_SPEED;
 const uint16_t mk_initial_speed     = MOUSEKEY_INITIAL_SPEED;
 
-static uint8_t move_unit(void) {
+static uint16_t move_unit(void) {
     float speed = mk_initial_speed;
 
     if (mousekey_accel & ((1 << 0) | (1 << 2))) {
@@ -139,8 +379,8 @@ static uint8_t move_unit(void) {
         speed = speed > mk_base_speed ? mk_base_speed : speed;
     }
 
-    /* convert speed to USB mouse speed 1 to 127 */
-    speed = (uint8_t)(speed / (1000.0f / mk_interval));
+    /* convert speed to USB mouse speed 1 to MOUSEKEY_MOVE_MAX */
+    speed = (uint16_t)(speed / (1000.0f / mk_interval));
     speed = speed < 1 ? 1 : speed;
 
     return speed > MOUSEKEY_MOVE_MAX ? MOUSEKEY_MOVE_MAX : speed;
@@ -148,7 +388,7 @@ static uint8_t move_unit(void) {
 
 float mk_wheel_interval = 1000.0f / MOUSEKEY_WHEEL_INITIAL_MOVEMENTS;
 
-static uint8_t wheel_unit(void) {
+static uint16_t wheel_unit(void) {
     float speed = MOUSEKEY_WHEEL_INITIAL_MOVEMENTS;
 
     if (mousekey_accel & ((1 << 0) | (1 << 2))) {
@@ -163,12 +403,12 @@ static uint8_t wheel_unit(void) {
 
     mk_wheel_interval = 1000.0f / speed;
 
-    return 1;
+    return MOUSEKEY_WHEEL_UNIT;
 }
 
 #        else /* #ifndef MK_KINETIC_SPEED */
 
-static uint8_t move_unit(void) {
+static uint16_t move_unit(void) {
     uint16_t unit;
     if (mousekey_accel & (1 << 0)) {
         unit = 1;
@@ -186,7 +426,7 @@ static uint8_t move_unit(void) {
     return (unit > MOUSEKEY_MOVE_MAX ? MOUSEKEY_MOVE_MAX : (unit == 0 ? 1 : unit));
 }
 
-static uint8_t wheel_unit(void) {
+static uint16_t wheel_unit(void) {
     uint16_t unit;
     if (mousekey_accel & (1 << 0)) {
         unit = 1;
@@ -201,7 +441,7 @@ static uint8_t wheel_unit(void) {
     } else {
         unit = (MOUSEKEY_WHEEL_DELTA * mk_wheel_max_speed * mousekey_repeat) / mk_wheel_time_to_max;
     }
-    return (unit > MOUSEKEY_WHEEL_MAX ? MOUSEKEY_WHEEL_MAX : (unit == 0 ? 1 : unit));
+    return (unit > MOUSEKEY_WHEEL_MAX ? MOUSEKEY_WHEEL_MAX : (unit == 0 ? 1 : unit)) * MOUSEKEY_WHEEL_UNIT;
 }
 
 #        endif /* #ifndef MK_KINETIC_SPEED */
@@ -322,7 +562,7 @@ void mousekey_off(uint8_t code) {
     if (mouse_report.v == 0 && mouse_report.h == 0) mousekey_wheel_repeat = 0;
 }
 
-#else /* #ifndef MK_3_SPEED */
+#else /* MK_3_SPEED */
 
 enum { mkspd_unmod, mkspd_0, mkspd_1, mkspd_2, mkspd_COUNT };
 #    ifndef MK_MOMENTARY_ACCEL
@@ -361,7 +601,7 @@ void mousekey_task(void) {
 
 void adjust_speed(void) {
     uint16_t const c_offset = c_offsets[mk_speed];
-    uint16_t const w_offset = w_offsets[mk_speed];
+    uint16_t const w_offset = w_offsets[mk_speed] * MOUSEKEY_WHEEL_UNIT;
     if (mouse_report.x > 0) mouse_report.x = c_offset;
     if (mouse_report.x < 0) mouse_report.x = c_offset * -1;
     if (mouse_report.y > 0) mouse_report.y = c_offset;
@@ -389,7 +629,7 @@ void adjust_speed(void) {
 
 void mousekey_on(uint8_t code) {
     uint16_t const c_offset  = c_offsets[mk_speed];
-    uint16_t const w_offset  = w_offsets[mk_speed];
+    uint16_t const w_offset  = w_offsets[mk_speed] * MOUSEKEY_WHEEL_UNIT;
     uint8_t const  old_speed = mk_speed;
     if (code == KC_MS_UP)
         mouse_report.y = c_offset * -1;
@@ -451,14 +691,45 @@ void mousekey_off(uint8_t code) {
 #    endif
 }
 
-#endif /* #ifndef MK_3_SPEED */
+#endif /* MK_INERTIA */
+
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+/* Whole detents for an axis the host has not enabled the resolution multiplier on, carrying the rest over. */
+static mouse_hv_report_t mousekey_wheel_for_host(mouse_hv_report_t units, uint8_t axis, int16_t *remainder) {
+    if (host_mouse_wheel_multiplier(axis) == MOUSEKEY_WHEEL_UNIT) return units;
+
+    int32_t total = (int32_t)*remainder + units;
+    *remainder    = total % MOUSEKEY_WHEEL_UNIT;
+    return total / MOUSEKEY_WHEEL_UNIT;
+}
+#endif
+
+static void mousekey_host_send(void) {
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+    report_mouse_t report = mouse_report;
+    report.v              = mousekey_wheel_for_host(report.v, MOUSE_RESOLUTION_MULTIPLIER_V, &mousekey_wheel_remainder_v);
+    report.h              = mousekey_wheel_for_host(report.h, MOUSE_RESOLUTION_MULTIPLIER_H, &mousekey_wheel_remainder_h);
+    host_mouse_send(&report);
+#else
+    host_mouse_send(&mouse_report);
+#endif
+}
 
 void mousekey_send(void) {
     mousekey_debug();
+#ifdef MK_INERTIA
+    mousekey_host_send();
+    // movement is only ever reported once, the axes keep their own remainders
+    mouse_report.x = 0;
+    mouse_report.y = 0;
+    mouse_report.v = 0;
+    mouse_report.h = 0;
+#else
     uint16_t time = timer_read();
     if (mouse_report.x || mouse_report.y) last_timer_c = time;
     if (mouse_report.v || mouse_report.h) last_timer_w = time;
-    host_mouse_send(&mouse_report);
+    mousekey_host_send();
+#endif
 }
 
 void mousekey_clear(void) {
@@ -466,6 +737,13 @@ void mousekey_clear(void) {
     mousekey_repeat       = 0;
     mousekey_wheel_repeat = 0;
     mousekey_accel        = 0;
+#ifdef MK_INERTIA
+    memset(mk_axes, 0, sizeof(mk_axes));
+#endif
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+    mousekey_wheel_remainder_v = 0;
+    mousekey_wheel_remainder_h = 0;
+#endif
 }
 
 static void mousekey_debug(void) {
@@ -20,13 +20,55 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdint.h>
 #include "host.h"
 
+#if defined(MK_INERTIA) && (defined(MK_3_SPEED) || defined(MK_COMBINED))
+#    error "MK_INERTIA cannot be combined with MK_3_SPEED or MK_COMBINED"
+#endif
+
+#ifdef MK_INERTIA
+
+/* cursor speeds in pixels per second, times in milliseconds */
+#    ifndef MOUSEKEY_INERTIA_INITIAL_SPEED
+#        define MOUSEKEY_INERTIA_INITIAL_SPEED 100
+#    endif
+#    ifndef MOUSEKEY_INERTIA_MAX_SPEED
+#        define MOUSEKEY_INERTIA_MAX_SPEED 1000
+#    endif
+#    ifndef MOUSEKEY_INERTIA_TIME_TO_MAX
+#        define MOUSEKEY_INERTIA_TIME_TO_MAX 1000
+#    endif
+#    ifndef MOUSEKEY_INERTIA_STOP_TIME
+#        define MOUSEKEY_INERTIA_STOP_TIME 100
+#    endif
+/* wheel speeds in scroll steps per second, times in milliseconds */
+#    ifndef MOUSEKEY_INERTIA_WHEEL_INITIAL_SPEED
+#        define MOUSEKEY_INERTIA_WHEEL_INITIAL_SPEED 10
+#    endif
+#    ifndef MOUSEKEY_INERTIA_WHEEL_MAX_SPEED
+#        define MOUSEKEY_INERTIA_WHEEL_MAX_SPEED 40
+#    endif
+#    ifndef MOUSEKEY_INERTIA_WHEEL_TIME_TO_MAX
+#        define MOUSEKEY_INERTIA_WHEEL_TIME_TO_MAX 1000
+#    endif
+#    ifndef MOUSEKEY_INERTIA_WHEEL_STOP_TIME
+#        define MOUSEKEY_INERTIA_WHEEL_STOP_TIME 0
+#    endif
+
+#    if MOUSEKEY_INERTIA_MAX_SPEED > 32767 || MOUSEKEY_INERTIA_WHEEL_MAX_SPEED > 32767
+#        error "MOUSEKEY_INERTIA_MAX_SPEED and MOUSEKEY_INERTIA_WHEEL_MAX_SPEED need to be smaller than 32767"
+#    endif
+#    if MOUSEKEY_INERTIA_INITIAL_SPEED > MOUSEKEY_INERTIA_MAX_SPEED || MOUSEKEY_INERTIA_WHEEL_INITIAL_SPEED > MOUSEKEY_INERTIA_WHEEL_MAX_SPEED
+#        error "Mousekey inertia initial speeds cannot exceed the maximum speeds"
+#    endif
+
+#endif /* #ifdef MK_INERTIA */
+
 #ifndef MK_3_SPEED
 
 /* max value on report descriptor */
 #    ifndef MOUSEKEY_MOVE_MAX
 #        define MOUSEKEY_MOVE_MAX 127
-#    elif MOUSEKEY_MOVE_MAX > 127
-#        error MOUSEKEY_MOVE_MAX needs to be smaller than 127
+#    elif MOUSEKEY_MOVE_MAX > MOUSE_REPORT_XY_MAX
+#        error MOUSEKEY_MOVE_MAX needs to be smaller than MOUSE_REPORT_XY_MAX
 #    endif
 
 #    ifndef MOUSEKEY_WHEEL_MAX
@@ -79,7 +79,7 @@ __attribute__((weak)) void pointing_device_task(void) {
 
         // Support rotation of the sensor data
 #if defined(POINTING_DEVICE_ROTATION_90) || defined(POINTING_DEVICE_ROTATION_180) || defined(POINTING_DEVICE_ROTATION_270)
-    int8_t x = mouseReport.x, y = mouseReport.y;
+    mouse_xy_report_t x = mouseReport.x, y = mouseReport.y;
 #    if defined(POINTING_DEVICE_ROTATION_90)
     mouseReport.x = y;
     mouseReport.y = -x;
@@ -17,6 +17,8 @@
 
 /* Author: Wojciech Siewierski < wojciech dot siewierski at onet dot pl > */
 #include "process_dynamic_macro.h"
+#include <string.h>
+#include "eeprom.h"
 
 // default feedback method
 void dynamic_macro_led_blink(void) {
@@ -44,13 +46,257 @@ __attribute__((weak)) void dynamic_macro_record_end_user(int8_t direction) { dyn
 #define DYNAMIC_MACRO_CURRENT_LENGTH(BEGIN, POINTER) ((int)(direction * ((POINTER) - (BEGIN))))
 #define DYNAMIC_MACRO_CURRENT_CAPACITY(BEGIN, END2) ((int)(direction * ((END2) - (BEGIN)) + 1))
 
+/* The buffer takes as much memory as DYNAMIC_MACRO_SIZE whole keyrecord_t
+ * structs used to, but events are stored in a compact encoding:
+ *
+ * - With DYNAMIC_MACRO_TIMING, the time since the previous event in ms, as
+ *   one byte below 128ms, or two bytes with the high bit of the first byte
+ *   set (capped at DYNAMIC_MACRO_MAX_DELAY).
+ * - One byte with the press state in the high bit and the key index
+ *   (row * MATRIX_COLS + col) in the low bits. Keys outside of the index
+ *   range, and records carrying tap state, use DYNAMIC_MACRO_ESCAPE instead
+ *   and are followed by the row, column and tap state bytes.
+ *
+ * The bytes of an event are read in the same order they are written, in
+ * the direction of the macro, so both macros can use the same code.
+ */
+#define DYNAMIC_MACRO_BUFFER_SIZE (DYNAMIC_MACRO_SIZE * sizeof(keyrecord_t))
+#define DYNAMIC_MACRO_PRESSED 0x80
+#define DYNAMIC_MACRO_ESCAPE 0x7F
+#define DYNAMIC_MACRO_MAX_DELAY 0x3FFF
+#define DYNAMIC_MACRO_MAX_EVENT_SIZE 6
+
+#if defined(DYNAMIC_MACRO_TIMING) && !defined(DEFERRED_EXEC_ENABLE)
+#    error "DYNAMIC_MACRO_TIMING requires DEFERRED_EXEC_ENABLE = yes"
+#endif
+
+#ifdef DYNAMIC_MACRO_PERSISTENT
+#    ifndef DYNAMIC_MACRO_EEPROM_ADDR
+#        if defined(DYNAMIC_KEYMAP_ENABLE) || defined(VIA_ENABLE)
+#            error "DYNAMIC_MACRO_EEPROM_ADDR must point to an unused EEPROM area when the dynamic keymap is enabled"
+#        endif
+#        define DYNAMIC_MACRO_EEPROM_ADDR EECONFIG_SIZE
+#    endif
+
+/* Last EEPROM address, the same defaults as DYNAMIC_KEYMAP_EEPROM_MAX_ADDR */
+#    ifndef DYNAMIC_MACRO_EEPROM_MAX_ADDR
+#        if defined(__AVR_AT90USB646__) || defined(__AVR_AT90USB647__)
+#            define DYNAMIC_MACRO_EEPROM_MAX_ADDR 2047
+#        elif defined(__AVR_AT90USB1286__) || defined(__AVR_AT90USB1287__)
+#            define DYNAMIC_MACRO_EEPROM_MAX_ADDR 4095
+#        elif defined(__AVR_ATmega16U2__) || defined(__AVR_ATmega16U4__) || defined(__AVR_AT90USB162__) || defined(__AVR_ATtiny85__)
+#            define DYNAMIC_MACRO_EEPROM_MAX_ADDR 511
+#        else
+#            define DYNAMIC_MACRO_EEPROM_MAX_ADDR 1023
+#        endif
+#    endif
+
+/* Header: magic byte, buffer size, length of macro 1, length of macro 2 */
+#    define DYNAMIC_MACRO_EEPROM_MAGIC_ADDR ((uint8_t *)(DYNAMIC_MACRO_EEPROM_ADDR))
+#    define DYNAMIC_MACRO_EEPROM_SIZE_ADDR ((uint16_t *)(DYNAMIC_MACRO_EEPROM_ADDR + 1))
+#    define DYNAMIC_MACRO_EEPROM_LENGTH1_ADDR ((uint16_t *)(DYNAMIC_MACRO_EEPROM_ADDR + 3))
+#    define DYNAMIC_MACRO_EEPROM_LENGTH2_ADDR ((uint16_t *)(DYNAMIC_MACRO_EEPROM_ADDR + 5))
+#    define DYNAMIC_MACRO_EEPROM_BUFFER_ADDR ((uint8_t *)(DYNAMIC_MACRO_EEPROM_ADDR + 7))
+
+#    ifdef DYNAMIC_MACRO_TIMING
+#        define DYNAMIC_MACRO_EEPROM_MAGIC 0xD3
+#    else
+#        define DYNAMIC_MACRO_EEPROM_MAGIC 0xD2
+#    endif
+
+_Static_assert(DYNAMIC_MACRO_EEPROM_ADDR + 7 + DYNAMIC_MACRO_BUFFER_SIZE <= DYNAMIC_MACRO_EEPROM_MAX_ADDR + 1, "DYNAMIC_MACRO_SIZE is too large to be saved to EEPROM, reduce it or DYNAMIC_MACRO_EEPROM_ADDR");
+#endif
+
+/* Both macros use the same buffer but read/write on different
+ * ends of it.
+ *
+ * Macro1 is written left-to-right starting from the beginning of
+ * the buffer.
+ *
+ * Macro2 is written right-to-left starting from the end of the
+ * buffer.
+ *
+ * &macro_buffer   macro_end
+ *  v                   v
+ * +------------------------------------------------------------+
+ * |>>>>>> MACRO1 >>>>>>      <<<<<<<<<<<<< MACRO2 <<<<<<<<<<<<<|
+ * +------------------------------------------------------------+
+ *                           ^                                 ^
+ *                         r_macro_end                  r_macro_buffer
+ *
+ * During the recording when one macro encounters the end of the
+ * other macro, the recording is stopped. Apart from this, there
+ * are no arbitrary limits for the macros' length in relation to
+ * each other: for example one can either have two medium sized
+ * macros or one long macro and one short macro. Or even one empty
+ * and one using the whole buffer.
+ */
+static uint8_t macro_buffer[DYNAMIC_MACRO_BUFFER_SIZE];
+
+/* Pointer to the first buffer element after the first macro.
+ * Initially points to the very beginning of the buffer since the
+ * macro is empty. */
+static uint8_t *macro_end = macro_buffer;
+
+/* The other end of the macro buffer. Serves as the beginning of
+ * the second macro. */
+static uint8_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_BUFFER_SIZE - 1;
+
+/* Like macro_end but for the second macro. */
+static uint8_t *r_macro_end = r_macro_buffer;
+
+#ifdef DYNAMIC_MACRO_TIMING
+/* Time of the last recorded event. */
+static uint16_t macro_last_time;
+
+/* State of the macro being played back. */
+static struct {
+    uint8_t *     pointer;
+    uint8_t *     end;
+    int8_t        direction;
+    bool          delayed;
+    layer_state_t saved_layer_state;
+    layer_state_t changed_layers;
+    matrix_row_t  held_keys[MATRIX_ROWS];
+} macro_playback;
+
+static deferred_token macro_playback_token = INVALID_DEFERRED_TOKEN;
+#endif
+
+/**
+ * Encode a key event.
+ *
+ * @param[in]  record  The event to encode.
+ * @param[in]  delay   The time since the previous event.
+ * @param[out] encoded At least DYNAMIC_MACRO_MAX_EVENT_SIZE bytes.
+ * @return The number of bytes used.
+ */
+static uint8_t dynamic_macro_encode(keyrecord_t *record, uint16_t delay, uint8_t *encoded) {
+    uint8_t length  = 0;
+    uint8_t pressed = record->event.pressed ? DYNAMIC_MACRO_PRESSED : 0;
+    uint8_t row     = record->event.key.row;
+    uint8_t col     = record->event.key.col;
+    uint8_t tap     = 0;
+
+#ifdef DYNAMIC_MACRO_TIMING
+    if (delay > DYNAMIC_MACRO_MAX_DELAY) {
+        delay = DYNAMIC_MACRO_MAX_DELAY;
+    }
+    if (delay >= 0x80) {
+        encoded[length++] = 0x80 | (delay >> 7);
+    }
+    encoded[length++] = delay & 0x7F;
+#endif
+#ifndef NO_ACTION_TAPPING
+    tap = record->tap.count << 4 | record->tap.interrupted;
+#endif
+
+    if (tap == 0 && row < MATRIX_ROWS && col < MATRIX_COLS && row * MATRIX_COLS + col < DYNAMIC_MACRO_ESCAPE) {
+        encoded[length++] = pressed | (row * MATRIX_COLS + col);
+    } else {
+        encoded[length++] = pressed | DYNAMIC_MACRO_ESCAPE;
+        encoded[length++] = row;
+        encoded[length++] = col;
+        encoded[length++] = tap;
+    }
+    return length;
+}
+
+static uint8_t dynamic_macro_read_byte(uint8_t **pointer, int8_t direction) {
+    uint8_t byte = **pointer;
+    *pointer += direction;
+    return byte;
+}
+
+#ifdef DYNAMIC_MACRO_TIMING
+static uint16_t dynamic_macro_decode_delay(uint8_t **pointer, int8_t direction) {
+    uint16_t delay = dynamic_macro_read_byte(pointer, direction);
+    if (delay & 0x80) {
+        delay = (delay & 0x7F) << 7 | dynamic_macro_read_byte(pointer, direction);
+    }
+    return delay;
+}
+#endif
+
+static void dynamic_macro_decode_key(uint8_t **pointer, int8_t direction, keyrecord_t *record) {
+    uint8_t byte = dynamic_macro_read_byte(pointer, direction);
+
+    *record = (keyrecord_t){.event = {.pressed = byte & DYNAMIC_MACRO_PRESSED, .time = timer_read() | 1}};
+    if ((byte & ~DYNAMIC_MACRO_PRESSED) == DYNAMIC_MACRO_ESCAPE) {
+        record->event.key.row = dynamic_macro_read_byte(pointer, direction);
+        record->event.key.col = dynamic_macro_read_byte(pointer, direction);
+        uint8_t tap           = dynamic_macro_read_byte(pointer, direction);
+#ifndef NO_ACTION_TAPPING
+        record->tap.count       = tap >> 4;
+        record->tap.interrupted = tap & 1;
+#else
+        (void)tap;
+#endif
+    } else {
+        record->event.key.row = (byte & ~DYNAMIC_MACRO_PRESSED) / MATRIX_COLS;
+        record->event.key.col = (byte & ~DYNAMIC_MACRO_PRESSED) % MATRIX_COLS;
+    }
+}
+
+static void dynamic_macro_decode(uint8_t **pointer, int8_t direction, keyrecord_t *record) {
+#ifdef DYNAMIC_MACRO_TIMING
+    dynamic_macro_decode_delay(pointer, direction);
+#endif
+    dynamic_macro_decode_key(pointer, direction, record);
+}
+
+#ifdef DYNAMIC_MACRO_PERSISTENT
+/**
+ * Load the macros saved by dynamic_macro_save(), if there are any.
+ */
+static void dynamic_macro_load(void) {
+    if (eeprom_read_byte(DYNAMIC_MACRO_EEPROM_MAGIC_ADDR) != DYNAMIC_MACRO_EEPROM_MAGIC || eeprom_read_word(DYNAMIC_MACRO_EEPROM_SIZE_ADDR) != DYNAMIC_MACRO_BUFFER_SIZE) {
+        return;
+    }
+
+    uint16_t length1 = eeprom_read_word(DYNAMIC_MACRO_EEPROM_LENGTH1_ADDR);
+    uint16_t length2 = eeprom_read_word(DYNAMIC_MACRO_EEPROM_LENGTH2_ADDR);
+    if (length1 + length2 > DYNAMIC_MACRO_BUFFER_SIZE) {
+        return;
+    }
+
+    eeprom_read_block(macro_buffer, DYNAMIC_MACRO_EEPROM_BUFFER_ADDR, length1);
+    eeprom_read_block(r_macro_buffer + 1 - length2, DYNAMIC_MACRO_EEPROM_BUFFER_ADDR + DYNAMIC_MACRO_BUFFER_SIZE - length2, length2);
+    macro_end   = macro_buffer + length1;
+    r_macro_end = r_macro_buffer - length2;
+
+    dprintf("dynamic macro: loaded, length: %d, %d\n", length1, length2);
+}
+
+/**
+ * Save a macro after it has been recorded. Only changed bytes are written.
+ */
+static void dynamic_macro_save(int8_t direction) {
+    uint16_t length1 = macro_end - macro_buffer;
+    uint16_t length2 = r_macro_buffer - r_macro_end;
+
+    if (direction > 0) {
+        eeprom_update_block(macro_buffer, DYNAMIC_MACRO_EEPROM_BUFFER_ADDR, length1);
+    } else {
+        eeprom_update_block(r_macro_end + 1, DYNAMIC_MACRO_EEPROM_BUFFER_ADDR + DYNAMIC_MACRO_BUFFER_SIZE - length2, length2);
+    }
+
+    /* The other macro was either loaded or saved when it was recorded,
+     * but its length has not been written yet if the header is new. */
+    eeprom_update_word(DYNAMIC_MACRO_EEPROM_LENGTH1_ADDR, length1);
+    eeprom_update_word(DYNAMIC_MACRO_EEPROM_LENGTH2_ADDR, length2);
+    eeprom_update_word(DYNAMIC_MACRO_EEPROM_SIZE_ADDR, DYNAMIC_MACRO_BUFFER_SIZE);
+    eeprom_update_byte(DYNAMIC_MACRO_EEPROM_MAGIC_ADDR, DYNAMIC_MACRO_EEPROM_MAGIC);
+}
+#endif
+
 /**
  * Start recording of the dynamic macro.
  *
  * @param[out] macro_pointer The new macro buffer iterator.
  * @param[in]  macro_buffer  The macro buffer used to initialize macro_pointer.
  */
-void dynamic_macro_record_start(keyrecord_t **macro_pointer, keyrecord_t *macro_buffer) {
+void dynamic_macro_record_start(uint8_t **macro_pointer, uint8_t *macro_buffer) {
     dprintln("dynamic macro recording: started");
 
     dynamic_macro_record_start_user();
@@ -60,6 +306,87 @@ void dynamic_macro_record_start(keyrecord_t **macro_pointer, keyrecord_t *macro_
     *macro_pointer = macro_buffer;
 }
 
+/**
+ * Reset both macros, and restore them from EEPROM with
+ * DYNAMIC_MACRO_PERSISTENT.
+ */
+void dynamic_macro_init(void) {
+    macro_end   = macro_buffer;
+    r_macro_end = r_macro_buffer;
+#ifdef DYNAMIC_MACRO_PERSISTENT
+    dynamic_macro_load();
+#endif
+}
+
+#ifdef DYNAMIC_MACRO_TIMING
+/**
+ * Play back an event, keeping track of the keys and layers the macro
+ * changes so that only those are put back when the playback ends.
+ */
+static void dynamic_macro_play_record(keyrecord_t *record) {
+    uint8_t       row    = record->event.key.row;
+    uint8_t       col    = record->event.key.col;
+    layer_state_t before = layer_state;
+
+    if (row < MATRIX_ROWS && col < MATRIX_COLS) {
+        if (record->event.pressed) {
+            macro_playback.held_keys[row] |= (matrix_row_t)1 << col;
+        } else {
+            macro_playback.held_keys[row] &= ~((matrix_row_t)1 << col);
+        }
+    }
+    process_record(record);
+
+    macro_playback.changed_layers |= before ^ layer_state;
+}
+
+/**
+ * Release the keys the macro left pressed and restore the layers it
+ * changed. Keys and layers changed meanwhile by the user are kept.
+ */
+static void dynamic_macro_play_end(void) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (macro_playback.held_keys[row] & ((matrix_row_t)1 << col)) {
+                keyrecord_t record = {.event = {.key = {.row = row, .col = col}, .pressed = false, .time = timer_read() | 1}};
+                process_record(&record);
+            }
+        }
+    }
+
+    layer_state = (layer_state & ~macro_playback.changed_layers) | (macro_playback.saved_layer_state & macro_playback.changed_layers);
+}
+
+/**
+ * Play back the events of the current macro that are due, and return the
+ * time until the next one.
+ */
+static uint32_t dynamic_macro_play_task(uint32_t trigger_time, void *cb_arg) {
+    int8_t direction = macro_playback.direction;
+
+    while (macro_playback.pointer != macro_playback.end) {
+        if (!macro_playback.delayed) {
+            uint16_t delay = dynamic_macro_decode_delay(&macro_playback.pointer, direction);
+            if (delay > 0) {
+                macro_playback.delayed = true;
+                return delay;
+            }
+        }
+        macro_playback.delayed = false;
+
+        keyrecord_t record;
+        dynamic_macro_decode_key(&macro_playback.pointer, direction, &record);
+        dynamic_macro_play_record(&record);
+    }
+
+    dynamic_macro_play_end();
+
+    macro_playback_token = INVALID_DEFERRED_TOKEN;
+    dynamic_macro_play_user(direction);
+    return 0;
+}
+#endif
+
 /**
  * Play the dynamic macro.
  *
@@ -67,7 +394,7 @@ void dynamic_macro_record_start(keyrecord_t **macro_pointer, keyrecord_t *macro_
  * @param macro_end[in]    The element after the last macro buffer element.
  * @param direction[in]    Either +1 or -1, which way to iterate the buffer.
  */
-void dynamic_macro_play(keyrecord_t *macro_buffer, keyrecord_t *macro_end, int8_t direction) {
+void dynamic_macro_play(uint8_t *macro_buffer, uint8_t *macro_end, int8_t direction) {
     dprintf("dynamic macro: slot %d playback\n", DYNAMIC_MACRO_CURRENT_SLOT());
 
     layer_state_t saved_layer_state = layer_state;
@@ -75,9 +402,28 @@ void dynamic_macro_play(keyrecord_t *macro_buffer, keyrecord_t *macro_end, int8_
     clear_keyboard();
     layer_clear();
 
+#ifdef DYNAMIC_MACRO_TIMING
+    /* The events are replayed with their recorded timing from the
+     * deferred executor, so the keyboard keeps scanning meanwhile. */
+    macro_playback.pointer           = macro_buffer;
+    macro_playback.end               = macro_end;
+    macro_playback.direction         = direction;
+    macro_playback.delayed           = false;
+    macro_playback.saved_layer_state = saved_layer_state;
+    /* Including the layers cleared above */
+    macro_playback.changed_layers = saved_layer_state;
+    memset(macro_playback.held_keys, 0, sizeof(macro_playback.held_keys));
+
+    macro_playback_token = defer_exec(1, dynamic_macro_play_task, NULL);
+    if (macro_playback_token == INVALID_DEFERRED_TOKEN) {
+        dprintln("dynamic macro: no deferred executor available");
+        layer_state = saved_layer_state;
+    }
+#else
     while (macro_buffer != macro_end) {
-        process_record(macro_buffer);
-        macro_buffer += direction;
+        keyrecord_t record;
+        dynamic_macro_decode(&macro_buffer, direction, &record);
+        process_record(&record);
     }
 
     clear_keyboard();
@@ -85,6 +431,7 @@ void dynamic_macro_play(keyrecord_t *macro_buffer, keyrecord_t *macro_end, int8_
     layer_state = saved_layer_state;
 
     dynamic_macro_play_user(direction);
+#endif
 }
 
 /**
@@ -96,19 +443,32 @@ void dynamic_macro_play(keyrecord_t *macro_buffer, keyrecord_t *macro_end, int8_
  * @param direction[in]  Either +1 or -1, which way to iterate the buffer.
  * @param record[in]     The current keypress.
  */
-void dynamic_macro_record_key(keyrecord_t *macro_buffer, keyrecord_t **macro_pointer, keyrecord_t *macro2_end, int8_t direction, keyrecord_t *record) {
+void dynamic_macro_record_key(uint8_t *macro_buffer, uint8_t **macro_pointer, uint8_t *macro2_end, int8_t direction, keyrecord_t *record) {
     /* If we've just started recording, ignore all the key releases. */
     if (!record->event.pressed && *macro_pointer == macro_buffer) {
         dprintln("dynamic macro: ignoring a leading key-up event");
         return;
     }
 
+    uint16_t delay = 0;
+#ifdef DYNAMIC_MACRO_TIMING
+    if (*macro_pointer != macro_buffer) {
+        delay = TIMER_DIFF_16(record->event.time, macro_last_time);
+    }
+    macro_last_time = record->event.time;
+#endif
+
+    uint8_t encoded[DYNAMIC_MACRO_MAX_EVENT_SIZE];
+    uint8_t length = dynamic_macro_encode(record, delay, encoded);
+
     /* The other end of the other macro is the last buffer element it
      * is safe to use before overwriting the other macro.
      */
-    if (*macro_pointer - direction != macro2_end) {
-        **macro_pointer = *record;
-        *macro_pointer += direction;
+    if (direction * (macro2_end - *macro_pointer) + 1 >= length) {
+        for (uint8_t i = 0; i < length; i++) {
+            **macro_pointer = encoded[i];
+            *macro_pointer += direction;
+        }
     } else {
         dynamic_macro_record_key_user(direction, record);
     }
@@ -120,20 +480,34 @@ void dynamic_macro_record_key(keyrecord_t *macro_buffer, keyrecord_t **macro_poi
  * End recording of the dynamic macro. Essentially just update the
  * pointer to the end of the macro.
  */
-void dynamic_macro_record_end(keyrecord_t *macro_buffer, keyrecord_t *macro_pointer, int8_t direction, keyrecord_t **macro_end) {
+void dynamic_macro_record_end(uint8_t *macro_buffer, uint8_t *macro_pointer, int8_t direction, uint8_t **macro_end) {
     dynamic_macro_record_end_user(direction);
 
     /* Do not save the keys being held when stopping the recording,
      * i.e. the keys used to access the layer DYN_REC_STOP is on.
+     * Events have different sizes, so the macro is walked from the
+     * start to find the end of the last key-up event.
      */
-    while (macro_pointer != macro_buffer && (macro_pointer - direction)->event.pressed) {
-        dprintln("dynamic macro: trimming a trailing key-down event");
-        macro_pointer -= direction;
+    uint8_t *end     = macro_buffer;
+    uint8_t *pointer = macro_buffer;
+    while (pointer != macro_pointer) {
+        keyrecord_t record;
+        dynamic_macro_decode(&pointer, direction, &record);
+        if (!record.event.pressed) {
+            end = pointer;
+        }
     }
+    if (end != macro_pointer) {
+        dprintln("dynamic macro: trimming trailing key-down events");
+    }
+
+    dprintf("dynamic macro: slot %d saved, length: %d\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, end));
 
-    dprintf("dynamic macro: slot %d saved, length: %d\n", DYNAMIC_MACRO_CURRENT_SLOT(), DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, macro_pointer));
+    *macro_end = end;
 
-    *macro_end = macro_pointer;
+#ifdef DYNAMIC_MACRO_PERSISTENT
+    dynamic_macro_save(direction);
+#endif
 }
 
 /* Handle the key events related to the dynamic macros. Should be
@@ -147,52 +521,31 @@ void dynamic_macro_record_end(keyrecord_t *macro_buffer, keyrecord_t *macro_poin
  *   }
  */
 bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record) {
-    /* Both macros use the same buffer but read/write on different
-     * ends of it.
-     *
-     * Macro1 is written left-to-right starting from the beginning of
-     * the buffer.
-     *
-     * Macro2 is written right-to-left starting from the end of the
-     * buffer.
-     *
-     * &macro_buffer   macro_end
-     *  v                   v
-     * +------------------------------------------------------------+
-     * |>>>>>> MACRO1 >>>>>>      <<<<<<<<<<<<< MACRO2 <<<<<<<<<<<<<|
-     * +------------------------------------------------------------+
-     *                           ^                                 ^
-     *                         r_macro_end                  r_macro_buffer
-     *
-     * During the recording when one macro encounters the end of the
-     * other macro, the recording is stopped. Apart from this, there
-     * are no arbitrary limits for the macros' length in relation to
-     * each other: for example one can either have two medium sized
-     * macros or one long macro and one short macro. Or even one empty
-     * and one using the whole buffer.
-     */
-    static keyrecord_t macro_buffer[DYNAMIC_MACRO_SIZE];
-
-    /* Pointer to the first buffer element after the first macro.
-     * Initially points to the very beginning of the buffer since the
-     * macro is empty. */
-    static keyrecord_t *macro_end = macro_buffer;
-
-    /* The other end of the macro buffer. Serves as the beginning of
-     * the second macro. */
-    static keyrecord_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_SIZE - 1;
-
-    /* Like macro_end but for the second macro. */
-    static keyrecord_t *r_macro_end = r_macro_buffer;
-
     /* A persistent pointer to the current macro position (iterator)
      * used during the recording. */
-    static keyrecord_t *macro_pointer = NULL;
+    static uint8_t *macro_pointer = NULL;
 
     /* 0   - no macro is being recorded right now
      * 1,2 - either macro 1 or 2 is being recorded */
     static uint8_t macro_id = 0;
 
+#ifdef DYNAMIC_MACRO_TIMING
+    /* The macro being played back must not change underneath it, and
+     * playback does not nest when it is spread over time. */
+    if (macro_playback_token != INVALID_DEFERRED_TOKEN) {
+        switch (keycode) {
+            case DYN_REC_START1:
+            case DYN_REC_START2:
+            case DYN_MACRO_PLAY1:
+            case DYN_MACRO_PLAY2:
+                if (macro_id == 0) {
+                    dprintln("dynamic macro: ignoring macro key during playback");
+                    return false;
+                }
+        }
+    }
+#endif
+
     if (macro_id == 0) {
         /* No macro recording in progress. */
         if (!record->event.pressed) {
@@ -20,8 +20,10 @@
 
 #include "quantum.h"
 
-/* May be overridden with a custom value. Be aware that the effective
- * macro length is half of this value: each keypress is recorded twice
+/* May be overridden with a custom value. The buffer takes as much
+ * memory as this many keyrecord_t structs, but most events are stored
+ * in one byte (two with DYNAMIC_MACRO_TIMING), so it holds several
+ * times as many events. Be aware that each keypress is recorded twice
  * because of the down-event and up-event. This is not a bug, it's the
  * intended behavior.
  *
@@ -33,6 +35,7 @@
 #    define DYNAMIC_MACRO_SIZE 128
 #endif
 
+void dynamic_macro_init(void);
 void dynamic_macro_led_blink(void);
 bool process_dynamic_macro(uint16_t keycode, keyrecord_t *record);
 void dynamic_macro_record_start_user(void);
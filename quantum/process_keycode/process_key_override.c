@@ -26,6 +26,18 @@
 #    define KEY_OVERRIDE_REPEAT_DELAY 500
 #endif
 
+#ifndef KEY_OVERRIDE_INDEX_SIZE
+#    if defined(__AVR__)
+#        define KEY_OVERRIDE_INDEX_SIZE 32
+#    else
+#        define KEY_OVERRIDE_INDEX_SIZE 128
+#    endif
+#endif
+
+#if KEY_OVERRIDE_INDEX_SIZE > 255
+#    error "KEY_OVERRIDE_INDEX_SIZE must not exceed 255"
+#endif
+
 // For benchmarking the time it takes to call process_key_override on every key press (needs keyboard debugging enabled as well)
 // #define BENCH_KEY_OVERRIDE
 
@@ -81,6 +93,14 @@ static uint16_t deferred_register = 0;
 // TODO: in future maybe save in EEPROM?
 static bool enabled = true;
 
+// Positions in `key_overrides`, sorted by trigger keycode. Overrides with the same trigger keep their array order, and mod-only (KC_NO) overrides come first.
+static uint8_t                index_order[KEY_OVERRIDE_INDEX_SIZE];
+static uint8_t                index_count          = 0;
+static bool                   index_valid          = false;
+static const key_override_t **indexed_overrides    = NULL;
+static uint8_t                all_trigger_mods     = 0;
+static bool                   has_modless_override = false;
+
 // Public variables
 __attribute__((weak)) const key_override_t **key_overrides = NULL;
 
@@ -241,143 +261,242 @@ static bool check_activation_event(const key_override_t *override, const bool ke
     }
 }
 
-/** Iterates through the list of key overrides and tries activating each, until it finds one that activates or reaches the end of overrides. Returns true if the key action for `keycode` should be sent */
-static bool try_activating_override(const uint16_t keycode, const uint8_t layer, const bool key_down, const bool is_mod, const uint8_t active_mods, bool *activated) {
-    if (key_overrides == NULL) {
-        return true;
+/** Checks all requirements for activating the provided override on this key event. */
+static bool override_should_activate(const key_override_t *override, const uint16_t keycode, const uint8_t layer, const bool key_down, const bool is_mod, const uint8_t active_mods) {
+    // Fast, but not full mods check. Most key presses will not have any mods down, and most overrides will require mods. Hence here we filter overrides that require mods to be down while no mods are down
+    if (active_mods == 0 && override->trigger_mods != 0) {
+        key_override_printf("Not activating override: Modifiers don't match\n");
+        return false;
     }
 
-    for (uint8_t i = 0;; i++) {
-        const key_override_t *const override = key_overrides[i];
+    // Check layer
+    if ((override->layers & (1 << layer)) == 0) {
+        key_override_printf("Not activating override: Not set to activate on pressed layer\n");
+        return false;
+    }
 
-        // End of array
-        if (override == NULL) {
-            break;
-        }
+    // Check allowed activation events
+    if (!check_activation_event(override, key_down, is_mod)) {
+        key_override_printf("Not activating override: Activation event not allowed\n");
+        return false;
+    }
 
-        // Fast, but not full mods check. Most key presses will not have any mods down, and most overrides will require mods. Hence here we filter overrides that require mods to be down while no mods are down
-        if (active_mods == 0 && override->trigger_mods != 0) {
-            key_override_printf("Not activating override: Modifiers don't match\n");
-            continue;
-        }
+    const bool is_trigger = override->trigger == keycode;
 
-        // Check layer
-        if ((override->layers & (1 << layer)) == 0) {
-            key_override_printf("Not activating override: Not set to activate on pressed layer\n");
-            continue;
-        }
+    // Check if trigger lifted. This is a small optimization in order to skip the remaining checks
+    if (is_trigger && !key_down) {
+        key_override_printf("Not activating override: Trigger lifted\n");
+        return false;
+    }
 
-        // Check allowed activation events
-        if (!check_activation_event(override, key_down, is_mod)) {
-            key_override_printf("Not activating override: Activation event not allowed\n");
-            continue;
-        }
+    // If the trigger is KC_NO it means 'no key', so only the required modifiers need to be down.
+    const bool no_trigger = override->trigger == KC_NO;
 
-        const bool is_trigger = override->trigger == keycode;
+    // Check if aleady active
+    if (override == active_override) {
+        key_override_printf("Not activating override: Alerady actived\n");
+        return false;
+    }
 
-        // Check if trigger lifted. This is a small optimization in order to skip the remaining checks
-        if (is_trigger && !key_down) {
-            key_override_printf("Not activating override: Trigger lifted\n");
-            continue;
+    // Check if enabled
+    if (override->enabled != NULL && !((*(override->enabled) & 1))) {
+        key_override_printf("Not activating override: Not enabled\n");
+        return false;
+    }
+
+    // Check mods precisely
+    if (!key_override_matches_active_modifiers(override, active_mods)) {
+        key_override_printf("Not activating override: Modifiers don't match\n");
+        return false;
+    }
+
+    // At this point, all requirements for activation are checked, except whether the trigger key is pressed. Now we check if the required trigger is down
+    // If no trigger key is required, yes.
+    // If the trigger was just pressed, yes.
+    // If the last non-mod key that was pressed down is the trigger key, yes.
+    if (!(no_trigger || (is_trigger && key_down) || last_key_down == override->trigger)) {
+        key_override_printf("Not activating override. Trigger not down\n");
+        return false;
+    }
+
+    return true;
+}
+
+/** Activates the provided override. Returns true if the key action for `keycode` should be sent */
+static bool activate_override(const key_override_t *override, const uint16_t keycode, const bool key_down, const bool is_mod) {
+    const bool trigger_down = override->trigger == keycode && key_down;
+    const bool no_trigger   = override->trigger == KC_NO;
+
+    key_override_printf("Activating override\n");
+
+    clear_active_override(false);
+
+    active_override                 = override;
+    active_override_trigger_is_down = true;
+
+    set_suppressed_override_mods(override->suppressed_mods);
+
+    if (!trigger_down && !no_trigger) {
+        // When activating a key override the trigger is is always unregistered. In the case where the key that newly pressed is not the trigger key, we have to explicitly remove the trigger key from the keyboard report. If the trigger was just pressed down we simply suppress the event which also has the effect of the trigger key not being registered in the keyboard report.
+        if (IS_KEY(override->trigger)) {
+            del_key(override->trigger);
+        } else {
+            unregister_code(override->trigger);
         }
+    }
+
+    const uint16_t mod_free_replacement = clear_mods_from(override->replacement);
+
+    bool register_replacement = mod_free_replacement != KC_NO &&    // KC_NO is never registered
+                                mod_free_replacement < SAFE_RANGE;  // Custom keycodes are never registered
 
-        // If the trigger is KC_NO it means 'no key', so only the required modifiers need to be down.
-        const bool no_trigger = override->trigger == KC_NO;
+    // Try firing the custom handler
+    if (override->custom_action != NULL) {
+        register_replacement &= override->custom_action(true, override->context);
+    }
 
-        // Check if aleady active
-        if (override == active_override) {
-            key_override_printf("Not activating override: Alerady actived\n");
-            continue;
+    if (register_replacement) {
+        const uint8_t override_mods = extract_mod_bits(override->replacement);
+        set_weak_override_mods(override_mods);
+
+        // If this is a modifier event that activates the key override we _always_ defer the actual full activation of the override
+        if (is_mod) {
+            key_override_printf("Deferring register replacement key\n");
+            schedule_deferred_register(mod_free_replacement);
+            send_keyboard_report();
+        } else {
+            if (IS_KEY(mod_free_replacement)) {
+                add_key(mod_free_replacement);
+            } else {
+                key_override_printf("NOT KEY 2\n");
+                send_keyboard_report();
+                // On macOS there seems to be a race condition when it comes to the keyboard report and consumer keycodes. It seems the OS may recognize a consumer keycode before an updated keyboard report, even if the keyboard report is actually sent before the consumer key. I assume it is some sort of race condition because it happens infrequently and very irregularly. Waiting for about at least 10ms between sending the keyboard report and sending the consumer code has shown to fix this.
+                wait_ms(10);
+                register_code(mod_free_replacement);
+            }
         }
+    } else {
+        // If not registering the replacement key send keyboard report to update the unregistered keys.
+        send_keyboard_report();
+    }
 
-        // Check if enabled
-        if (override->enabled != NULL && !((*(override->enabled) & 1))) {
-            key_override_printf("Not activating override: Not enabled\n");
-            continue;
+    // If the trigger is down, suppress the event so that it does not get added to the keyboard report.
+    return !trigger_down;
+}
+
+/** Builds the trigger index for the current `key_overrides` array, if it fits. */
+static void build_override_index(void) {
+    indexed_overrides    = key_overrides;
+    index_count          = 0;
+    index_valid          = false;
+    all_trigger_mods     = 0;
+    has_modless_override = false;
+
+    for (uint16_t i = 0; key_overrides[i] != NULL; i++) {
+        if (i >= KEY_OVERRIDE_INDEX_SIZE) {
+            dprintf("key_override: more than KEY_OVERRIDE_INDEX_SIZE (%u) overrides, checking all of them on every key event\n", KEY_OVERRIDE_INDEX_SIZE);
+            return;
         }
 
-        // Check mods precisely
-        if (!key_override_matches_active_modifiers(override, active_mods)) {
-            key_override_printf("Not activating override: Modifiers don't match\n");
-            continue;
+        const key_override_t *const override = key_overrides[i];
+
+        all_trigger_mods |= override->trigger_mods;
+        has_modless_override |= override->trigger_mods == 0;
+
+        // Insertion sort by trigger, keeping overrides with the same trigger in array order
+        uint8_t j = index_count++;
+        for (; j > 0 && key_overrides[index_order[j - 1]]->trigger > override->trigger; j--) {
+            index_order[j] = index_order[j - 1];
         }
+        index_order[j] = i;
+    }
 
-        // Check if trigger key is down.
-        const bool trigger_down = is_trigger && key_down;
+    index_valid = true;
+}
+
+/** Returns the position of the first indexed override with a trigger not less than `trigger`. */
+static uint8_t find_trigger(const uint16_t trigger) {
+    uint8_t low = 0, high = index_count;
 
-        // At this point, all requirements for activation are checked, except whether the trigger key is pressed. Now we check if the required trigger is down
-        // If no trigger key is required, yes.
-        // If the trigger was just pressed, yes.
-        // If the last non-mod key that was pressed down is the trigger key, yes.
-        bool should_activate = no_trigger || trigger_down || last_key_down == override->trigger;
+    while (low < high) {
+        const uint8_t mid = (low + high) / 2;
 
-        if (!should_activate) {
-            key_override_printf("Not activating override. Trigger not down\n");
-            continue;
+        if (key_overrides[index_order[mid]]->trigger < trigger) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
+    }
+
+    return low;
+}
 
-        key_override_printf("Activating override\n");
+/** Iterates through the overrides that could activate on this event in array order, and activates the first one whose requirements are met. Returns true if the key action for `keycode` should be sent */
+static bool try_activating_override(const uint16_t keycode, const uint8_t layer, const bool key_down, const bool is_mod, const uint8_t active_mods, bool *activated) {
+    *activated = false;
 
-        clear_active_override(false);
+    if (key_overrides == NULL) {
+        return true;
+    }
 
-        active_override                 = override;
-        active_override_trigger_is_down = true;
+    if (indexed_overrides != key_overrides) {
+        build_override_index();
+    }
 
-        set_suppressed_override_mods(override->suppressed_mods);
+    if (!index_valid) {
+        for (uint8_t i = 0; key_overrides[i] != NULL; i++) {
+            const key_override_t *const override = key_overrides[i];
 
-        if (!trigger_down && !no_trigger) {
-            // When activating a key override the trigger is is always unregistered. In the case where the key that newly pressed is not the trigger key, we have to explicitly remove the trigger key from the keyboard report. If the trigger was just pressed down we simply suppress the event which also has the effect of the trigger key not being registered in the keyboard report.
-            if (IS_KEY(override->trigger)) {
-                del_key(override->trigger);
-            } else {
-                unregister_code(override->trigger);
+            if (override_should_activate(override, keycode, layer, key_down, is_mod, active_mods)) {
+                *activated = true;
+                return activate_override(override, keycode, key_down, is_mod);
             }
         }
 
-        const uint16_t mod_free_replacement = clear_mods_from(override->replacement);
+        return true;
+    }
+
+    // Every override that requires mods needs at least one of them to be down
+    if (!has_modless_override && (active_mods & all_trigger_mods) == 0) {
+        return true;
+    }
 
-        bool register_replacement = mod_free_replacement != KC_NO &&    // KC_NO is never registered
-                                    mod_free_replacement < SAFE_RANGE;  // Custom keycodes are never registered
+    // Only overrides without a trigger, triggered by this key, or triggered by the last key pressed down can activate. Walk their index ranges merged back into array order, as the first matching override wins.
+    const uint16_t triggers[] = {KC_NO, keycode, last_key_down};
+    uint8_t        next[3], end[3];
 
-        // Try firing the custom handler
-        if (override->custom_action != NULL) {
-            register_replacement &= override->custom_action(true, override->context);
+    for (uint8_t t = 0; t < 3; t++) {
+        bool duplicate = false;
+        for (uint8_t u = 0; u < t; u++) {
+            duplicate |= triggers[u] == triggers[t];
         }
 
-        if (register_replacement) {
-            const uint8_t override_mods = extract_mod_bits(override->replacement);
-            set_weak_override_mods(override_mods);
+        next[t] = find_trigger(triggers[t]);
+        end[t]  = next[t];
+        while (!duplicate && end[t] < index_count && key_overrides[index_order[end[t]]]->trigger == triggers[t]) {
+            end[t]++;
+        }
+    }
 
-            // If this is a modifier event that activates the key override we _always_ defer the actual full activation of the override
-            if (is_mod) {
-                key_override_printf("Deferring register replacement key\n");
-                schedule_deferred_register(mod_free_replacement);
-                send_keyboard_report();
-            } else {
-                if (IS_KEY(mod_free_replacement)) {
-                    add_key(mod_free_replacement);
-                } else {
-                    key_override_printf("NOT KEY 2\n");
-                    send_keyboard_report();
-                    // On macOS there seems to be a race condition when it comes to the keyboard report and consumer keycodes. It seems the OS may recognize a consumer keycode before an updated keyboard report, even if the keyboard report is actually sent before the consumer key. I assume it is some sort of race condition because it happens infrequently and very irregularly. Waiting for about at least 10ms between sending the keyboard report and sending the consumer code has shown to fix this.
-                    wait_ms(10);
-                    register_code(mod_free_replacement);
-                }
+    while (true) {
+        uint8_t t = 3;
+        for (uint8_t u = 0; u < 3; u++) {
+            if (next[u] < end[u] && (t == 3 || index_order[next[u]] < index_order[next[t]])) {
+                t = u;
             }
-        } else {
-            // If not registering the replacement key send keyboard report to update the unregistered keys.
-            send_keyboard_report();
         }
 
-        *activated = true;
-
-        // If the trigger is down, suppress the event so that it does not get added to the keyboard report.
-        return !trigger_down;
-    }
+        if (t == 3) {
+            return true;
+        }
 
-    *activated = false;
+        const key_override_t *const override = key_overrides[index_order[next[t]++]];
 
-    return true;
+        if (override_should_activate(override, keycode, layer, key_down, is_mod, active_mods)) {
+            *activated = true;
+            return activate_override(override, keycode, key_down, is_mod);
+        }
+    }
 }
 
 void key_override_task(void) {
@@ -27,12 +27,107 @@ __attribute__((weak)) void leader_start(void) {}
 
 __attribute__((weak)) void leader_end(void) {}
 
+__attribute__((weak)) const leader_sequence_t leader_sequences[] = {LEADER_SEQUENCES_END};
+
 // Leader key stuff
 bool     leading     = false;
 uint16_t leader_time = 0;
 
-uint16_t leader_sequence[5]   = {0, 0, 0, 0, 0};
-uint8_t  leader_sequence_size = 0;
+uint16_t leader_sequence[LEADER_SEQUENCE_SIZE] = {0};
+uint8_t  leader_sequence_size                  = 0;
+
+/* The sequence table is sorted once into leader_order, which makes it an
+ * implicit trie: the sequences starting with the keys typed so far are
+ * always the contiguous range [leader_match_begin, leader_match_end), and
+ * each key narrows the range with a binary search. */
+static uint8_t leader_order[LEADER_TABLE_SIZE];
+static uint8_t leader_order_size = 0;
+static bool    leader_order_built = false;
+static uint8_t leader_match_begin = 0;
+static uint8_t leader_match_end   = 0;
+
+static inline uint16_t leader_sequence_key(uint8_t index, uint8_t depth) { return pgm_read_word(&leader_sequences[leader_order[index]].keys[depth]); }
+
+/* Lexicographic order, a sequence sorts before the sequences it is a prefix of. */
+static bool leader_sequence_less(uint8_t a, uint8_t b) {
+    const uint16_t *keys_a = leader_sequences[a].keys;
+    const uint16_t *keys_b = leader_sequences[b].keys;
+    for (uint8_t i = 0;; i++) {
+        uint16_t key_a = pgm_read_word(&keys_a[i]);
+        uint16_t key_b = pgm_read_word(&keys_b[i]);
+        if (key_a != key_b) {
+            return key_a < key_b;
+        }
+        if (key_a == LEADER_END) {
+            return false;
+        }
+    }
+}
+
+static void leader_build_order(void) {
+    for (uint8_t i = 0; leader_sequences[i].keys != NULL; i++) {
+        if (leader_order_size == LEADER_TABLE_SIZE) {
+            dprintf("leader: more than %d sequences, increase LEADER_TABLE_SIZE\n", LEADER_TABLE_SIZE);
+            break;
+        }
+        uint8_t j = leader_order_size++;
+        while (j > 0 && leader_sequence_less(i, leader_order[j - 1])) {
+            leader_order[j] = leader_order[j - 1];
+            j--;
+        }
+        leader_order[j] = i;
+    }
+    leader_order_built = true;
+}
+
+/* First index in the current range whose key at depth is not below keycode. */
+static uint8_t leader_lower_bound(uint8_t depth, uint16_t keycode) {
+    uint8_t begin = leader_match_begin;
+    uint8_t end   = leader_match_end;
+    while (begin < end) {
+        uint8_t middle = begin + (end - begin) / 2;
+        if (leader_sequence_key(middle, depth) < keycode) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return begin;
+}
+
+/* Returns the sequence matching exactly the keys typed so far, if any. */
+static const leader_sequence_t *leader_exact_match(void) {
+    if (leader_match_begin < leader_match_end && leader_sequence_key(leader_match_begin, leader_sequence_size) == LEADER_END) {
+        return &leader_sequences[leader_order[leader_match_begin]];
+    }
+    return NULL;
+}
+
+static void leader_fire(const leader_sequence_t *sequence) {
+    leading = false;
+    leader_end();
+    if (sequence->action) {
+        sequence->action();
+    }
+}
+
+/* Narrow the candidates to the sequences continuing with keycode, and fire
+ * the match right away if no longer sequence could follow. */
+static void leader_match_key(uint16_t keycode) {
+    uint8_t depth = leader_sequence_size - 1;
+
+    leader_match_begin = leader_lower_bound(depth, keycode);
+    if (keycode == UINT16_MAX) {
+        leader_match_end = leader_match_begin;
+    } else {
+        leader_match_end = leader_lower_bound(depth, keycode + 1);
+    }
+
+    const leader_sequence_t *match = leader_exact_match();
+    if (match && leader_match_end - leader_match_begin == 1) {
+        leader_fire(match);
+    }
+}
 
 void qk_leader_start(void) {
     if (leading) {
@@ -43,6 +138,34 @@ void qk_leader_start(void) {
     leader_time          = timer_read();
     leader_sequence_size = 0;
     memset(leader_sequence, 0, sizeof(leader_sequence));
+
+    if (!leader_order_built) {
+        leader_build_order();
+    }
+    leader_match_begin = 0;
+    leader_match_end   = leader_order_size;
+}
+
+/* Runs before matrix_scan_user(), so that a LEADER_DICTIONARY() there only
+ * sees the sequences that are not in the table. */
+void leader_match_task(void) {
+    LEADER_DICTIONARY() {
+        const leader_sequence_t *match = leader_exact_match();
+        if (match) {
+            leader_fire(match);
+        }
+    }
+}
+
+void leader_task(void) {
+    /* Without a sequence table, the keymap's LEADER_DICTIONARY() ends the sequence */
+    if (leader_order_size == 0) {
+        return;
+    }
+    LEADER_DICTIONARY() {
+        leading = false;
+        leader_end();
+    }
 }
 
 bool process_leader(uint16_t keycode, keyrecord_t *record) {
@@ -61,6 +184,7 @@ bool process_leader(uint16_t keycode, keyrecord_t *record) {
                 if (leader_sequence_size < (sizeof(leader_sequence) / sizeof(leader_sequence[0]))) {
                     leader_sequence[leader_sequence_size] = keycode;
                     leader_sequence_size++;
+                    leader_match_key(keycode);
                 } else {
                     leading = false;
                     leader_end();
@@ -18,22 +18,48 @@
 
 #include "quantum.h"
 
+#ifndef LEADER_SEQUENCE_SIZE
+#    define LEADER_SEQUENCE_SIZE 5
+#endif
+
+/* Sequences in leader_sequences are sorted into this many slots, further sequences are ignored. */
+#ifndef LEADER_TABLE_SIZE
+#    define LEADER_TABLE_SIZE 32
+#endif
+
+#define LEADER_END KC_NO
+
+typedef struct {
+    const uint16_t *keys;
+    void (*action)(void);
+} leader_sequence_t;
+
+#define LEADER_SEQUENCE(keys, action) \
+    { keys, action }
+#define LEADER_SEQUENCES_END \
+    { NULL, NULL }
+
+/* Keyboards may define this table; every sequence is terminated by LEADER_END and the table by LEADER_SEQUENCES_END. */
+extern const leader_sequence_t leader_sequences[];
+
 bool process_leader(uint16_t keycode, keyrecord_t *record);
+void leader_match_task(void);
+void leader_task(void);
 
 void leader_start(void);
 void leader_end(void);
 void qk_leader_start(void);
 
-#define SEQ_ONE_KEY(key) if (leader_sequence[0] == (key) && leader_sequence[1] == 0 && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
-#define SEQ_TWO_KEYS(key1, key2) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
-#define SEQ_THREE_KEYS(key1, key2, key3) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == 0 && leader_sequence[4] == 0)
-#define SEQ_FOUR_KEYS(key1, key2, key3, key4) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4) && leader_sequence[4] == 0)
-#define SEQ_FIVE_KEYS(key1, key2, key3, key4, key5) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4) && leader_sequence[4] == (key5))
+#define SEQ_ONE_KEY(key) if (leader_sequence_size == 1 && leader_sequence[0] == (key))
+#define SEQ_TWO_KEYS(key1, key2) if (leader_sequence_size == 2 && leader_sequence[0] == (key1) && leader_sequence[1] == (key2))
+#define SEQ_THREE_KEYS(key1, key2, key3) if (leader_sequence_size == 3 && leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3))
+#define SEQ_FOUR_KEYS(key1, key2, key3, key4) if (leader_sequence_size == 4 && leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4))
+#define SEQ_FIVE_KEYS(key1, key2, key3, key4, key5) if (leader_sequence_size == 5 && leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4) && leader_sequence[4] == (key5))
 
-#define LEADER_EXTERNS()                \
-    extern bool     leading;            \
-    extern uint16_t leader_time;        \
-    extern uint16_t leader_sequence[5]; \
+#define LEADER_EXTERNS()                                   \
+    extern bool     leading;                               \
+    extern uint16_t leader_time;                           \
+    extern uint16_t leader_sequence[LEADER_SEQUENCE_SIZE]; \
     extern uint8_t  leader_sequence_size
 
 #ifdef LEADER_NO_TIMEOUT
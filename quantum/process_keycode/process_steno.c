@@ -58,6 +58,14 @@
 #define GEMINI_STATE_SIZE 6
 #define MAX_STATE_SIZE GEMINI_STATE_SIZE
 
+#ifndef STENO_BUFFER_SIZE
+#    define STENO_BUFFER_SIZE 64
+#endif
+
+#if STENO_BUFFER_SIZE <= MAX_STATE_SIZE || STENO_BUFFER_SIZE > 255
+#    error "STENO_BUFFER_SIZE must be larger than a packet and at most 255"
+#endif
+
 static uint8_t      state[MAX_STATE_SIZE] = {0};
 static uint8_t      chord[MAX_STATE_SIZE] = {0};
 static int8_t       pressed               = 0;
@@ -76,14 +84,60 @@ static void steno_clear_state(void) {
     memset(chord, 0, sizeof(chord));
 }
 
-static void send_steno_state(uint8_t size, bool send_empty) {
+#ifdef VIRTSER_ENABLE
+/* Chords are queued here and drained by steno_task(), so a burst of strokes
+ * is sent as a few large transfers instead of blocking the scan loop on the
+ * serial endpoint for every byte. */
+static uint8_t steno_buffer[STENO_BUFFER_SIZE];
+static uint8_t steno_buffer_head = 0;
+static uint8_t steno_buffer_tail = 0;
+
+static uint8_t steno_buffer_used(void) { return (uint8_t)(steno_buffer_head + STENO_BUFFER_SIZE - steno_buffer_tail) % STENO_BUFFER_SIZE; }
+
+static void steno_buffer_write(const uint8_t *packet, uint8_t size) {
+    /* One slot is kept free to tell a full buffer from an empty one. If the
+     * host is not reading, the stroke is dropped as a whole, so the host never
+     * sees part of a packet and the scan loop never waits for it. */
+    if (steno_buffer_used() + size >= STENO_BUFFER_SIZE) {
+        dprintf("steno: output buffer full, stroke dropped\n");
+        return;
+    }
     for (uint8_t i = 0; i < size; ++i) {
-        if (chord[i] || send_empty) {
+        steno_buffer[steno_buffer_head] = packet[i];
+        steno_buffer_head               = (steno_buffer_head + 1) % STENO_BUFFER_SIZE;
+    }
+}
+#endif
+
+void steno_task(void) {
 #ifdef VIRTSER_ENABLE
-            virtser_send(chord[i]);
+    while (steno_buffer_tail != steno_buffer_head) {
+        // Send the contiguous part of the queue, this may be less than all of it if the endpoint is busy
+        uint8_t end     = steno_buffer_head > steno_buffer_tail ? steno_buffer_head : STENO_BUFFER_SIZE;
+        uint8_t written = virtser_write(&steno_buffer[steno_buffer_tail], end - steno_buffer_tail);
+        if (written == 0) {
+            return;
+        }
+        steno_buffer_tail = (steno_buffer_tail + written) % STENO_BUFFER_SIZE;
+    }
 #endif
+}
+
+static void send_steno_state(uint8_t size, bool send_empty) {
+    uint8_t packet[MAX_STATE_SIZE + 1];
+    uint8_t length = 0;
+
+    for (uint8_t i = 0; i < size; ++i) {
+        if (chord[i] || send_empty) {
+            packet[length++] = chord[i];
         }
     }
+    if (mode == STENO_MODE_BOLT) {
+        packet[length++] = 0;  // TX Bolt packets end with a terminating byte
+    }
+#ifdef VIRTSER_ENABLE
+    steno_buffer_write(packet, length);
+#endif
 }
 
 void steno_init() {
@@ -113,9 +167,6 @@ static void send_steno_chord(void) {
         switch (mode) {
             case STENO_MODE_BOLT:
                 send_steno_state(BOLT_STATE_SIZE, false);
-#ifdef VIRTSER_ENABLE
-                virtser_send(0);  // terminating byte
-#endif
                 break;
             case STENO_MODE_GEMINI:
                 chord[0] |= 0x80;  // Indicate start of packet
@@ -20,7 +20,42 @@ uint8_t get_oneshot_mods(void);
 #endif
 
 static uint16_t last_td;
-static int16_t  highest_td = -1;
+
+// Bitmap of the dances with a non-zero count, so that only dances in progress are visited
+static uint8_t active_tds[(QK_TAP_DANCE_MAX - QK_TAP_DANCE + 1) / 8];
+static uint8_t active_td_count = 0;
+
+static inline bool is_td_active(uint8_t idx) { return active_tds[idx / 8] & (1 << (idx % 8)); }
+
+static void set_td_active(uint8_t idx, bool active) {
+    if (is_td_active(idx) == active) return;
+
+    active_tds[idx / 8] ^= 1 << (idx % 8);
+    if (active) {
+        active_td_count++;
+    } else {
+        active_td_count--;
+    }
+}
+
+/** Returns the index of the next dance in progress after `idx`, or -1 if there is none. Pass -1 to get the first one. */
+static int16_t next_active_td(int16_t idx) {
+    if (active_td_count == 0) return -1;
+
+    for (uint16_t i = idx + 1; i < sizeof(active_tds) * 8; i++) {
+        if (active_tds[i / 8] == 0) {
+            i |= 7;
+            continue;
+        }
+        if (is_td_active(i)) {
+            // The count may have been cleared by user code without going through reset_tap_dance()
+            if (tap_dance_actions[i].state.count) return i;
+            set_td_active(i, false);
+        }
+    }
+
+    return -1;
+}
 
 void qk_tap_dance_pair_on_each_tap(qk_tap_dance_state_t *state, void *user_data) {
     qk_tap_dance_pair_t *pair = (qk_tap_dance_pair_t *)user_data;
@@ -109,21 +144,17 @@ void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
 
     if (!record->event.pressed) return;
 
-    if (highest_td == -1) return;
-
-    for (int i = 0; i <= highest_td; i++) {
+    for (int16_t i = next_active_td(-1); i >= 0; i = next_active_td(i)) {
         action = &tap_dance_actions[i];
-        if (action->state.count) {
-            if (keycode == action->state.keycode && keycode == last_td) continue;
-            action->state.interrupted          = true;
-            action->state.interrupting_keycode = keycode;
-            process_tap_dance_action_on_dance_finished(action);
-            reset_tap_dance(&action->state);
-
-            // Tap dance actions can leave some weak mods active (e.g., if the tap dance is mapped to a keycode with
-            // modifiers), but these weak mods should not affect the keypress which interrupted the tap dance.
-            clear_weak_mods();
-        }
+        if (keycode == action->state.keycode && keycode == last_td) continue;
+        action->state.interrupted          = true;
+        action->state.interrupting_keycode = keycode;
+        process_tap_dance_action_on_dance_finished(action);
+        reset_tap_dance(&action->state);
+
+        // Tap dance actions can leave some weak mods active (e.g., if the tap dance is mapped to a keycode with
+        // modifiers), but these weak mods should not affect the keypress which interrupted the tap dance.
+        clear_weak_mods();
     }
 }
 
@@ -133,13 +164,13 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 
     switch (keycode) {
         case QK_TAP_DANCE ... QK_TAP_DANCE_MAX:
-            if ((int16_t)idx > highest_td) highest_td = idx;
             action = &tap_dance_actions[idx];
 
             action->state.pressed = record->event.pressed;
             if (record->event.pressed) {
                 action->state.keycode = keycode;
                 action->state.count++;
+                set_td_active(idx, true);
                 action->state.timer = timer_read();
 #ifndef NO_ACTION_ONESHOT
                 action->state.oneshot_mods = get_oneshot_mods();
@@ -164,10 +195,9 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 }
 
 void tap_dance_task() {
-    if (highest_td == -1) return;
     uint16_t tap_user_defined;
 
-    for (uint8_t i = 0; i <= highest_td; i++) {
+    for (int16_t i = next_active_td(-1); i >= 0; i = next_active_td(i)) {
         qk_tap_dance_action_t *action = &tap_dance_actions[i];
         if (action->custom_tapping_term > 0) {
             tap_user_defined = action->custom_tapping_term;
@@ -178,7 +208,7 @@ void tap_dance_task() {
             tap_user_defined = TAPPING_TERM;
 #endif
         }
-        if (action->state.count && timer_elapsed(action->state.timer) > tap_user_defined) {
+        if (timer_elapsed(action->state.timer) > tap_user_defined) {
             process_tap_dance_action_on_dance_finished(action);
             reset_tap_dance(&action->state);
         }
@@ -190,7 +220,8 @@ void reset_tap_dance(qk_tap_dance_state_t *state) {
 
     if (state->pressed) return;
 
-    action = &tap_dance_actions[state->keycode - QK_TAP_DANCE];
+    // The state is part of its action, which gives the index even if the dance was never pressed and has no keycode
+    action = (qk_tap_dance_action_t *)((uint8_t *)state - offsetof(qk_tap_dance_action_t, state));
 
     process_tap_dance_action_on_reset(action);
 
@@ -199,4 +230,5 @@ void reset_tap_dance(qk_tap_dance_state_t *state) {
     state->finished             = false;
     state->interrupting_keycode = 0;
     last_td                     = 0;
+    set_td_active(action - tap_dance_actions, false);
 }
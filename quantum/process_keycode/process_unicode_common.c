@@ -208,12 +208,214 @@ void register_hex32(uint32_t hex) {
     }
 }
 
+#ifdef UNICODE_NON_BLOCKING
+#    ifndef DEFERRED_EXEC_ENABLE
+#        error "UNICODE_NON_BLOCKING requires DEFERRED_EXEC_ENABLE = yes"
+#    endif
+#    if UNICODE_QUEUE_SIZE > 255
+#        error "UNICODE_QUEUE_SIZE must not be larger than 255"
+#    endif
+
+#    define PGM_LOADBIT(mem, pos) ((pgm_read_byte(&((mem)[(pos) / 8])) >> ((pos) % 8)) & 0x01)
+
+// Queue entries from send_unicode_hex_string(), typed with exactly the given
+// number of digits (up to six) and without surrogate pairs, like the string
+#    define UNICODE_QUEUE_HEX_STRING 0x80000000
+#    define UNICODE_QUEUE_HEX_DIGITS(entry) (((entry) >> 24) & 0x7)
+
+// Code points waiting to be typed
+static uint32_t       unicode_queue[UNICODE_QUEUE_SIZE];
+static uint8_t        unicode_queue_head;
+static uint8_t        unicode_queue_count;
+static deferred_token unicode_token = INVALID_DEFERRED_TOKEN;
+
+// The code point currently being typed
+static struct {
+    uint8_t digits[8];
+    uint8_t count;
+    uint8_t next;
+    uint8_t held;      // Digit key currently pressed, KC_NO if none
+    bool    in_input;  // Between unicode_input_start() and unicode_input_finish()
+} unicode_output;
+
+// Keycode that types a hex digit without any modifiers, or KC_NO if the
+// layout needs modifiers for it and it has to go through send_nibble()
+static uint8_t unicode_digit_keycode(uint8_t digit) {
+    if (unicode_config.input_mode == UC_WIN) {
+        return digit < 10 ? KC_KP_1 + (10 + digit - 1) % 10 : KC_A + (digit - 10);
+    }
+
+    uint8_t c = digit < 10 ? '0' + digit : 'a' + (digit - 10);
+    if (PGM_LOADBIT(ascii_to_shift_lut, c) || PGM_LOADBIT(ascii_to_altgr_lut, c) || PGM_LOADBIT(ascii_to_dead_lut, c)) {
+        return KC_NO;
+    }
+    return pgm_read_byte(&ascii_to_keycode_lut[c]);
+}
+
+static void unicode_output_load_hex32(uint32_t hex) {
+    // Same digits as register_hex32(): at least four, no leading zeros beyond that
+    bool onzerostart = true;
+    for (int i = 7; i >= 0; i--) {
+        uint8_t digit = ((hex >> (i * 4)) & 0xF);
+        if (digit != 0 || i <= 3) {
+            onzerostart = false;
+        }
+        if (!onzerostart) {
+            unicode_output.digits[unicode_output.count++] = digit;
+        }
+    }
+}
+
+static void unicode_output_load(uint32_t code_point) {
+    unicode_output.count = 0;
+    unicode_output.next  = 0;
+    if (code_point & UNICODE_QUEUE_HEX_STRING) {
+        for (int i = UNICODE_QUEUE_HEX_DIGITS(code_point) - 1; i >= 0; i--) {
+            unicode_output.digits[unicode_output.count++] = (code_point >> (i * 4)) & 0xF;
+        }
+    } else if (code_point > 0xFFFF && unicode_config.input_mode == UC_MAC) {
+        // Convert code point to UTF-16 surrogate pair on macOS
+        code_point -= 0x10000;
+        uint32_t lo = code_point & 0x3FF, hi = (code_point & 0xFFC00) >> 10;
+        unicode_output_load_hex32(hi + 0xD800);
+        unicode_output_load_hex32(lo + 0xDC00);
+    } else {
+        unicode_output_load_hex32(code_point);
+    }
+}
+
+static uint32_t unicode_queue_pop(void) {
+    uint32_t code_point = unicode_queue[unicode_queue_head];
+    unicode_queue_head  = (unicode_queue_head + 1) % UNICODE_QUEUE_SIZE;
+    unicode_queue_count--;
+    return code_point;
+}
+
+/* Sends the next report of the queued output. Releasing a digit and pressing
+ * the next one share a report, so a code point takes one report per digit
+ * (plus one for repeated digits) instead of two.
+ *
+ * Returns the delay until the next step, or 0 when the queue is empty.
+ */
+static uint32_t unicode_output_step(void) {
+    if (unicode_output.held != KC_NO) {
+        uint8_t released = unicode_output.held;
+        del_key(released);
+        unicode_output.held = KC_NO;
+        if (unicode_output.next < unicode_output.count) {
+            uint8_t kc = unicode_digit_keycode(unicode_output.digits[unicode_output.next]);
+            if (kc != KC_NO && kc != released) {
+                add_key(kc);
+                unicode_output.held = kc;
+                unicode_output.next++;
+            }
+        }
+        send_keyboard_report();
+        return 1;
+    }
+
+    if (unicode_output.next < unicode_output.count) {
+        uint8_t digit = unicode_output.digits[unicode_output.next++];
+        uint8_t kc    = unicode_digit_keycode(digit);
+        if (kc == KC_NO) {
+            send_nibble(digit);
+        } else {
+            add_key(kc);
+            unicode_output.held = kc;
+            send_keyboard_report();
+        }
+        return 1;
+    }
+
+    if (unicode_output.in_input) {
+        // Unicode Hex Input takes any number of characters while Option is held
+        if (unicode_config.input_mode == UC_MAC && unicode_queue_count > 0) {
+            unicode_output_load(unicode_queue_pop());
+            return 1;
+        }
+        unicode_input_finish();
+        unicode_output.in_input = false;
+        return 1;
+    }
+
+    if (unicode_queue_count == 0) {
+        return 0;
+    }
+
+    unicode_output_load(unicode_queue_pop());
+    unicode_input_start();
+    unicode_output.in_input = true;
+    return 1;
+}
+
+static uint32_t unicode_output_callback(uint32_t trigger_time, void *cb_arg) {
+    uint32_t delay = unicode_output_step();
+    if (delay == 0) {
+        unicode_token = INVALID_DEFERRED_TOKEN;
+    }
+    return delay;
+}
+
+void unicode_flush(void) {
+    uint32_t delay;
+    while ((delay = unicode_output_step()) != 0) {
+        wait_ms(delay);
+    }
+}
+
+static void unicode_queue_push(uint32_t code_point) {
+    // Typing the front of the queue synchronously keeps the output in order
+    while (unicode_queue_count == UNICODE_QUEUE_SIZE) {
+        wait_ms(unicode_output_step());
+    }
+
+    unicode_queue[(unicode_queue_head + unicode_queue_count) % UNICODE_QUEUE_SIZE] = code_point;
+    unicode_queue_count++;
+
+    if (unicode_token == INVALID_DEFERRED_TOKEN) {
+        unicode_token = defer_exec(1, unicode_output_callback, NULL);
+        if (unicode_token == INVALID_DEFERRED_TOKEN) {
+            // No free deferred executor slot, fall back to blocking output
+            unicode_flush();
+        }
+    }
+}
+
+/* Queues a token of send_unicode_hex_string() if it is made of up to six
+ * hex digits, to be typed as written. Empty tokens are skipped.
+ */
+static bool unicode_queue_hex_string(const char *token, size_t length) {
+    if (length > 6) {
+        return false;
+    }
+
+    uint32_t digits = 0;
+    for (size_t i = 0; i < length; i++) {
+        char c = token[i];
+        if (!isxdigit((unsigned char)c)) {
+            return false;
+        }
+        digits = digits << 4 | (isdigit((unsigned char)c) ? c - '0' : tolower((unsigned char)c) - 'a' + 10);
+    }
+
+    if (length > 0) {
+        unicode_queue_push(UNICODE_QUEUE_HEX_STRING | (uint32_t)length << 24 | digits);
+    }
+    return true;
+}
+#else
+void unicode_flush(void) {}
+#endif
+
 void register_unicode(uint32_t code_point) {
     if (code_point > 0x10FFFF || (code_point > 0xFFFF && unicode_config.input_mode == UC_WIN)) {
         // Code point out of range, do nothing
         return;
     }
 
+#ifdef UNICODE_NON_BLOCKING
+    unicode_queue_push(code_point);
+#else
     unicode_input_start();
     if (code_point > 0xFFFF && unicode_config.input_mode == UC_MAC) {
         // Convert code point to UTF-16 surrogate pair on macOS
@@ -225,6 +427,7 @@ void register_unicode(uint32_t code_point) {
         register_hex32(code_point);
     }
     unicode_input_finish();
+#endif
 }
 
 // clang-format off
@@ -247,6 +450,14 @@ void send_unicode_hex_string(const char *str) {
             *p = tolower((unsigned char)*p);
         }
 
+#ifdef UNICODE_NON_BLOCKING
+        if (unicode_queue_hex_string(code_point, n)) {
+            str += n;
+            continue;
+        }
+        // Anything else is sent as a string like before, after the queue
+        unicode_flush();
+#endif
         // Send the code point as a Unicode input string
         unicode_input_start();
         send_string(code_point);
@@ -49,6 +49,11 @@
 #    define UNICODE_TYPE_DELAY 10
 #endif
 
+// Number of code points that can be waiting for output with UNICODE_NON_BLOCKING
+#ifndef UNICODE_QUEUE_SIZE
+#    define UNICODE_QUEUE_SIZE 16
+#endif
+
 // Deprecated aliases
 #if !defined(UNICODE_KEY_MAC) && defined(UNICODE_KEY_OSX)
 #    define UNICODE_KEY_MAC UNICODE_KEY_OSX
@@ -92,6 +97,7 @@ void register_unicode(uint32_t code_point);
 
 void send_unicode_hex_string(const char *str);
 void send_unicode_string(const char *str);
+void unicode_flush(void);
 
 bool process_unicode_common(uint16_t keycode, keyrecord_t *record);
 
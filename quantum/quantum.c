@@ -220,6 +220,13 @@ bool process_record_quantum(keyrecord_t *record) {
     preprocess_tap_dance(keycode, record);
 #endif
 
+#if (defined(UNICODE_ENABLE) || defined(UNICODEMAP_ENABLE) || defined(UCIS_ENABLE)) && defined(UNICODE_NON_BLOCKING)
+    // Other keys must not overtake the queued Unicode output
+    if (!(keycode >= QK_UNICODE && keycode <= QK_UNICODE_MAX)) {
+        unicode_flush();
+    }
+#endif
+
     if (!(
 #if defined(KEY_LOCK_ENABLE)
             // Must run first to be able to mask key_up events.
@@ -461,6 +468,10 @@ void matrix_scan_quantum() {
     autoshift_matrix_scan();
 #endif
 
+#ifdef LEADER_ENABLE
+    leader_match_task();
+#endif
+
     matrix_scan_kb();
 }
 
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
 void raw_hid_receive(uint8_t *data, uint8_t length);
 
 void raw_hid_send(uint8_t *data, uint8_t length);
+
+// Sends without waiting for the host. Returns false if the packet was not sent
+bool raw_hid_try_send(uint8_t *data, uint8_t length);
@@ -31,7 +31,12 @@ const led_point_t k_rgb_matrix_center = {112, 32};
 const led_point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 #endif
 
+#ifdef RGB_MATRIX_GAMMA_DITHER
+// The output stage applies the lightness curve, at a higher resolution
+__attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb_nocie(hsv); }
+#else
 __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv); }
+#endif
 
 // Generic effect runners
 #include "rgb_matrix_runners.inc"
@@ -67,6 +72,33 @@ __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv
 #    define RGB_MATRIX_MAXIMUM_BRIGHTNESS UINT8_MAX
 #endif
 
+#ifdef RGB_MATRIX_GAMMA_DITHER
+#    include "led_tables.h"
+#    ifndef RGB_MATRIX_GAMMA_TABLE
+#        define RGB_MATRIX_GAMMA_TABLE CIE1931_CURVE_12
+#    endif
+#    ifndef RGB_MATRIX_DITHER_BITS
+#        define RGB_MATRIX_DITHER_BITS 2
+#    elif RGB_MATRIX_DITHER_BITS > LED_OUTPUT_FRACTION_BITS
+#        error RGB_MATRIX_DITHER_BITS must be at most 4
+#    endif
+#    ifndef RGB_MATRIX_DITHER_INTERVAL
+#        define RGB_MATRIX_DITHER_INTERVAL 4
+#    endif
+#else
+#    define RGB_MATRIX_GAMMA_TABLE NULL
+#    define RGB_MATRIX_DITHER_BITS 0
+#endif
+
+#ifdef RGB_MATRIX_POWER_LIMIT_MA
+#    ifndef RGB_MATRIX_POWER_CHANNEL_MA
+#        define RGB_MATRIX_POWER_CHANNEL_MA 20
+#    endif
+#    define RGB_MATRIX_POWER_BUDGET LED_POWER_BUDGET(RGB_MATRIX_POWER_LIMIT_MA, RGB_MATRIX_POWER_CHANNEL_MA)
+#else
+#    define RGB_MATRIX_POWER_BUDGET 0
+#endif
+
 #if !defined(RGB_MATRIX_HUE_STEP)
 #    define RGB_MATRIX_HUE_STEP 8
 #endif
@@ -117,6 +149,10 @@ uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS] = {{0}};
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
 last_hit_t g_last_hit_tracker;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+uint8_t g_rgb_led_angle[DRIVER_LED_TOTAL];
+uint8_t g_rgb_led_dist[DRIVER_LED_TOTAL];
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
 
 // internals
 static bool            suspend_state     = false;
@@ -134,11 +170,54 @@ static uint32_t rgb_timer_buffer;
 static last_hit_t last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
+// distances from the LEDs of recent key hits to every LED
+#if defined(RGB_MATRIX_GEOMETRY_CACHE) && defined(RGB_MATRIX_KEYREACTIVE_ENABLED)
+static uint8_t rgb_hit_dist[LED_HITS_TO_REMEMBER][DRIVER_LED_TOTAL];
+static uint8_t rgb_hit_dist_led[LED_HITS_TO_REMEMBER];
+#endif  // defined(RGB_MATRIX_GEOMETRY_CACHE) && defined(RGB_MATRIX_KEYREACTIVE_ENABLED)
+
 // split rgb matrix
 #if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
 const uint8_t k_rgb_matrix_split[2] = RGB_MATRIX_SPLIT;
 #endif
 
+// composed frame
+#ifdef RGB_MATRIX_COMPOSITOR
+static uint8_t     rgb_layer_pixels[RGB_MATRIX_LAYER_COUNT][DRIVER_LED_TOTAL * 3];
+static uint8_t     rgb_indicator_mask[(DRIVER_LED_TOTAL + 7) / 8];
+static uint8_t     rgb_composed[DRIVER_LED_TOTAL * 3];
+static led_layer_t rgb_layers[RGB_MATRIX_LAYER_COUNT] = {
+    [RGB_MATRIX_LAYER_EFFECT]     = {rgb_layer_pixels[RGB_MATRIX_LAYER_EFFECT], NULL, LED_BLEND_REPLACE, true},
+    [RGB_MATRIX_LAYER_OVERLAY]    = {rgb_layer_pixels[RGB_MATRIX_LAYER_OVERLAY], NULL, LED_BLEND_ADD, false},
+    [RGB_MATRIX_LAYER_INDICATORS] = {rgb_layer_pixels[RGB_MATRIX_LAYER_INDICATORS], rgb_indicator_mask, LED_BLEND_REPLACE, true},
+};
+static led_compositor_t rgb_compositor     = {rgb_layers, RGB_MATRIX_LAYER_COUNT, DRIVER_LED_TOTAL, 3, rgb_composed, true};
+static uint8_t          rgb_target_layer   = RGB_MATRIX_LAYER_EFFECT;
+static uint8_t          rgb_overlay_effect = RGB_MATRIX_NONE;
+static uint8_t          rgb_last_overlay   = RGB_MATRIX_NONE;
+static effect_params_t  rgb_overlay_params = {0, LED_FLAG_ALL, false};
+
+#endif  // RGB_MATRIX_COMPOSITOR
+
+// gamma corrected, dithered and power limited output
+#ifdef RGB_MATRIX_OUTPUT_STAGE
+static uint8_t      rgb_linear[DRIVER_LED_TOTAL * 3];
+static led_output_t rgb_output = {RGB_MATRIX_GAMMA_TABLE, rgb_linear, DRIVER_LED_TOTAL, 3, RGB_MATRIX_DITHER_BITS, 0, true, RGB_MATRIX_POWER_BUDGET, 0, LED_POWER_SCALE_MAX};
+#    if RGB_MATRIX_DITHER_BITS > 0
+static uint32_t rgb_dither_timer = 0;
+#    endif
+#endif  // RGB_MATRIX_OUTPUT_STAGE
+
+#if defined(RGB_MATRIX_COMPOSITOR) || defined(RGB_MATRIX_OUTPUT_STAGE)
+static void rgb_matrix_write_led(int index, const uint8_t *value) { rgb_matrix_driver.set_color(index, value[0], value[1], value[2]); }
+#endif
+
+#if defined(RGB_MATRIX_COMPOSITOR) && defined(RGB_MATRIX_OUTPUT_STAGE)
+static void rgb_matrix_write_linear(int index, const uint8_t *value) { led_output_set(&rgb_output, index, value); }
+#elif defined(RGB_MATRIX_COMPOSITOR)
+#    define rgb_matrix_write_linear rgb_matrix_write_led
+#endif
+
 EECONFIG_DEBOUNCE_HELPER(rgb_matrix, EECONFIG_RGB_MATRIX, rgb_matrix_config);
 
 void eeconfig_update_rgb_matrix(void) { eeconfig_flush_rgb_matrix(true); }
@@ -176,12 +255,53 @@ uint8_t rgb_matrix_map_row_column_to_led(uint8_t row, uint8_t column, uint8_t *l
     return led_count;
 }
 
-void rgb_matrix_update_pwm_buffers(void) { rgb_matrix_driver.flush(); }
+void rgb_matrix_update_pwm_buffers(void) {
+#ifdef RGB_MATRIX_COMPOSITOR
+    // Only the LEDs that changed since the last frame reach the driver
+    led_compositor_render(&rgb_compositor, rgb_matrix_write_linear);
+#endif
+#ifdef RGB_MATRIX_OUTPUT_STAGE
+    // With dithering every LED is written again, as the values change from frame to frame
+    led_output_render(&rgb_output, rgb_matrix_write_led);
+#    if RGB_MATRIX_DITHER_BITS > 0
+    rgb_dither_timer = sync_timer_read32();
+#    endif
+#endif
+    rgb_matrix_driver.flush();
+}
+
+#if defined(RGB_MATRIX_OUTPUT_STAGE) && RGB_MATRIX_DITHER_BITS > 0
+// Steps the dither cycle between effect frames, so it repeats faster than the effects are rendered
+static void rgb_matrix_dither_task(void) {
+    if (sync_timer_elapsed32(rgb_dither_timer) >= RGB_MATRIX_DITHER_INTERVAL) {
+        rgb_dither_timer = sync_timer_read32();
+        if (led_output_render(&rgb_output, rgb_matrix_write_led)) {
+            rgb_matrix_driver.flush();
+        }
+    }
+}
+#endif
 
-void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) { rgb_matrix_driver.set_color(index, red, green, blue); }
+void rgb_matrix_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+#ifdef RGB_MATRIX_COMPOSITOR
+    uint8_t value[3] = {red, green, blue};
+    led_layer_set(&rgb_compositor, rgb_target_layer, index, value);
+#elif defined(RGB_MATRIX_OUTPUT_STAGE)
+    uint8_t value[3] = {red, green, blue};
+    led_output_set(&rgb_output, index, value);
+#else
+    rgb_matrix_driver.set_color(index, red, green, blue);
+#endif
+}
 
 void rgb_matrix_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
-#if defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
+#if defined(RGB_MATRIX_COMPOSITOR)
+    uint8_t value[3] = {red, green, blue};
+    led_layer_set_all(&rgb_compositor, rgb_target_layer, value);
+#elif defined(RGB_MATRIX_OUTPUT_STAGE)
+    uint8_t value[3] = {red, green, blue};
+    led_output_set_all(&rgb_output, value);
+#elif defined(RGB_MATRIX_ENABLE) && defined(RGB_MATRIX_SPLIT)
     for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) rgb_matrix_set_color(i, red, green, blue);
 #else
     rgb_matrix_driver.set_color_all(red, green, blue);
@@ -234,6 +354,59 @@ void process_rgb_matrix(uint8_t row, uint8_t col, bool pressed) {
 #endif  // defined(RGB_MATRIX_FRAMEBUFFER_EFFECTS) && defined(ENABLE_RGB_MATRIX_TYPING_HEATMAP)
 }
 
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+static void rgb_matrix_geometry_init(void) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx         = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy         = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        g_rgb_led_angle[i] = atan2_8(dy, dx);
+        g_rgb_led_dist[i]  = sqrt16(dx * dx + dy * dy);
+    }
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+    memset(rgb_hit_dist_led, NO_LED, sizeof(rgb_hit_dist_led));
+#    endif
+}
+
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+static const uint8_t *rgb_hit_dist_find(uint8_t led, bool *used) {
+    for (uint8_t r = 0; r < LED_HITS_TO_REMEMBER; r++) {
+        if (rgb_hit_dist_led[r] == led) {
+            used[r] = true;
+            return rgb_hit_dist[r];
+        }
+    }
+    return NULL;
+}
+
+void rgb_matrix_hit_distances(uint8_t start, uint8_t count, const uint8_t **rows) {
+    bool used[LED_HITS_TO_REMEMBER] = {false};
+
+    // Keep the rows of keys that are still being tracked
+    for (uint8_t j = start; j < count; j++) {
+        rows[j] = rgb_hit_dist_find(g_last_hit_tracker.index[j], used);
+    }
+
+    // There are never more keys than rows, so a row that is not needed by this frame is always left for new ones
+    uint8_t r = 0;
+    for (uint8_t j = start; j < count; j++) {
+        uint8_t led = g_last_hit_tracker.index[j];
+        if (rows[j] || (rows[j] = rgb_hit_dist_find(led, used))) {
+            continue;
+        }
+        while (used[r]) r++;
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            int16_t dx         = g_led_config.point[i].x - g_led_config.point[led].x;
+            int16_t dy         = g_led_config.point[i].y - g_led_config.point[led].y;
+            rgb_hit_dist[r][i] = sqrt16(dx * dx + dy * dy);
+        }
+        rgb_hit_dist_led[r] = led;
+        used[r]             = true;
+        rows[j]             = rgb_hit_dist[r];
+    }
+}
+#    endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
+#endif      // RGB_MATRIX_GEOMETRY_CACHE
+
 void rgb_matrix_test(void) {
     // Mask out bits 4 and 5
     // Increase the factor to make the test animation slower (and reduce to make it faster)
@@ -299,6 +472,9 @@ static void rgb_task_timers(void) {
 
 static void rgb_task_sync(void) {
     eeconfig_flush_rgb_matrix(false);
+#if defined(RGB_MATRIX_OUTPUT_STAGE) && RGB_MATRIX_DITHER_BITS > 0
+    rgb_matrix_dither_task();
+#endif
     // next task
     if (sync_timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
 }
@@ -313,39 +489,34 @@ static void rgb_task_start(void) {
     g_last_hit_tracker = last_hit_buffer;
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 
+#ifdef RGB_MATRIX_COMPOSITOR
+    // indicators are drawn again for every frame
+    led_layer_clear(&rgb_compositor, RGB_MATRIX_LAYER_INDICATORS);
+#endif  // RGB_MATRIX_COMPOSITOR
+
     // next task
     rgb_task_state = RENDERING;
 }
 
-static void rgb_task_render(uint8_t effect) {
-    bool rendering         = false;
-    rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
-    if (rgb_effect_params.flags != rgb_matrix_config.flags) {
-        rgb_effect_params.flags = rgb_matrix_config.flags;
-        rgb_matrix_set_color_all(0, 0, 0);
-    }
-
+static bool rgb_matrix_run_effect(uint8_t effect, effect_params_t *params) {
     // each effect can opt to do calculations
     // and/or request PWM buffer updates.
     switch (effect) {
         case RGB_MATRIX_NONE:
-            rendering = rgb_matrix_none(&rgb_effect_params);
-            break;
+            return rgb_matrix_none(params);
 
 // ---------------------------------------------
 // -----Begin rgb effect switch case macros-----
-#define RGB_MATRIX_EFFECT(name, ...)          \
-    case RGB_MATRIX_##name:                   \
-        rendering = name(&rgb_effect_params); \
-        break;
+#define RGB_MATRIX_EFFECT(name, ...) \
+    case RGB_MATRIX_##name:          \
+        return name(params);
 #include "rgb_matrix_effects.inc"
 #undef RGB_MATRIX_EFFECT
 
 #if defined(RGB_MATRIX_CUSTOM_KB) || defined(RGB_MATRIX_CUSTOM_USER)
-#    define RGB_MATRIX_EFFECT(name, ...)          \
-        case RGB_MATRIX_CUSTOM_##name:            \
-            rendering = name(&rgb_effect_params); \
-            break;
+#    define RGB_MATRIX_EFFECT(name, ...) \
+        case RGB_MATRIX_CUSTOM_##name:   \
+            return name(params);
 #    ifdef RGB_MATRIX_CUSTOM_KB
 #        include "rgb_matrix_kb.inc"
 #    endif
@@ -356,14 +527,43 @@ static void rgb_task_render(uint8_t effect) {
 #endif
             // -----End rgb effect switch case macros-------
             // ---------------------------------------------
+    }
 
-        // Factory default magic value
-        case UINT8_MAX: {
-            rgb_matrix_test();
-            rgb_task_state = FLUSHING;
-        }
-            return;
+    return false;
+}
+
+static void rgb_task_render(uint8_t effect) {
+    bool rendering         = false;
+    rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
+    if (rgb_effect_params.flags != rgb_matrix_config.flags) {
+        rgb_effect_params.flags = rgb_matrix_config.flags;
+        rgb_matrix_set_color_all(0, 0, 0);
+#ifdef RGB_MATRIX_COMPOSITOR
+        led_layer_clear(&rgb_compositor, RGB_MATRIX_LAYER_OVERLAY);
+#endif  // RGB_MATRIX_COMPOSITOR
+    }
+
+    // Factory default magic value
+    if (effect == UINT8_MAX) {
+        rgb_matrix_test();
+        rgb_task_state = FLUSHING;
+        return;
+    }
+
+    rendering = rgb_matrix_run_effect(effect, &rgb_effect_params);
+
+#ifdef RGB_MATRIX_COMPOSITOR
+    // The overlay renders the same slice of LEDs in the same pass as the effect below it
+    rgb_layers[RGB_MATRIX_LAYER_OVERLAY].enabled = effect != RGB_MATRIX_NONE && rgb_overlay_effect != RGB_MATRIX_NONE;
+    if (rgb_layers[RGB_MATRIX_LAYER_OVERLAY].enabled) {
+        rgb_overlay_params.iter  = rgb_effect_params.iter;
+        rgb_overlay_params.flags = rgb_effect_params.flags;
+        rgb_overlay_params.init  = rgb_effect_params.init || (rgb_overlay_effect != rgb_last_overlay);
+        rgb_target_layer         = RGB_MATRIX_LAYER_OVERLAY;
+        rendering |= rgb_matrix_run_effect(rgb_overlay_effect, &rgb_overlay_params);
+        rgb_target_layer = RGB_MATRIX_LAYER_EFFECT;
     }
+#endif  // RGB_MATRIX_COMPOSITOR
 
     rgb_effect_params.iter++;
 
@@ -381,6 +581,9 @@ static void rgb_task_flush(uint8_t effect) {
     // update last trackers after the first full render so we can init over several frames
     rgb_last_effect = effect;
     rgb_last_enable = rgb_matrix_config.enable;
+#ifdef RGB_MATRIX_COMPOSITOR
+    rgb_last_overlay = rgb_overlay_effect;
+#endif  // RGB_MATRIX_COMPOSITOR
 
     // update pwm buffers
     rgb_matrix_update_pwm_buffers();
@@ -409,8 +612,14 @@ void rgb_matrix_task(void) {
         case RENDERING:
             rgb_task_render(effect);
             if (effect) {
+#ifdef RGB_MATRIX_COMPOSITOR
+                rgb_target_layer = RGB_MATRIX_LAYER_INDICATORS;
+#endif  // RGB_MATRIX_COMPOSITOR
                 rgb_matrix_indicators();
                 rgb_matrix_indicators_advanced(&rgb_effect_params);
+#ifdef RGB_MATRIX_COMPOSITOR
+                rgb_target_layer = RGB_MATRIX_LAYER_EFFECT;
+#endif  // RGB_MATRIX_COMPOSITOR
             }
             break;
         case FLUSHING:
@@ -455,6 +664,14 @@ __attribute__((weak)) void rgb_matrix_indicators_advanced_user(uint8_t led_min,
 
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
+#ifdef RGB_MATRIX_COMPOSITOR
+    // The driver starts out blank, whatever was composed before
+    led_compositor_invalidate(&rgb_compositor);
+#endif
+
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+    rgb_matrix_geometry_init();
+#endif  // RGB_MATRIX_GEOMETRY_CACHE
 
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
@@ -485,8 +702,11 @@ void rgb_matrix_init(void) {
 void rgb_matrix_set_suspend_state(bool state) {
 #ifdef RGB_DISABLE_WHEN_USB_SUSPENDED
     if (state && !suspend_state) {  // only run if turning off, and only once
-        rgb_task_render(0);         // turn off all LEDs when suspending
-        rgb_task_flush(0);          // and actually flash led state to LEDs
+#    ifdef RGB_MATRIX_COMPOSITOR
+        led_layer_clear(&rgb_compositor, RGB_MATRIX_LAYER_INDICATORS);
+#    endif
+        rgb_task_render(0);  // turn off all LEDs when suspending
+        rgb_task_flush(0);   // and actually flash led state to LEDs
     }
     suspend_state = state;
 #endif
@@ -622,3 +842,21 @@ void rgb_matrix_decrease_speed(void) { rgb_matrix_decrease_speed_helper(true); }
 led_flags_t rgb_matrix_get_flags(void) { return rgb_matrix_config.flags; }
 
 void rgb_matrix_set_flags(led_flags_t flags) { rgb_matrix_config.flags = flags; }
+
+#ifdef RGB_MATRIX_COMPOSITOR
+void rgb_matrix_set_overlay(uint8_t mode, led_blend_t blend) {
+    rgb_overlay_effect                         = mode < RGB_MATRIX_EFFECT_MAX ? mode : RGB_MATRIX_NONE;
+    rgb_layers[RGB_MATRIX_LAYER_OVERLAY].blend = blend;
+    led_layer_clear(&rgb_compositor, RGB_MATRIX_LAYER_OVERLAY);
+    rgb_task_state = STARTING;
+    dprintf("rgb matrix overlay: %u\n", rgb_overlay_effect);
+}
+
+uint8_t rgb_matrix_get_overlay(void) { return rgb_overlay_effect; }
+
+void rgb_matrix_set_layer_blend(uint8_t layer, led_blend_t blend) {
+    if (layer < RGB_MATRIX_LAYER_COUNT) {
+        rgb_layers[layer].blend = blend;
+    }
+}
+#endif  // RGB_MATRIX_COMPOSITOR
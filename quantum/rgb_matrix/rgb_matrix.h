@@ -23,6 +23,13 @@
 #include "rgb_matrix_types.h"
 #include "color.h"
 #include "quantum.h"
+#ifdef RGB_MATRIX_COMPOSITOR
+#    include "led_compositor.h"
+#endif
+#if defined(RGB_MATRIX_GAMMA_DITHER) || defined(RGB_MATRIX_POWER_LIMIT_MA)
+#    define RGB_MATRIX_OUTPUT_STAGE
+#    include "led_output.h"
+#endif
 
 #ifdef IS31FL3731
 #    include "is31fl3731.h"
@@ -180,6 +187,20 @@ void        rgb_matrix_decrease_speed_noeeprom(void);
 led_flags_t rgb_matrix_get_flags(void);
 void        rgb_matrix_set_flags(led_flags_t flags);
 
+#ifdef RGB_MATRIX_COMPOSITOR
+// Layers of the composed frame, bottom first
+enum rgb_matrix_layers {
+    RGB_MATRIX_LAYER_EFFECT,      // The current mode
+    RGB_MATRIX_LAYER_OVERLAY,     // A second effect stacked on top, see rgb_matrix_set_overlay()
+    RGB_MATRIX_LAYER_INDICATORS,  // Everything drawn by the indicator callbacks
+    RGB_MATRIX_LAYER_COUNT
+};
+
+void    rgb_matrix_set_overlay(uint8_t mode, led_blend_t blend);
+uint8_t rgb_matrix_get_overlay(void);
+void    rgb_matrix_set_layer_blend(uint8_t layer, led_blend_t blend);
+#endif
+
 #ifndef RGBLIGHT_ENABLE
 #    define eeconfig_update_rgblight_current eeconfig_update_rgb_matrix
 #    define rgblight_toggle rgb_matrix_toggle
@@ -258,3 +279,12 @@ extern last_hit_t g_last_hit_tracker;
 #ifdef RGB_MATRIX_FRAMEBUFFER_EFFECTS
 extern uint8_t g_rgb_frame_buffer[MATRIX_ROWS][MATRIX_COLS];
 #endif
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+// Angle and distance of every LED around k_rgb_matrix_center, filled by rgb_matrix_init()
+extern uint8_t g_rgb_led_angle[DRIVER_LED_TOTAL];
+extern uint8_t g_rgb_led_dist[DRIVER_LED_TOTAL];
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+// Points rows[start..count) at the distances from each tracked hit to every LED
+void rgb_matrix_hit_distances(uint8_t start, uint8_t count, const uint8_t **rows);
+#    endif
+#endif
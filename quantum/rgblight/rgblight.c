@@ -30,6 +30,9 @@
 #ifdef VELOCIKEY_ENABLE
 #    include "velocikey.h"
 #endif
+#ifdef RGBLIGHT_POWER_LIMIT_MA
+#    include "led_output.h"
+#endif
 
 #ifndef MIN
 #    define MIN(a, b) (((a) < (b)) ? (a) : (b))
@@ -102,6 +105,13 @@ static inline int is_static_effect(uint8_t mode) { return memchr(static_effect_t
 const uint8_t led_map[] PROGMEM = RGBLIGHT_LED_MAP;
 #endif
 
+#ifdef RGBLIGHT_POWER_LIMIT_MA
+#    ifndef RGBLIGHT_POWER_CHANNEL_MA
+#        define RGBLIGHT_POWER_CHANNEL_MA 20
+#    endif
+static uint16_t rgblight_power_scale = LED_POWER_SCALE_MAX;
+#endif
+
 #ifdef RGBLIGHT_EFFECT_STATIC_GRADIENT
 __attribute__((weak)) const uint8_t RGBLED_GRADIENT_RANGES[] PROGMEM = {255, 170, 127, 85, 64};
 #endif
@@ -800,6 +810,26 @@ __attribute__((weak)) void rgblight_call_driver(LED_TYPE *start_led, uint8_t num
 
 #ifndef RGBLIGHT_CUSTOM_DRIVER
 
+#    ifdef RGBLIGHT_POWER_LIMIT_MA
+// Scales the frame that is about to be sent down to fit the power budget
+static void rgblight_limit_power(LED_TYPE *start_led, uint8_t num_leds) {
+    uint8_t *channels = (uint8_t *)start_led;
+    uint16_t count    = num_leds * sizeof(LED_TYPE);
+    uint32_t load     = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        load += channels[i];
+    }
+
+    rgblight_power_scale = led_power_scale(rgblight_power_scale, load << LED_OUTPUT_FRACTION_BITS, LED_POWER_BUDGET(RGBLIGHT_POWER_LIMIT_MA, RGBLIGHT_POWER_CHANNEL_MA));
+    if (rgblight_power_scale < LED_POWER_SCALE_MAX) {
+        for (uint16_t i = 0; i < count; i++) {
+            channels[i] = (channels[i] * rgblight_power_scale) >> 8;
+        }
+    }
+}
+#    endif
+
 void rgblight_set(void) {
     LED_TYPE *start_led;
     uint8_t   num_leds = rgblight_ranges.clipping_num_leds;
@@ -827,12 +857,17 @@ void rgblight_set(void) {
     }
 #    endif
 
-#    ifdef RGBLIGHT_LED_MAP
+#    if defined(RGBLIGHT_LED_MAP)
     LED_TYPE led0[RGBLED_NUM];
     for (uint8_t i = 0; i < RGBLED_NUM; i++) {
         led0[i] = led[pgm_read_byte(&led_map[i])];
     }
     start_led = led0 + rgblight_ranges.clipping_start_pos;
+#    elif defined(RGBLIGHT_POWER_LIMIT_MA)
+    // Scaled in a copy, so the effects keep drawing over a full brightness frame
+    LED_TYPE led0[RGBLED_NUM];
+    memcpy(led0, led, sizeof(led0));
+    start_led = led0 + rgblight_ranges.clipping_start_pos;
 #    else
     start_led = led + rgblight_ranges.clipping_start_pos;
 #    endif
@@ -841,6 +876,9 @@ void rgblight_set(void) {
     for (uint8_t i = 0; i < num_leds; i++) {
         convert_rgb_to_rgbw(&start_led[i]);
     }
+#    endif
+#    ifdef RGBLIGHT_POWER_LIMIT_MA
+    rgblight_limit_power(start_led, num_leds);
 #    endif
     rgblight_call_driver(start_led, num_leds);
 }
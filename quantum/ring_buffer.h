@@ -1,44 +1,138 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
 #pragma once
 
-#include <util/atomic.h>
-#include <stdint.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* A queue of fixed size items between one producer and one consumer, for
+ * example an interrupt handler and the main loop. The head is only written by
+ * the producer and the tail only by the consumer, and both are single bytes,
+ * which every supported MCU loads and stores atomically. So neither side has
+ * to disable interrupts, as long as there is only one of each.
+ *
+ * One slot is always left empty to tell a full buffer from an empty one, so a
+ * buffer of N slots holds N - 1 items. */
+
+typedef struct {
+    uint8_t *        data;       // slots * item_size bytes
+    uint8_t          item_size;  // Bytes per item
+    uint8_t          slots;      // At most 255
+    volatile uint8_t head;       // Next slot to write, only changed by the producer
+    volatile uint8_t tail;       // Next slot to read, only changed by the consumer
+} ring_buffer_t;
+
+/* Fails the build if `cond` is false, and is 0 otherwise. _Static_assert is a
+ * declaration, so it is wrapped in a type to use it inside an initializer. */
+#ifdef __cplusplus
+#    define RING_BUFFER_ASSERT(cond, msg) ((void)[] { static_assert(cond, msg); }, 0)
+#else
+#    define RING_BUFFER_ASSERT(cond, msg) (0 * sizeof(struct { _Static_assert(cond, msg); char c; }))
+#endif
 
-#ifndef RBUF_SIZE
-#    define RBUF_SIZE 32
+#define RING_BUFFER_SLOTS(array) (sizeof(array) / sizeof((array)[0]))
+
+// Static initializer for a buffer backed by an array of at most 255 slots
+#define RING_BUFFER_INIT(array) \
+    { (uint8_t *)(array), sizeof((array)[0]), (uint8_t)(RING_BUFFER_SLOTS(array) + RING_BUFFER_ASSERT(RING_BUFFER_SLOTS(array) <= UINT8_MAX, "ring buffer arrays hold at most 255 slots")), 0, 0 }
+
+/* The item has to be in memory before the other side sees the index move, and
+ * read out before the slot is handed back. AVR executes in order on a single
+ * core, so only the compiler has to be kept from reordering. */
+#if defined(__AVR__)
+#    define RING_BUFFER_FENCE() __asm__ __volatile__("" ::: "memory")
+#else
+#    define RING_BUFFER_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
 #endif
 
-static uint8_t     rbuf[RBUF_SIZE];
-static uint8_t     rbuf_head = 0;
-static uint8_t     rbuf_tail = 0;
-static inline bool rbuf_enqueue(uint8_t data) {
-    bool ret = false;
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        uint8_t next = (rbuf_head + 1) % RBUF_SIZE;
-        if (next != rbuf_tail) {
-            rbuf[rbuf_head] = data;
-            rbuf_head       = next;
-            ret             = true;
-        }
+static inline void ring_buffer_init(ring_buffer_t *rb, void *data, uint8_t item_size, uint8_t slots) {
+    rb->data      = (uint8_t *)data;
+    rb->item_size = item_size;
+    rb->slots     = slots;
+    rb->head      = 0;
+    rb->tail      = 0;
+}
+
+static inline uint8_t ring_buffer_advance(const ring_buffer_t *rb, uint8_t index, uint8_t count) {
+    uint16_t next = index + count;
+    return next >= rb->slots ? next - rb->slots : next;
+}
+
+static inline uint8_t ring_buffer_count(const ring_buffer_t *rb) {
+    uint8_t head = rb->head;
+    uint8_t tail = rb->tail;
+    return head >= tail ? head - tail : rb->slots - tail + head;
+}
+
+static inline bool ring_buffer_empty(const ring_buffer_t *rb) { return rb->head == rb->tail; }
+
+static inline bool ring_buffer_full(const ring_buffer_t *rb) { return ring_buffer_advance(rb, rb->head, 1) == rb->tail; }
+
+// Number of items that can still be pushed
+static inline uint8_t ring_buffer_space(const ring_buffer_t *rb) { return rb->slots - 1 - ring_buffer_count(rb); }
+
+// Producer side. Returns false and drops the item if the buffer is full
+static inline bool ring_buffer_push(ring_buffer_t *rb, const void *item) {
+    uint8_t head = rb->head;
+    uint8_t next = ring_buffer_advance(rb, head, 1);
+    if (next == rb->tail) {
+        return false;
     }
-    return ret;
+
+    memcpy(&rb->data[head * rb->item_size], item, rb->item_size);
+    RING_BUFFER_FENCE();
+    rb->head = next;
+    return true;
 }
-static inline uint8_t rbuf_dequeue(void) {
-    uint8_t val = 0;
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        if (rbuf_head != rbuf_tail) {
-            val       = rbuf[rbuf_tail];
-            rbuf_tail = (rbuf_tail + 1) % RBUF_SIZE;
-        }
+
+// Consumer side. Copies the item `offset` places from the front without removing it
+static inline bool ring_buffer_peek_at(const ring_buffer_t *rb, uint8_t offset, void *item) {
+    if (offset >= ring_buffer_count(rb)) {
+        return false;
     }
 
-    return val;
+    RING_BUFFER_FENCE();
+    memcpy(item, &rb->data[ring_buffer_advance(rb, rb->tail, offset) * rb->item_size], rb->item_size);
+    return true;
 }
-static inline bool rbuf_has_data(void) {
-    bool has_data;
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { has_data = (rbuf_head != rbuf_tail); }
-    return has_data;
+
+static inline bool ring_buffer_peek(const ring_buffer_t *rb, void *item) { return ring_buffer_peek_at(rb, 0, item); }
+
+// Consumer side. Removes up to `count` items from the front
+static inline void ring_buffer_drop(ring_buffer_t *rb, uint8_t count) {
+    uint8_t available = ring_buffer_count(rb);
+    if (count > available) {
+        count = available;
+    }
+
+    RING_BUFFER_FENCE();
+    rb->tail = ring_buffer_advance(rb, rb->tail, count);
 }
-static inline void rbuf_clear(void) {
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { rbuf_head = rbuf_tail = 0; }
+
+// Consumer side
+static inline bool ring_buffer_pop(ring_buffer_t *rb, void *item) {
+    if (!ring_buffer_peek(rb, item)) {
+        return false;
+    }
+
+    ring_buffer_drop(rb, 1);
+    return true;
 }
+
+// Consumer side. Empties the buffer
+static inline void ring_buffer_clear(ring_buffer_t *rb) { rb->tail = rb->head; }
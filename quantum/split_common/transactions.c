@@ -80,12 +80,18 @@ static bool transaction_handler_master(matrix_row_t master_matrix[], matrix_row_
         ATOMIC_BLOCK_FORCEON { prefix##_handlers_slave(master_matrix, slave_matrix); }; \
     } while (0)
 
+#ifdef SPLIT_CHECKSUM_CRC16
+#    define split_checksum(data, length) crc16(data, length)
+#else
+#    define split_checksum(data, length) crc8(data, length)
+#endif
+
 inline static bool read_if_checksum_mismatch(int8_t trans_id_checksum, int8_t trans_id_retrieve, uint32_t *last_update, void *destination, const void *equiv_shmem, size_t length) {
-    uint8_t curr_checksum;
-    bool    okay = transport_read(trans_id_checksum, &curr_checksum, sizeof(curr_checksum));
-    if (okay && (timer_elapsed32(*last_update) >= FORCED_SYNC_THROTTLE_MS || curr_checksum != crc8(equiv_shmem, length))) {
+    split_checksum_t curr_checksum;
+    bool             okay = transport_read(trans_id_checksum, &curr_checksum, sizeof(curr_checksum));
+    if (okay && (timer_elapsed32(*last_update) >= FORCED_SYNC_THROTTLE_MS || curr_checksum != split_checksum(equiv_shmem, length))) {
         okay &= transport_read(trans_id_retrieve, destination, length);
-        okay &= curr_checksum == crc8(equiv_shmem, length);
+        okay &= curr_checksum == split_checksum(equiv_shmem, length);
         if (okay) {
             *last_update = timer_read32();
         }
@@ -131,7 +137,7 @@ static bool slave_matrix_handlers_master(matrix_row_t master_matrix[], matrix_ro
 
 static void slave_matrix_handlers_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) {
     memcpy(split_shmem->smatrix.matrix, slave_matrix, sizeof(split_shmem->smatrix.matrix));
-    split_shmem->smatrix.checksum = crc8(split_shmem->smatrix.matrix, sizeof(split_shmem->smatrix.matrix));
+    split_shmem->smatrix.checksum = split_checksum(split_shmem->smatrix.matrix, sizeof(split_shmem->smatrix.matrix));
 }
 
 // clang-format off
@@ -189,7 +195,7 @@ static void encoder_handlers_slave(matrix_row_t master_matrix[], matrix_row_t sl
     // Always prepare the encoder state for read.
     memcpy(split_shmem->encoders.state, encoder_state, sizeof(encoder_state));
     // Now update the checksum given that the encoders has been written to
-    split_shmem->encoders.checksum = crc8(encoder_state, sizeof(encoder_state));
+    split_shmem->encoders.checksum = split_checksum(encoder_state, sizeof(encoder_state));
 }
 
 // clang-format off
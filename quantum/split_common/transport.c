@@ -21,6 +21,7 @@
 #include "transport.h"
 #include "transaction_id_define.h"
 #include "atomic_util.h"
+#include "trace.h"
 
 #ifdef USE_I2C
 
@@ -55,7 +56,7 @@ i2c_status_t transport_trigger_callback(int8_t id) {
     return i2c_writeReg(SLAVE_I2C_ADDRESS, trans->initiator2target_offset, split_trans_initiator2target_buffer(trans), trans->initiator2target_buffer_size, SLAVE_I2C_TIMEOUT);
 }
 
-bool transport_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+static bool transport_execute(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
     i2c_status_t              status;
     split_transaction_desc_t *trans = &split_transaction_table[id];
     if (initiator2target_length > 0) {
@@ -92,7 +93,7 @@ split_shared_memory_t *const split_shmem = &shared_memory;
 void transport_master_init(void) { soft_serial_initiator_init(); }
 void transport_slave_init(void) { soft_serial_target_init(); }
 
-bool transport_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+static bool transport_execute(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
     split_transaction_desc_t *trans = &split_transaction_table[id];
     if (initiator2target_length > 0) {
         size_t len = trans->initiator2target_buffer_size < initiator2target_length ? trans->initiator2target_buffer_size : initiator2target_length;
@@ -113,6 +114,12 @@ bool transport_execute_transaction(int8_t id, const void *initiator2target_buf,
 
 #endif  // USE_I2C
 
+bool transport_execute_transaction(int8_t id, const void *initiator2target_buf, uint16_t initiator2target_length, void *target2initiator_buf, uint16_t target2initiator_length) {
+    bool okay = transport_execute(id, initiator2target_buf, initiator2target_length, target2initiator_buf, target2initiator_length);
+    trace_event(TRACE_SPLIT_TRANSACTION, id, okay, (uint8_t)initiator2target_length << 8 | (uint8_t)target2initiator_length);
+    return okay;
+}
+
 bool transport_master(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) { return transactions_master(master_matrix, slave_matrix); }
 
 void transport_slave(matrix_row_t master_matrix[], matrix_row_t slave_matrix[]) { transactions_slave(master_matrix, slave_matrix); }
@@ -53,8 +53,14 @@ bool transport_execute_transaction(int8_t id, const void *initiator2target_buf,
 #    include "rgblight.h"
 #endif  // RGBLIGHT_ENABLE
 
+#ifdef SPLIT_CHECKSUM_CRC16
+typedef uint16_t split_checksum_t;
+#else
+typedef uint8_t split_checksum_t;
+#endif
+
 typedef struct _split_slave_matrix_sync_t {
-    uint8_t      checksum;
+    split_checksum_t checksum;
     matrix_row_t matrix[(MATRIX_ROWS) / 2];
 } split_slave_matrix_sync_t;
 
@@ -66,8 +72,8 @@ typedef struct _split_master_matrix_sync_t {
 
 #ifdef ENCODER_ENABLE
 typedef struct _split_slave_encoder_sync_t {
-    uint8_t checksum;
-    uint8_t state[NUMBER_OF_ENCODERS];
+    split_checksum_t checksum;
+    uint8_t          state[NUMBER_OF_ENCODERS];
 } split_slave_encoder_sync_t;
 #endif  // ENCODER_ENABLE
 
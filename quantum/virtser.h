@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 void virtser_init(void);
 
 /* Define this function in your code to process incoming bytes */
@@ -7,3 +9,6 @@ void virtser_recv(const uint8_t ch);
 
 /* Call this to send a character over the Virtual Serial Device */
 void virtser_send(const uint8_t byte);
+
+/* Queue up to length bytes without waiting for the endpoint, returns the number of bytes accepted */
+uint8_t virtser_write(const uint8_t *data, uint8_t length);
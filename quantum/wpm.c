@@ -17,42 +17,60 @@
 
 #include "wpm.h"
 
-#include <math.h>
+#include <string.h>
 
-// WPM Stuff
-static uint8_t  current_wpm = 0;
-static uint32_t wpm_timer   = 0;
-#ifndef WPM_UNFILTERED
-static uint32_t smoothing_timer = 0;
-#endif
-
-/* The WPM calculation works by specifying a certain number of 'periods' inside
- * a ring buffer, and we count the number of keypresses which occur in each of
- * those periods.  Then to calculate WPM, we add up all of the keypresses in
- * the whole ring buffer, divide by the number of keypresses in a 'word', and
- * then adjust for how much time is captured by our ring buffer.  Right now
- * the ring buffer is hardcoded below to be six half-second periods, accounting
- * for a total WPM sampling period of up to three seconds of typing.
+/* The WPM calculation works by splitting the sampling window into a number of
+ * equally sized periods inside a ring buffer, and counting the keypresses
+ * which occur in each of those periods.  The sum over the whole window (and
+ * over the most recent burst periods) is kept up to date incrementally, so
+ * both recording a keypress and rolling over to the next period are O(1).
+ *
+ * The WPM value is only recalculated when a period ends, which keeps the
+ * division out of the scan loop and means the value (and the split transport
+ * sync) only changes at most once per period.
+ *
+ * Once typing stops, the windowed value drops as the periods with presses
+ * leave the window.  The filtered value does not follow it in a straight
+ * line: every period it closes a quarter of the remaining gap, so it decays
+ * geometrically and lags the windowed value by a few periods.
  *
  * Whenever our WPM drops to absolute zero due to no typing occurring within
- * any contiguous three seconds, we reset and start measuring fresh,
- * which lets our WPM immediately reach the correct value even before a full
- * three second sampling buffer has been filled.
+ * the whole window, launch control resets the number of filled periods, which
+ * lets our WPM immediately reach the correct value even before the full
+ * sampling window has been filled.
  */
 #define MAX_PERIODS (WPM_SAMPLE_PERIODS)
 #define PERIOD_DURATION (1000 * WPM_SAMPLE_SECONDS / MAX_PERIODS)
-#define LATENCY (100)
+
+#if MAX_PERIODS > 255
+#    error "WPM_SAMPLE_PERIODS cannot be larger than 255"
+#endif
+#if WPM_BURST_PERIODS >= MAX_PERIODS || WPM_BURST_PERIODS < 1
+#    error "WPM_BURST_PERIODS must be between 1 and WPM_SAMPLE_PERIODS - 1"
+#endif
+
+/* WPM for a given number of presses over `periods` periods is presses * 60000 / (word size * duration) */
+#define WPM_SCALE(periods) ((uint32_t)60000 * 256 / ((uint32_t)WPM_ESTIMATED_WORD_SIZE * (periods)*PERIOD_DURATION))
+
+static uint8_t  current_wpm = 0;
+static uint8_t  burst_wpm   = 0;
+static uint8_t  peak_wpm    = 0;
+static uint16_t wpm_timer   = 0;
+#ifndef WPM_UNFILTERED
+static uint16_t filtered_wpm = 0; /* Q8 */
+#endif
+
 static int8_t  period_presses[MAX_PERIODS] = {0};
 static uint8_t current_period              = 0;
 static uint8_t periods                     = 1;
-
-#if !defined(WPM_UNFILTERED)
-static uint8_t prev_wpm = 0;
-static uint8_t next_wpm = 0;
-#endif
+static int16_t window_presses              = 0; /* sum over the whole ring buffer */
+static int16_t burst_presses               = 0; /* sum over the last WPM_BURST_PERIODS periods */
 
 void    set_current_wpm(uint8_t new_wpm) { current_wpm = new_wpm; }
 uint8_t get_current_wpm(void) { return current_wpm; }
+uint8_t get_burst_wpm(void) { return burst_wpm; }
+uint8_t get_peak_wpm(void) { return peak_wpm; }
+void    reset_peak_wpm(void) { peak_wpm = current_wpm; }
 
 bool wpm_keycode(uint16_t keycode) { return wpm_keycode_kb(keycode); }
 
@@ -92,65 +110,108 @@ __attribute__((weak)) uint8_t wpm_regress_count(uint16_t keycode) {
 }
 #endif
 
-// Outside 'raw' mode we smooth results over time.
+static void add_presses(int8_t count) {
+    int16_t presses = period_presses[current_period] + count;
+    if (presses > INT8_MAX) {
+        presses = INT8_MAX;
+    } else if (presses < INT8_MIN) {
+        presses = INT8_MIN;
+    }
+    count = presses - period_presses[current_period];
+    period_presses[current_period] += count;
+    window_presses += count;
+    burst_presses += count;
+}
 
 void update_wpm(uint16_t keycode) {
     if (wpm_keycode(keycode)) {
-        period_presses[current_period]++;
+        add_presses(1);
     }
 #ifdef WPM_ALLOW_COUNT_REGRESSION
     uint8_t regress = wpm_regress_count(keycode);
     if (regress) {
-        period_presses[current_period]--;
+        add_presses(-(int8_t)regress);
     }
 #endif
 }
 
-void decay_wpm(void) {
-    int32_t presses = period_presses[0];
-    for (int i = 1; i <= periods; i++) {
-        presses += period_presses[i];
+static uint8_t presses_to_wpm(int16_t presses, uint8_t over_periods) {
+    // don't guess high WPM based on a single keypress.
+    if (presses < 2) {
+        return 0;
     }
-    if (presses < 0) {
-        presses = 0;
+    uint32_t wpm;
+    if (over_periods == MAX_PERIODS - 1) {
+        wpm = ((uint32_t)presses * WPM_SCALE(MAX_PERIODS - 1)) >> 8;
+    } else {
+        wpm = ((uint32_t)presses * 60000) / ((uint32_t)WPM_ESTIMATED_WORD_SIZE * over_periods * PERIOD_DURATION);
     }
-    int32_t  elapsed  = timer_elapsed32(wpm_timer);
-    uint32_t duration = (((periods)*PERIOD_DURATION) + elapsed);
-    uint32_t wpm_now  = (60000 * presses) / (duration * WPM_ESTIMATED_WORD_SIZE);
-    wpm_now           = (wpm_now > 240) ? 240 : wpm_now;
-
-    if (elapsed > PERIOD_DURATION) {
-        current_period                 = (current_period + 1) % MAX_PERIODS;
-        period_presses[current_period] = 0;
-        periods                        = (periods < MAX_PERIODS - 1) ? periods + 1 : MAX_PERIODS - 1;
-        elapsed                        = 0;
-        /* if (wpm_timer == 0) { */
-        wpm_timer = timer_read32();
-        /* } else { */
-        /*     wpm_timer += PERIOD_DURATION; */
-        /* } */
+    return wpm > 240 ? 240 : wpm;
+}
+
+static void next_period(void) {
+    current_period = (current_period + 1) % MAX_PERIODS;
+    uint8_t burst_tail = (current_period + MAX_PERIODS - WPM_BURST_PERIODS - 1) % MAX_PERIODS;
+
+    burst_presses -= period_presses[burst_tail];
+    window_presses -= period_presses[current_period];
+    period_presses[current_period] = 0;
+    if (periods < MAX_PERIODS) {
+        periods++;
     }
-    if (presses < 2)  // don't guess high WPM based on a single keypress.
-        wpm_now = 0;
 
 #if defined WPM_LAUNCH_CONTROL
-    if (presses == 0) {
-        current_period = 0;
-        periods        = 0;
-        wpm_now        = 0;
+    if (window_presses <= 0) {
+        periods = 1;
     }
 #endif  // WPM_LAUNCH_CONTROL
+}
+
+static void calculate_wpm(void) {
+    // the period that has just started is still empty, so only count the finished ones
+    uint8_t finished = periods > 1 ? periods - 1 : 1;
+    uint8_t wpm_now  = presses_to_wpm(window_presses, finished);
+
+    burst_wpm = presses_to_wpm(burst_presses, finished < WPM_BURST_PERIODS ? finished : WPM_BURST_PERIODS);
 
 #ifndef WPM_UNFILTERED
-    int32_t latency = timer_elapsed32(smoothing_timer);
-    if (latency > LATENCY) {
-        smoothing_timer = timer_read32();
-        prev_wpm        = current_wpm;
-        next_wpm        = wpm_now;
+    // exponential moving average with a weight of 1/4 per period
+    int32_t delta = ((int32_t)wpm_now << 8) - filtered_wpm;
+    filtered_wpm += delta / 4;
+    current_wpm = (filtered_wpm + 128) >> 8;
+#else
+    current_wpm = wpm_now;
+#endif
+    if (current_wpm > peak_wpm) {
+        peak_wpm = current_wpm;
     }
+}
 
-    current_wpm = prev_wpm + (latency * ((int)next_wpm - (int)prev_wpm) / LATENCY);
+void decay_wpm(void) {
+    uint16_t elapsed = timer_elapsed(wpm_timer);
+    if (elapsed < PERIOD_DURATION) {
+        return;
+    }
+
+    if (elapsed >= (uint32_t)MAX_PERIODS * PERIOD_DURATION) {
+        // nothing has been recorded for a whole window, start over
+        memset(period_presses, 0, sizeof(period_presses));
+        window_presses = 0;
+        burst_presses  = 0;
+#if defined WPM_LAUNCH_CONTROL
+        periods = 1;
 #else
-    current_wpm = wpm_now;
+        periods = MAX_PERIODS;
 #endif
+        wpm_timer = timer_read();
+    } else {
+        // catch up on every period that has passed, without drifting
+        while (elapsed >= PERIOD_DURATION) {
+            next_period();
+            elapsed -= PERIOD_DURATION;
+            wpm_timer += PERIOD_DURATION;
+        }
+    }
+
+    calculate_wpm();
 }
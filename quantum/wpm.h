@@ -28,6 +28,9 @@
 #ifndef WPM_SAMPLE_PERIODS
 #    define WPM_SAMPLE_PERIODS 50
 #endif
+#ifndef WPM_BURST_PERIODS
+#    define WPM_BURST_PERIODS 10
+#endif
 
 bool wpm_keycode(uint16_t keycode);
 bool wpm_keycode_kb(uint16_t keycode);
@@ -39,6 +42,9 @@ uint8_t wpm_regress_count(uint16_t keycode);
 
 void    set_current_wpm(uint8_t);
 uint8_t get_current_wpm(void);
+uint8_t get_burst_wpm(void);
+uint8_t get_peak_wpm(void);
+void    reset_peak_wpm(void);
 void    update_wpm(uint16_t);
 
 void decay_wpm(void);
@@ -0,0 +1,171 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "deferred_exec.h"
+#include "eeconfig.h"
+#include "eeprom.h"
+#include "process_dynamic_macro.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::AtLeast;
+using testing::InSequence;
+
+class DynamicMacro : public TestFixture {
+   protected:
+    KeymapKey key_rec1  = KeymapKey(0, 0, 0, DYN_REC_START1);
+    KeymapKey key_stop  = KeymapKey(0, 1, 0, DYN_REC_STOP);
+    KeymapKey key_play1 = KeymapKey(0, 2, 0, DYN_MACRO_PLAY1);
+    KeymapKey key_a     = KeymapKey(0, 3, 0, KC_A);
+    KeymapKey key_b     = KeymapKey(0, 4, 0, KC_B);
+    KeymapKey key_c     = KeymapKey(0, 5, 0, KC_C);
+
+    void SetUp() override { set_keymap({key_rec1, key_stop, key_play1, key_a, key_b, key_c}); }
+
+    /* Playback runs from the deferred executor, which the main loop runs next to the keyboard task */
+    void run(unsigned ms) {
+        for (unsigned i = 0; i < ms; i++) {
+            run_one_scan_loop();
+            deferred_exec_task();
+        }
+    }
+
+    void tap(KeymapKey &key) {
+        key.press();
+        run(1);
+        key.release();
+        run(1);
+    }
+
+    void record(std::vector<KeymapKey *> keys, unsigned pause) {
+        TestDriver driver;
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        tap(key_rec1);
+        for (auto key : keys) {
+            tap(*key);
+            run(pause);
+        }
+        tap(key_stop);
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+};
+
+TEST_F(DynamicMacro, PlaybackKeepsRecordedTiming) {
+    record({&key_a, &key_b}, 100);
+
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap(key_play1);
+    run(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The keyboard keeps scanning while the macro waits for the next event
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    run(100);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, CompactEncodingHoldsMoreThanBufferSize) {
+    std::vector<KeymapKey *> keys;
+    for (int i = 0; i < DYNAMIC_MACRO_SIZE; i++) {
+        keys.push_back(i % 2 ? &key_b : &key_a);
+    }
+    // Twice as many events as would fit as keyrecord_t structs
+    record(keys, 0);
+
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    for (auto key : keys) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key->report_code)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    }
+    tap(key_play1);
+    run(100);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, KeysPressedDuringPlaybackStayPressed) {
+    record({&key_a, &key_b}, 100);
+
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    tap(key_play1);
+    run(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The end of the playback only releases the keys of the macro
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(0);
+    key_c.press();
+    run(150);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_c.release();
+    run(1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(DynamicMacro, RecordingIsSavedToEeprom) {
+    record({&key_a}, 0);
+
+    const uint8_t *header = (const uint8_t *)EECONFIG_SIZE;
+
+    EXPECT_EQ(eeprom_read_word((const uint16_t *)(header + 1)), DYNAMIC_MACRO_SIZE * sizeof(keyrecord_t));
+    // Delay and key for the press and the release of A
+    EXPECT_EQ(eeprom_read_word((const uint16_t *)(header + 3)), 4);
+    EXPECT_EQ(eeprom_read_byte(header + 7), 0x00);
+    EXPECT_EQ(eeprom_read_byte(header + 8), 0x80 | 3);
+    EXPECT_LT(eeprom_read_byte(header + 9), 0x80);
+    EXPECT_EQ(eeprom_read_byte(header + 10), 3);
+}
+
+TEST_F(DynamicMacro, RecordingOnErasedEepromIsRestored) {
+    const uint8_t *header = (const uint8_t *)EECONFIG_SIZE;
+    for (unsigned i = 0; i < 7 + DYNAMIC_MACRO_SIZE * sizeof(keyrecord_t); i++) {
+        eeprom_write_byte((uint8_t *)header + i, 0xFF);
+    }
+    dynamic_macro_init();
+
+    record({&key_a}, 0);
+    // Restart
+    dynamic_macro_init();
+
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    tap(key_play1);
+    run(10);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,224 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "process_key_override.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+static std::vector<uintptr_t> activations;
+
+static bool record_activation(bool activated, void *context) {
+    if (activated) {
+        activations.push_back(reinterpret_cast<uintptr_t>(context));
+    }
+    return true;
+}
+
+static key_override_t make_override(uintptr_t id, uint16_t trigger, uint8_t trigger_mods, uint16_t replacement, layer_state_t layers = ~0, ko_option_t options = ko_options_default) {
+    key_override_t override = {};
+
+    override.trigger         = trigger;
+    override.trigger_mods    = trigger_mods;
+    override.layers          = layers;
+    override.suppressed_mods = trigger_mods;
+    override.replacement     = replacement;
+    override.options         = options;
+    override.custom_action   = record_activation;
+    override.context         = reinterpret_cast<void *>(id);
+
+    return override;
+}
+
+// clang-format off
+static const key_override_t overrides[] = {
+    make_override(1, KC_BSPC, MOD_MASK_SHIFT, KC_DEL),
+    make_override(2, KC_A, MOD_MASK_CTRL, KC_X),
+    make_override(3, KC_A, MOD_MASK_SHIFT, KC_Y),
+    make_override(4, KC_B, MOD_BIT(KC_LSFT), KC_Z),
+    make_override(5, KC_NO, MOD_MASK_GUI, KC_MUTE),
+    make_override(6, KC_D, MOD_MASK_ALT, KC_1),
+    make_override(7, KC_NO, MOD_MASK_ALT, KC_2, ~0, ko_option_activation_trigger_down),
+    make_override(8, KC_E, MOD_MASK_CTRL, KC_3, 1 << 1),
+};
+// clang-format on
+
+// Never activate, only there to push the table past KEY_OVERRIDE_INDEX_SIZE
+static const key_override_t unused_override = make_override(99, KC_F24, MOD_MASK_CSAG, KC_NO, 0);
+
+static const key_override_t *indexed_table[] = {&overrides[0], &overrides[1], &overrides[2], &overrides[3], &overrides[4], &overrides[5], &overrides[6], &overrides[7], NULL};
+
+static const key_override_t *linear_table[] = {
+    &overrides[0], &overrides[1], &overrides[2], &overrides[3], &overrides[4], &overrides[5], &overrides[6], &overrides[7],
+    &unused_override, &unused_override, &unused_override, &unused_override, &unused_override, &unused_override, &unused_override, &unused_override, &unused_override, &unused_override,
+    NULL,
+};
+
+// Runs every test against an indexed and a linearly searched table to prove both select the same overrides
+class KeyOverride : public TestFixture, public testing::WithParamInterface<bool> {
+   protected:
+    TestDriver driver;
+
+    void SetUp() override {
+        key_overrides = GetParam() ? linear_table : indexed_table;
+        activations.clear();
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        EXPECT_CALL(driver, send_consumer_mock(_)).Times(AnyNumber());
+    }
+
+    void TearDown() override {
+        key_overrides = NULL;
+    }
+
+    void tap_key(KeymapKey &key) {
+        key.press();
+        run_one_scan_loop();
+        key.release();
+        run_one_scan_loop();
+    }
+};
+
+TEST_P(KeyOverride, TriggerPressedWithModifier) {
+    auto key_shift = KeymapKey(0, 0, 0, KC_LSFT);
+    auto key_bspc  = KeymapKey(0, 1, 0, KC_BSPC);
+
+    set_keymap({key_shift, key_bspc});
+
+    tap_key(key_bspc);
+    EXPECT_TRUE(activations.empty());
+
+    key_shift.press();
+    run_one_scan_loop();
+    tap_key(key_bspc);
+    key_shift.release();
+    run_one_scan_loop();
+
+    EXPECT_EQ(activations, std::vector<uintptr_t>({1}));
+}
+
+TEST_P(KeyOverride, FirstMatchingOverrideWins) {
+    auto key_shift = KeymapKey(0, 0, 0, KC_LSFT);
+    auto key_ctrl  = KeymapKey(0, 1, 0, KC_LCTL);
+    auto key_a     = KeymapKey(0, 2, 0, KC_A);
+
+    set_keymap({key_shift, key_ctrl, key_a});
+
+    key_shift.press();
+    run_one_scan_loop();
+    tap_key(key_a);
+
+    key_ctrl.press();
+    run_one_scan_loop();
+    tap_key(key_a);
+
+    key_shift.release();
+    run_one_scan_loop();
+    key_ctrl.release();
+    run_one_scan_loop();
+
+    EXPECT_EQ(activations, std::vector<uintptr_t>({3, 2}));
+}
+
+TEST_P(KeyOverride, ModifierPressedWhileTriggerHeld) {
+    auto key_shift  = KeymapKey(0, 0, 0, KC_LSFT);
+    auto key_rshift = KeymapKey(0, 1, 0, KC_RSFT);
+    auto key_b      = KeymapKey(0, 2, 0, KC_B);
+
+    set_keymap({key_shift, key_rshift, key_b});
+
+    key_b.press();
+    run_one_scan_loop();
+
+    // Only the left shift is a trigger modifier
+    key_rshift.press();
+    run_one_scan_loop();
+    key_rshift.release();
+    run_one_scan_loop();
+    EXPECT_TRUE(activations.empty());
+
+    key_shift.press();
+    run_one_scan_loop();
+    key_shift.release();
+    run_one_scan_loop();
+    key_b.release();
+    run_one_scan_loop();
+
+    EXPECT_EQ(activations, std::vector<uintptr_t>({4}));
+}
+
+TEST_P(KeyOverride, ModifierOnlyOverride) {
+    auto key_gui = KeymapKey(0, 0, 0, KC_LGUI);
+
+    set_keymap({key_gui});
+
+    key_gui.press();
+    run_one_scan_loop();
+    key_gui.release();
+    run_one_scan_loop();
+
+    EXPECT_EQ(activations, std::vector<uintptr_t>({5}));
+}
+
+TEST_P(KeyOverride, TriggerAndModifierOnlyOverridesKeepArrayOrder) {
+    auto key_alt = KeymapKey(0, 0, 0, KC_LALT);
+    auto key_d   = KeymapKey(0, 1, 0, KC_D);
+    auto key_f   = KeymapKey(0, 2, 0, KC_F);
+
+    set_keymap({key_alt, key_d, key_f});
+
+    key_alt.press();
+    run_one_scan_loop();
+    tap_key(key_d);
+    tap_key(key_f);
+    key_alt.release();
+    run_one_scan_loop();
+
+    EXPECT_EQ(activations, std::vector<uintptr_t>({6, 7}));
+}
+
+TEST_P(KeyOverride, LayerRestrictedOverride) {
+    auto key_ctrl = KeymapKey(0, 0, 0, KC_LCTL);
+    auto key_e    = KeymapKey(0, 1, 0, KC_E);
+    auto key_mo   = KeymapKey(0, 2, 0, MO(1));
+    auto key_e_1  = KeymapKey(1, 1, 0, KC_E);
+
+    set_keymap({key_ctrl, key_e, key_mo, key_e_1});
+
+    key_ctrl.press();
+    run_one_scan_loop();
+    tap_key(key_e);
+    EXPECT_TRUE(activations.empty());
+
+    key_mo.press();
+    run_one_scan_loop();
+    tap_key(key_e_1);
+    key_mo.release();
+    run_one_scan_loop();
+    key_ctrl.release();
+    run_one_scan_loop();
+
+    EXPECT_EQ(activations, std::vector<uintptr_t>({8}));
+}
+
+INSTANTIATE_TEST_CASE_P(IndexedAndLinear, KeyOverride, testing::Bool());
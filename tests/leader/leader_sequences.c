@@ -0,0 +1,48 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+static void tap_1(void) { tap_code(KC_1); }
+static void tap_2(void) { tap_code(KC_2); }
+static void tap_3(void) { tap_code(KC_3); }
+static void tap_4(void) { tap_code(KC_4); }
+
+const uint16_t PROGMEM leader_a[]    = {KC_A, LEADER_END};
+const uint16_t PROGMEM leader_b[]    = {KC_B, LEADER_END};
+const uint16_t PROGMEM leader_b_c[]  = {KC_B, KC_C, LEADER_END};
+const uint16_t PROGMEM leader_long[] = {KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, LEADER_END};
+
+// Deliberately not in sorted order
+const leader_sequence_t leader_sequences[] = {
+    LEADER_SEQUENCE(leader_long, tap_4),
+    LEADER_SEQUENCE(leader_b_c, tap_2),
+    LEADER_SEQUENCE(leader_a, tap_1),
+    LEADER_SEQUENCE(leader_b, tap_3),
+    LEADER_SEQUENCES_END,
+};
+
+LEADER_EXTERNS();
+
+// A keymap dictionary next to the table, which ends every sequence
+void matrix_scan_user(void) {
+    LEADER_DICTIONARY() {
+        leading = false;
+        leader_end();
+
+        SEQ_ONE_KEY(KC_C) { tap_code(KC_5); }
+    }
+}
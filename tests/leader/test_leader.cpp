@@ -0,0 +1,149 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+class Leader : public TestFixture {
+   protected:
+    std::vector<KeymapKey> keys = {
+        KeymapKey(0, 0, 0, KC_LEAD),
+        KeymapKey(0, 1, 0, KC_A),
+        KeymapKey(0, 2, 0, KC_B),
+        KeymapKey(0, 3, 0, KC_C),
+        KeymapKey(0, 4, 0, KC_D),
+        KeymapKey(0, 5, 0, KC_E),
+        KeymapKey(0, 6, 0, KC_F),
+        KeymapKey(0, 7, 0, KC_G),
+        KeymapKey(0, 8, 0, KC_H),
+        KeymapKey(0, 9, 0, KC_I),
+        KeymapKey(0, 0, 1, KC_Z),
+    };
+
+    void SetUp() override {
+        for (auto &key : keys) {
+            add_key(key);
+        }
+    }
+
+    void tap(uint16_t keycode) {
+        for (auto &key : keys) {
+            if (key.code == keycode) {
+                key.press();
+                run_one_scan_loop();
+                key.release();
+                run_one_scan_loop();
+            }
+        }
+    }
+
+    void tap_sequence(std::vector<uint16_t> sequence) {
+        for (auto keycode : sequence) {
+            tap(keycode);
+        }
+    }
+};
+
+TEST_F(Leader, UnambiguousSequenceFiresImmediately) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_1)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_sequence({KC_LEAD, KC_A});
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The sequence is over, keys are typed normally again
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap(KC_A);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Leader, PrefixOfLongerSequenceWaitsForTimeout) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_sequence({KC_LEAD, KC_B});
+    idle_for(LEADER_TIMEOUT - 10);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_3)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    idle_for(20);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Leader, LongerSequenceFiresWithoutTimeout) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_2)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_sequence({KC_LEAD, KC_B, KC_C});
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Leader, SequenceLongerThanFiveKeys) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_4)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_sequence({KC_LEAD, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I});
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Leader, DictionaryHandlesSequencesNotInTable) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_sequence({KC_LEAD, KC_C});
+    idle_for(LEADER_TIMEOUT - 10);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_5)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    idle_for(20);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Leader, UnknownSequenceEndsAtTimeout) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_sequence({KC_LEAD, KC_Z, KC_A});
+    idle_for(LEADER_TIMEOUT);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap(KC_A);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
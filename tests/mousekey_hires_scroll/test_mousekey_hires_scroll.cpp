@@ -0,0 +1,79 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "host.h"
+#include "mousekey.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+
+class MousekeyHiresScroll : public TestFixture {
+   protected:
+    KeymapKey wheel_up   = KeymapKey(0, 0, 0, KC_MS_WH_UP);
+    KeymapKey wheel_left = KeymapKey(0, 1, 0, KC_MS_WH_LEFT);
+
+    void SetUp() override {
+        set_keymap({wheel_up, wheel_left});
+        mousekey_clear();
+        host_mouse_resolution_reset();
+    }
+
+    void TearDown() override { host_mouse_resolution_reset(); }
+
+    /* Taps a key and returns the first report that scrolled */
+    report_mouse_t tap(KeymapKey& key) {
+        TestDriver     driver;
+        report_mouse_t scrolled = {};
+        EXPECT_CALL(driver, send_mouse_mock(_)).Times(AnyNumber()).WillRepeatedly(Invoke([&](report_mouse_t& report) {
+            if (!scrolled.v && !scrolled.h) scrolled = report;
+        }));
+        key.press();
+        run_one_scan_loop();
+        key.release();
+        run_one_scan_loop();
+        testing::Mock::VerifyAndClearExpectations(&driver);
+        return scrolled;
+    }
+};
+
+TEST_F(MousekeyHiresScroll, ScrollsWholeDetentsUntilTheHostEnablesTheMultiplier) {
+    EXPECT_EQ(host_mouse_wheel_multiplier(MOUSE_RESOLUTION_MULTIPLIER_V), 1);
+    EXPECT_EQ(tap(wheel_up).v, 1);
+}
+
+TEST_F(MousekeyHiresScroll, ScalesTheWheelOnceTheHostEnablesTheMultiplier) {
+    mouse_resolution_report.multipliers = MOUSE_RESOLUTION_MULTIPLIER_V;
+
+    EXPECT_EQ(tap(wheel_up).v, POINTING_DEVICE_HIRES_SCROLL_MULTIPLIER);
+    // Every axis is enabled on its own
+    EXPECT_EQ(tap(wheel_left).h, -1);
+}
+
+TEST_F(MousekeyHiresScroll, ResetDisablesTheMultiplier) {
+    mouse_resolution_report.multipliers = MOUSE_RESOLUTION_MULTIPLIER_V | MOUSE_RESOLUTION_MULTIPLIER_H;
+    EXPECT_EQ(tap(wheel_left).h, -POINTING_DEVICE_HIRES_SCROLL_MULTIPLIER);
+
+    host_mouse_resolution_reset();
+    EXPECT_EQ(tap(wheel_up).v, 1);
+}
@@ -0,0 +1,149 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <vector>
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "mousekey.h"
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::Invoke;
+
+struct MouseEvent {
+    unsigned   time;
+    KeymapKey* key;
+    bool       pressed;
+};
+
+struct MousePosition {
+    int32_t x, y, v, h;
+
+    bool operator==(const MousePosition& other) const { return x == other.x && y == other.y && v == other.v && h == other.h; }
+};
+
+std::ostream& operator<<(std::ostream& os, const MousePosition& pos) { return os << "(" << pos.x << ", " << pos.y << ", " << pos.v << ", " << pos.h << ")"; }
+
+class MousekeyInertia : public TestFixture {
+   protected:
+    KeymapKey right    = KeymapKey(0, 0, 0, KC_MS_RIGHT);
+    KeymapKey down     = KeymapKey(0, 1, 0, KC_MS_DOWN);
+    KeymapKey wheel_up = KeymapKey(0, 2, 0, KC_MS_WH_UP);
+
+    void SetUp() override { set_keymap({right, down, wheel_up}); }
+
+    /* Plays the events back while running the keyboard task every `interval` ms,
+     * and returns the accumulated position at every 10 ms boundary. */
+    std::vector<MousePosition> simulate(const std::vector<MouseEvent>& events, unsigned duration, unsigned interval) {
+        TestDriver    driver;
+        MousePosition position = {};
+
+        mousekey_clear();
+        EXPECT_CALL(driver, send_mouse_mock(_)).Times(AnyNumber()).WillRepeatedly(Invoke([&](report_mouse_t& report) {
+            position.x += report.x;
+            position.y += report.y;
+            position.v += report.v;
+            position.h += report.h;
+        }));
+
+        std::vector<MousePosition> trajectory;
+        for (unsigned time = 0; time < duration; time += interval) {
+            for (auto& event : events) {
+                if (event.time == time) {
+                    event.pressed ? event.key->press() : event.key->release();
+                }
+            }
+            keyboard_task();
+            if (time % 10 == 0) {
+                trajectory.push_back(position);
+            }
+            advance_time(interval);
+        }
+        testing::Mock::VerifyAndClearExpectations(&driver);
+        return trajectory;
+    }
+};
+
+TEST_F(MousekeyInertia, TrajectoryIsIndependentOfTaskRate) {
+    std::vector<MouseEvent> events = {
+        {0, &right, true}, {300, &down, true}, {700, &wheel_up, true}, {900, &right, false}, {1200, &down, false}, {1250, &wheel_up, false},
+    };
+
+    auto slow = simulate(events, 1500, 10);
+    auto fast = simulate(events, 1500, 1);
+
+    EXPECT_NE(fast.back().x, 0);
+    EXPECT_NE(fast.back().y, 0);
+    EXPECT_NE(fast.back().v, 0);
+    ASSERT_EQ(slow.size(), fast.size());
+    for (size_t i = 0; i < slow.size(); i++) {
+        EXPECT_EQ(slow[i], fast[i]) << "at " << i * 10 << " ms";
+    }
+}
+
+TEST_F(MousekeyInertia, AcceleratesToMaximumSpeed) {
+    std::vector<MouseEvent> events = {{0, &right, true}, {2000, &right, false}};
+
+    auto trajectory = simulate(events, 2000, 1);
+
+    /* 1 unit on press, ramp from 100 to 1000 px/s over the first second, then full speed */
+    int32_t after_ramp = trajectory[100].x;
+    EXPECT_NEAR(after_ramp, 1 + 550, 5);
+    EXPECT_NEAR(trajectory[199].x - after_ramp, 990, 5);
+    EXPECT_EQ(trajectory.back().y, 0);
+}
+
+TEST_F(MousekeyInertia, GlidesToAStopAfterRelease) {
+    std::vector<MouseEvent> events = {{0, &right, true}, {1500, &right, false}};
+
+    auto trajectory = simulate(events, 2000, 1);
+
+    /* decelerating from 1000 px/s to rest over 100 ms covers about 50 px */
+    int32_t at_release = trajectory[150].x;
+    EXPECT_NEAR(trajectory[160].x - at_release, 50, 2);
+    EXPECT_EQ(trajectory[160].x, trajectory.back().x);
+}
+
+TEST_F(MousekeyInertia, LongStallDoesNotReverseTheCursor) {
+    TestDriver driver;
+    int32_t    x = 0;
+
+    mousekey_clear();
+    EXPECT_CALL(driver, send_mouse_mock(_)).Times(AnyNumber()).WillRepeatedly(Invoke([&](report_mouse_t& report) {
+        EXPECT_GE(report.x, 0);
+        x += report.x;
+    }));
+
+    right.press();
+    for (int i = 0; i < 1000; i++) {
+        keyboard_task();
+        advance_time(1);
+    }
+    /* three seconds at full speed without a task would be 3000 px */
+    advance_time(3000);
+    keyboard_task();
+    right.release();
+    keyboard_task();
+
+    EXPECT_GT(x, 0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
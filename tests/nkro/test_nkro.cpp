@@ -0,0 +1,232 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "action_util.h"
+#include "bitwise.h"
+#include "host.h"
+#include "keycode_config.h"
+#include "report.h"
+
+uint8_t keyboard_protocol = 1;
+}
+
+using testing::_;
+using testing::InSequence;
+
+/* The byte-wise implementations the word-wise ones replaced */
+static uint8_t reference_bitpop32(uint32_t bits) {
+    uint8_t c;
+    for (c = 0; bits; c++) bits &= bits - 1;
+    return c;
+}
+
+static uint8_t reference_biton32(uint32_t bits) {
+    uint8_t n = 0;
+    while (bits >>= 1) n++;
+    return n;
+}
+
+static uint8_t reference_nkro_keys(report_keyboard_t *report) {
+    uint8_t cnt = 0;
+    for (uint16_t key = 0; key < KEYBOARD_REPORT_BITS * 8; key++) {
+        if (report->nkro.bits[key >> 3] & 1 << (key & 7)) cnt++;
+    }
+    return cnt;
+}
+
+static uint8_t reference_get_first_key(report_keyboard_t *report) {
+    uint8_t i = 0;
+    for (; i < KEYBOARD_REPORT_BITS && !report->nkro.bits[i]; i++)
+        ;
+    return i << 3 | biton(report->nkro.bits[i]);
+}
+
+static bool reference_is_key_pressed(report_keyboard_t *report, uint8_t key) {
+    if (key == KC_NO || (key >> 3) >= KEYBOARD_REPORT_BITS) return false;
+    return report->nkro.bits[key >> 3] & 1 << (key & 7);
+}
+
+class Nkro : public TestFixture {
+   protected:
+    report_keyboard_t report;
+    uint32_t          seed = 1;
+
+    void SetUp() override {
+        keymap_config.nkro = true;
+        memset(&report, 0, sizeof(report));
+        clear_keys_from_report(&report);
+    }
+
+    uint32_t random() {
+        seed = seed * 1103515245 + 12345;
+        return seed >> 8;
+    }
+
+    void expect_matches_reference() {
+        EXPECT_EQ(has_anykey(&report), reference_nkro_keys(&report));
+        if (has_anykey(&report)) {
+            EXPECT_EQ(get_first_key(&report), reference_get_first_key(&report));
+        } else {
+            EXPECT_EQ(get_first_key(&report), KC_NO);
+        }
+        for (uint16_t key = 0; key <= 0xFF; key++) {
+            EXPECT_EQ(is_key_pressed(&report, key), reference_is_key_pressed(&report, key)) << "key " << key;
+        }
+    }
+};
+
+TEST_F(Nkro, BitwiseHelpersMatchReference) {
+    const uint32_t edges[] = {0, 1, 0x80, 0x8000, 0x80000000, 0xFFFFFFFF, 0x55555555, 0xAAAAAAAA, 0x00010001};
+    for (auto bits : edges) {
+        EXPECT_EQ(bitpop32(bits), reference_bitpop32(bits)) << bits;
+        EXPECT_EQ(biton32(bits), reference_biton32(bits)) << bits;
+    }
+    for (int i = 0; i < 10000; i++) {
+        uint32_t bits = random() ^ random() << 16;
+        EXPECT_EQ(bitpop32(bits), reference_bitpop32(bits)) << bits;
+        EXPECT_EQ(biton32(bits), reference_biton32(bits)) << bits;
+    }
+}
+
+TEST_F(Nkro, ReportQueriesMatchReference) {
+    expect_matches_reference();
+
+    // Keys at the edges of the words and of the bitmap
+    for (uint8_t key : {(uint8_t)KC_A, (uint8_t)KC_SPACE, (uint8_t)31, (uint8_t)32, (uint8_t)(KEYBOARD_REPORT_BITS * 8 - 1)}) {
+        add_key_to_report(&report, key);
+        expect_matches_reference();
+    }
+    clear_keys_from_report(&report);
+    expect_matches_reference();
+
+    for (int i = 0; i < 500; i++) {
+        uint8_t key = random() % (KEYBOARD_REPORT_BITS * 8);
+        if (random() & 1) {
+            add_key_to_report(&report, key);
+        } else {
+            del_key_from_report(&report, key);
+        }
+        expect_matches_reference();
+    }
+}
+
+TEST_F(Nkro, KeyCountFollowsEveryReport) {
+    report_keyboard_t other = {};
+
+    add_key_to_report(&report, KC_A);
+    add_key_to_report(&report, KC_A);
+    EXPECT_EQ(has_anykey(&report), 1);
+
+    // Another report is counted by itself, and changes to it do not leak over
+    add_key_to_report(&other, KC_B);
+    add_key_to_report(&other, KC_C);
+    EXPECT_EQ(has_anykey(&other), 2);
+    del_key_from_report(&report, KC_A);
+    EXPECT_EQ(has_anykey(&report), 0);
+    EXPECT_EQ(has_anykey(&other), 2);
+
+    // Changes made while the host uses the 6KRO report are counted again
+    keymap_config.nkro = false;
+    add_key_to_report(&other, KC_D);
+    keymap_config.nkro = true;
+    EXPECT_EQ(has_anykey(&other), reference_nkro_keys(&other));
+
+    // Bits written straight into the report are counted too
+    other.nkro.bits[KC_E >> 3] |= 1 << (KC_E & 7);
+    EXPECT_EQ(has_anykey(&other), reference_nkro_keys(&other));
+    memset(other.nkro.bits, 0, sizeof(other.nkro.bits));
+    EXPECT_EQ(has_anykey(&other), 0);
+    clear_keys_from_report(&report);
+    EXPECT_EQ(has_anykey(&report), 0);
+}
+
+TEST_F(Nkro, OneshotModsAreReleasedWithKeys) {
+    TestDriver driver;
+    InSequence s;
+    KeymapKey  osm_shift = KeymapKey(0, 0, 0, OSM(MOD_LSFT));
+    KeymapKey  key_a     = KeymapKey(0, 1, 0, KC_A);
+    KeymapKey  key_b     = KeymapKey(0, 2, 0, KC_B);
+
+    set_keymap({osm_shift, key_a, key_b});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    osm_shift.press();
+    run_one_scan_loop();
+    osm_shift.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_a.press();
+    run_one_scan_loop();
+    key_b.press();
+    run_one_scan_loop();
+    key_a.release();
+    run_one_scan_loop();
+    key_b.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Nkro, OneshotModsFollowTheKeyCount) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    // A key added twice is gone after one del_key()
+    ::add_key(KC_A);
+    ::add_key(KC_A);
+    del_key(KC_A);
+    del_key(KC_A);
+    set_oneshot_mods(MOD_BIT(KC_LSFT));
+    send_keyboard_report();
+    EXPECT_EQ(get_oneshot_mods(), MOD_BIT(KC_LSFT));
+
+    // Keys that do not fit in the bitmap are not counted
+    ::add_key(KEYBOARD_REPORT_BITS * 8);
+    send_keyboard_report();
+    EXPECT_EQ(get_oneshot_mods(), MOD_BIT(KC_LSFT));
+
+    ::add_key(KC_B);
+    send_keyboard_report();
+    EXPECT_EQ(get_oneshot_mods(), 0);
+
+    set_oneshot_mods(MOD_BIT(KC_LSFT));
+    clear_keys();
+    send_keyboard_report();
+    EXPECT_EQ(get_oneshot_mods(), MOD_BIT(KC_LSFT));
+
+    // The 6KRO report is counted the same way
+    keymap_config.nkro = false;
+    ::add_key(KC_C);
+    del_key(KC_C);
+    send_keyboard_report();
+    EXPECT_EQ(get_oneshot_mods(), MOD_BIT(KC_LSFT));
+    ::add_key(KC_C);
+    send_keyboard_report();
+    EXPECT_EQ(get_oneshot_mods(), 0);
+    clear_keys();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,129 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "action_util.h"
+#include "host.h"
+}
+
+using testing::_;
+
+class ReportDeduplication : public TestFixture {
+   protected:
+    KeymapKey key_a = KeymapKey(0, 0, 0, KC_A);
+
+    void SetUp() override {
+        add_key(key_a);
+        host_clear_report_stats();
+    }
+};
+
+TEST_F(ReportDeduplication, UnchangedKeyboardReportsAreSuppressed) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    key_a.press();
+    run_one_scan_loop();
+
+    send_keyboard_report();
+    send_keyboard_report();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_a.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    host_report_stats_t stats = host_get_report_stats();
+    EXPECT_EQ(stats.sent[HOST_REPORT_KEYBOARD], 2);
+    EXPECT_EQ(stats.suppressed[HOST_REPORT_KEYBOARD], 2);
+    EXPECT_EQ(stats.sent[HOST_REPORT_MOUSE], 0);
+}
+
+TEST_F(ReportDeduplication, InvalidatedReportsAreSentAgain) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(2);
+    key_a.press();
+    run_one_scan_loop();
+
+    // e.g. after a USB reset, the host no longer knows the key is held
+    host_invalidate_reports();
+    send_keyboard_report();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_a.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(ReportDeduplication, DroppedReportsAreSentAgain) {
+    TestDriver driver;
+
+    // The driver could not send the report and invalidates the shadows
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).WillOnce(testing::InvokeWithoutArgs(host_invalidate_reports)).WillOnce(testing::Return());
+    key_a.press();
+    run_one_scan_loop();
+    send_keyboard_report();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_a.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(ReportDeduplication, MouseMovementIsNeverSuppressed) {
+    TestDriver     driver;
+    report_mouse_t report = {};
+
+    EXPECT_CALL(driver, send_mouse_mock(_)).Times(4);
+    report.x = 5;
+    host_mouse_send(&report);
+    host_mouse_send(&report);
+    host_mouse_send(&report);
+
+    report.x = 0;
+    host_mouse_send(&report);
+    host_mouse_send(&report);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    host_report_stats_t stats = host_get_report_stats();
+    EXPECT_EQ(stats.sent[HOST_REPORT_MOUSE], 4);
+    EXPECT_EQ(stats.suppressed[HOST_REPORT_MOUSE], 1);
+}
+
+TEST_F(ReportDeduplication, ExtraReportsAreCounted) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_consumer_mock(_)).Times(2);
+    host_consumer_send(AUDIO_VOL_UP);
+    host_consumer_send(AUDIO_VOL_UP);
+    host_consumer_send(0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    host_report_stats_t stats = host_get_report_stats();
+    EXPECT_EQ(stats.sent[HOST_REPORT_CONSUMER], 2);
+    EXPECT_EQ(stats.suppressed[HOST_REPORT_CONSUMER], 1);
+    EXPECT_EQ(stats.sent[HOST_REPORT_KEYBOARD], 0);
+}
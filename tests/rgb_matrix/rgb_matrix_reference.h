@@ -0,0 +1,71 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/* Hashes of the frames every effect renders in the plain tests/rgb_matrix
+ * build. When an effect changes on purpose, replace its line with the one
+ * printed by the failing test. */
+static const struct {
+    const char *name;
+    uint32_t    hash;
+} rgb_matrix_reference[] = {
+    {"SOLID_COLOR", 0x6d741c55},
+    {"ALPHAS_MODS", 0x28db76d5},
+    {"GRADIENT_UP_DOWN", 0x83c77aed},
+    {"GRADIENT_LEFT_RIGHT", 0xc87445},
+    {"BREATHING", 0xe7799ded},
+    {"BAND_SAT", 0xfd90cc45},
+    {"BAND_VAL", 0xcf58fa8d},
+    {"BAND_PINWHEEL_SAT", 0x168d65a4},
+    {"BAND_PINWHEEL_VAL", 0xecee3bea},
+    {"BAND_SPIRAL_SAT", 0xb685c331},
+    {"BAND_SPIRAL_VAL", 0xe595ccd9},
+    {"CYCLE_ALL", 0xe0bbd105},
+    {"CYCLE_LEFT_RIGHT", 0x827d8bcd},
+    {"CYCLE_UP_DOWN", 0xc1d798e9},
+    {"RAINBOW_MOVING_CHEVRON", 0x597d1241},
+    {"CYCLE_OUT_IN", 0x1ab2b715},
+    {"CYCLE_OUT_IN_DUAL", 0x1560036d},
+    {"CYCLE_PINWHEEL", 0x38c315e1},
+    {"CYCLE_SPIRAL", 0x4adc9565},
+    {"DUAL_BEACON", 0xf09d2225},
+    {"RAINBOW_BEACON", 0xc8fc1213},
+    {"RAINBOW_PINWHEELS", 0xc3f4af25},
+    {"RAINDROPS", 0xbf3a454b},
+    {"JELLYBEAN_RAINDROPS", 0xce368c75},
+    {"HUE_BREATHING", 0xb9a8f135},
+    {"HUE_PENDULUM", 0xab4b0c25},
+    {"HUE_WAVE", 0x37203dfd},
+    {"PIXEL_RAIN", 0x1dca890d},
+    {"PIXEL_FRACTAL", 0xc925b47d},
+    {"TYPING_HEATMAP", 0x5435f781},
+    {"DIGITAL_RAIN", 0x97517182},
+    {"SOLID_REACTIVE_SIMPLE", 0x90568311},
+    {"SOLID_REACTIVE", 0xa99f41fb},
+    {"SOLID_REACTIVE_WIDE", 0xd1f8f1db},
+    {"SOLID_REACTIVE_MULTIWIDE", 0x4b4ed1ee},
+    {"SOLID_REACTIVE_CROSS", 0xc40b591f},
+    {"SOLID_REACTIVE_MULTICROSS", 0xcb135395},
+    {"SOLID_REACTIVE_NEXUS", 0x1c5fffe0},
+    {"SOLID_REACTIVE_MULTINEXUS", 0x74497465},
+    {"SPLASH", 0xfe819583},
+    {"MULTISPLASH", 0xd783b997},
+    {"SOLID_SPLASH", 0x1b88e21},
+    {"SOLID_MULTISPLASH", 0x830d0083},
+};
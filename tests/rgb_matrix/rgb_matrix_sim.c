@@ -0,0 +1,69 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rgb_matrix.h"
+#include "rgb_matrix_sim.h"
+#include <string.h>
+
+RGB      rgb_sim_buffer[DRIVER_LED_TOTAL];
+RGB      rgb_sim_frame[DRIVER_LED_TOTAL];
+uint32_t rgb_sim_flushes;
+
+static void init(void) {
+    memset(rgb_sim_buffer, 0, sizeof(rgb_sim_buffer));
+    memset(rgb_sim_frame, 0, sizeof(rgb_sim_frame));
+    rgb_sim_flushes = 0;
+}
+
+static void flush(void) {
+    memcpy(rgb_sim_frame, rgb_sim_buffer, sizeof(rgb_sim_frame));
+    rgb_sim_flushes++;
+}
+
+static void set_color(int index, uint8_t r, uint8_t g, uint8_t b) {
+    if (index >= 0 && index < DRIVER_LED_TOTAL) {
+        rgb_sim_buffer[index] = (RGB){.r = r, .g = g, .b = b};
+    }
+}
+
+static void set_color_all(uint8_t r, uint8_t g, uint8_t b) {
+    for (int i = 0; i < DRIVER_LED_TOTAL; i++) {
+        set_color(i, r, g, b);
+    }
+}
+
+const rgb_matrix_driver_t rgb_matrix_driver = {
+    .init          = init,
+    .flush         = flush,
+    .set_color     = set_color,
+    .set_color_all = set_color_all,
+};
+
+// clang-format off
+
+/* A 4x10 grid with one LED per key, spread over the whole 224x64 area. The
+ * outer columns are modifiers. */
+#define ROW(r) { (r) * 10, (r) * 10 + 1, (r) * 10 + 2, (r) * 10 + 3, (r) * 10 + 4, (r) * 10 + 5, (r) * 10 + 6, (r) * 10 + 7, (r) * 10 + 8, (r) * 10 + 9 }
+#define POINTS(y) { 0, y }, { 24, y }, { 48, y }, { 72, y }, { 96, y }, { 128, y }, { 152, y }, { 176, y }, { 200, y }, { 224, y }
+#define FLAGS 1, 4, 4, 4, 4, 4, 4, 4, 4, 1
+
+led_config_t g_led_config = {
+    { ROW(0), ROW(1), ROW(2), ROW(3) },
+    { POINTS(0), POINTS(21), POINTS(43), POINTS(64) },
+    { FLAGS, FLAGS, FLAGS, FLAGS }
+};
+
+// clang-format on
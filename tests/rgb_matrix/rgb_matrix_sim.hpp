@@ -0,0 +1,147 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "rgb_matrix_reference.h"
+
+extern "C" {
+#include "rgb_matrix.h"
+#include "rgb_matrix_sim.h"
+#include "lib/lib8tion/lib8tion.h"
+void advance_time(uint32_t ms);
+void set_time(uint32_t t);
+}
+
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+static const char *effect_names[] = {
+    "NONE",
+#define RGB_MATRIX_EFFECT(name, ...) #name,
+#include "rgb_matrix_effects.inc"
+#undef RGB_MATRIX_EFFECT
+};
+
+struct EffectRun {
+    std::vector<RGB> frames;  // DRIVER_LED_TOTAL entries per flushed frame
+    uint32_t         flushes;
+    uint64_t         render_ns;
+};
+
+/* Renders effects on the host, against the mock driver and the LED layout in
+ * rgb_matrix_sim.c. Set RGB_MATRIX_SIM_DUMP to a directory to write every frame
+ * of every effect to <effect>.rgb (raw 8 bit RGB, DRIVER_LED_TOTAL pixels per
+ * frame) and <effect>.ppm (one row of pixels per frame). Set
+ * RGB_MATRIX_SIM_BUDGET_NS to fail effects that take longer per LED and frame. */
+class RgbMatrix : public TestFixture {
+   protected:
+    static const uint32_t DURATION_MS   = 2000;
+    static const uint32_t HIT_PERIOD_MS = 150;
+
+    void SetUp() override {
+        // Every build starts from the same time and random state, so that
+        // the variants of this test render the same frames
+        set_time(0);
+        srand(1);
+        random16_set_seed(1);
+        rgb_matrix_init();
+        rgb_matrix_enable_noeeprom();
+        rgb_matrix_sethsv_noeeprom(0, 255, 255);
+        rgb_matrix_set_speed_noeeprom(128);
+    }
+
+    EffectRun run(uint8_t mode) {
+        EffectRun result = {};
+
+        rgb_matrix_mode_noeeprom(mode);
+        rgb_sim_flushes = 0;
+        for (uint32_t t = 0; t < DURATION_MS; t++) {
+            // Keep the reactive effects busy, walking over the keys
+            if (t % HIT_PERIOD_MS == 0) {
+                uint8_t key = (t / HIT_PERIOD_MS) * 7;
+                process_rgb_matrix((key / MATRIX_COLS) % MATRIX_ROWS, key % MATRIX_COLS, true);
+            }
+
+            uint32_t flushes = rgb_sim_flushes;
+            auto     start   = steady_clock::now();
+            rgb_matrix_task();
+            result.render_ns += duration_cast<nanoseconds>(steady_clock::now() - start).count();
+
+            if (rgb_sim_flushes != flushes) {
+                result.frames.insert(result.frames.end(), rgb_sim_frame, rgb_sim_frame + DRIVER_LED_TOTAL);
+            }
+            advance_time(1);
+        }
+        result.flushes = rgb_sim_flushes;
+        return result;
+    }
+
+    void dump(const char *dir, const char *name, const EffectRun &run) {
+        std::string path = std::string(dir) + "/" + name;
+
+        FILE *raw = fopen((path + ".rgb").c_str(), "wb");
+        ASSERT_NE(raw, nullptr);
+        FILE *ppm = fopen((path + ".ppm").c_str(), "wb");
+        ASSERT_NE(ppm, nullptr);
+
+        fprintf(ppm, "P6\n%d %u\n255\n", DRIVER_LED_TOTAL, run.flushes);
+        for (auto &pixel : run.frames) {
+            uint8_t rgb[3] = {pixel.r, pixel.g, pixel.b};
+            fwrite(rgb, 1, sizeof(rgb), raw);
+            fwrite(rgb, 1, sizeof(rgb), ppm);
+        }
+        fclose(raw);
+        fclose(ppm);
+    }
+
+    static uint32_t hash(const EffectRun &run) {
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        for (auto &pixel : run.frames) {
+            for (uint8_t byte : {pixel.r, pixel.g, pixel.b}) {
+                hash = (hash ^ byte) * 16777619u;
+            }
+        }
+        return hash;
+    }
+
+    /* The frames of every effect have to match rgb_matrix_reference.h, which
+     * holds the hashes of the plain tests/rgb_matrix build. Builds with
+     * options that must not change the output run this too. */
+    void expect_reference_frames(void) {
+        for (uint8_t mode = RGB_MATRIX_SOLID_COLOR; mode < RGB_MATRIX_EFFECT_MAX; mode++) {
+            const char *name     = effect_names[mode];
+            uint32_t    expected = 0;
+            for (auto &reference : rgb_matrix_reference) {
+                if (strcmp(reference.name, name) == 0) {
+                    expected = reference.hash;
+                }
+            }
+            EffectRun r = run(mode);
+            EXPECT_EQ(hash(r), expected) << "{\"" << name << "\", 0x" << std::hex << hash(r) << "},";
+        }
+    }
+};
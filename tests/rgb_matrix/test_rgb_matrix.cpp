@@ -0,0 +1,53 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rgb_matrix_sim.hpp"
+
+TEST_F(RgbMatrix, FramesMatchReference) { expect_reference_frames(); }
+
+TEST_F(RgbMatrix, EveryEffectRendersAtFrameRate) {
+    TestDriver driver;
+
+    const char *dump_dir  = getenv("RGB_MATRIX_SIM_DUMP");
+    const char *budget    = getenv("RGB_MATRIX_SIM_BUDGET_NS");
+    double      budget_ns = budget ? atof(budget) : 0;
+
+    printf("%-28s %7s %12s %12s\n", "effect", "frames", "us/frame", "ns/LED");
+    for (uint8_t mode = RGB_MATRIX_SOLID_COLOR; mode < RGB_MATRIX_EFFECT_MAX; mode++) {
+        const char *name = effect_names[mode];
+        EffectRun   r    = run(mode);
+
+        // Every effect has to finish its frames within the flush limit
+        EXPECT_GE(r.flushes, DURATION_MS / (RGB_MATRIX_LED_FLUSH_LIMIT + 1) * 9 / 10) << name;
+
+        bool lit = false;
+        for (auto &pixel : r.frames) {
+            lit |= pixel.r || pixel.g || pixel.b;
+        }
+        EXPECT_TRUE(lit) << name << " never lit an LED";
+
+        double per_frame = r.flushes ? (double)r.render_ns / r.flushes : 0;
+        double per_led   = per_frame / DRIVER_LED_TOTAL;
+        printf("%-28s %7u %12.2f %12.1f\n", name, r.flushes, per_frame / 1000, per_led);
+        if (budget_ns > 0) {
+            EXPECT_LE(per_led, budget_ns) << name << " is over budget";
+        }
+
+        if (dump_dir) {
+            dump(dump_dir, name, r);
+        }
+    }
+}
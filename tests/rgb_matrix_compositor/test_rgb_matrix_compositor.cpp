@@ -0,0 +1,118 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "../rgb_matrix/rgb_matrix_sim.hpp"
+
+static bool indicator_enabled = false;
+
+extern "C" void rgb_matrix_indicators_user(void) {
+    if (indicator_enabled) {
+        rgb_matrix_set_color(0, 0, 0, 255);
+    }
+}
+
+// Without an overlay or indicators, the composed frames are the plain ones
+TEST_F(RgbMatrix, FramesMatchReference) { expect_reference_frames(); }
+
+TEST_F(RgbMatrix, IndicatorsCoverOnlyTheirLeds) {
+    TestDriver driver;
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+    indicator_enabled = true;
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+    EXPECT_EQ(rgb_sim_frame[0].r, 0);
+    EXPECT_EQ(rgb_sim_frame[0].b, 255);
+    EXPECT_EQ(rgb_sim_frame[1].r, 255);
+    EXPECT_EQ(rgb_sim_frame[1].b, 0);
+
+    // The indicator layer is cleared every frame
+    indicator_enabled = false;
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+    EXPECT_EQ(rgb_sim_frame[0].r, 255);
+    EXPECT_EQ(rgb_sim_frame[0].b, 0);
+}
+
+TEST_F(RgbMatrix, OverlayIsBlendedOverTheEffect) {
+    TestDriver driver;
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+    rgb_matrix_sethsv_noeeprom(0, 255, 128);
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+    uint8_t red = rgb_sim_frame[0].r;
+    ASSERT_GT(red, 0);
+
+    rgb_matrix_set_overlay(RGB_MATRIX_SOLID_COLOR, LED_BLEND_ADD);
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+    rgb_matrix_set_overlay(RGB_MATRIX_NONE, LED_BLEND_ADD);
+
+    // The same color added to itself
+    for (int i = 0; i < DRIVER_LED_TOTAL; i++) {
+        EXPECT_EQ(rgb_sim_frame[i].r, 2 * red) << i;
+        EXPECT_EQ(rgb_sim_frame[i].g, 0) << i;
+    }
+}
+
+TEST_F(RgbMatrix, SuspendTurnsOffIndicators) {
+    TestDriver driver;
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+    indicator_enabled = true;
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+    rgb_matrix_set_suspend_state(true);
+    indicator_enabled = false;
+
+    for (int i = 0; i < DRIVER_LED_TOTAL; i++) {
+        EXPECT_EQ(rgb_sim_frame[i].r, 0) << i;
+        EXPECT_EQ(rgb_sim_frame[i].b, 0) << i;
+    }
+    rgb_matrix_set_suspend_state(false);
+}
+
+TEST_F(RgbMatrix, InitRewritesEveryLed) {
+    TestDriver driver;
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+
+    // The driver is blank again, although the composed frame is unchanged
+    SetUp();
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+    for (int i = 0; i < DRIVER_LED_TOTAL; i++) {
+        EXPECT_EQ(rgb_sim_frame[i].r, 255) << i;
+    }
+}
@@ -0,0 +1,94 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "../rgb_matrix/rgb_matrix_sim.hpp"
+
+extern "C" {
+#include "led_tables.h"
+#include "progmem.h"
+}
+
+class RgbMatrixGammaDither : public RgbMatrix {
+   protected:
+    // Sums the red channel of LED 0 over one dither cycle of flushes
+    uint16_t sum_over_cycle(void) {
+        uint16_t sum = 0;
+        for (uint8_t frame = 0; frame < 1 << RGB_MATRIX_DITHER_BITS;) {
+            uint32_t flushes = rgb_sim_flushes;
+            rgb_matrix_task();
+            advance_time(1);
+            if (rgb_sim_flushes != flushes) {
+                sum += rgb_sim_frame[0].r;
+                frame++;
+            }
+        }
+        return sum;
+    }
+
+    void settle(void) {
+        for (int i = 0; i < 100; i++) {
+            rgb_matrix_task();
+            advance_time(1);
+        }
+    }
+};
+
+TEST_F(RgbMatrixGammaDither, ColorIsCorrectedOnce) {
+    TestDriver driver;
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+    rgb_matrix_sethsv_noeeprom(0, 0, 128);
+    settle();
+
+    // Over a cycle the dithered steps add up to the table entry for the
+    // value itself, with the fraction bits that are not dithered dropped
+    uint16_t level = pgm_read_word(&CIE1931_CURVE_12[128]);
+    EXPECT_EQ(sum_over_cycle(), level >> (LED_OUTPUT_FRACTION_BITS - RGB_MATRIX_DITHER_BITS));
+}
+
+TEST_F(RgbMatrixGammaDither, CycleRepeatsFasterThanTheEffect) {
+    TestDriver driver;
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+    rgb_matrix_sethsv_noeeprom(0, 0, 128);
+    settle();
+
+    uint32_t flushes = rgb_sim_flushes;
+    for (uint32_t t = 0; t < RGB_MATRIX_LED_FLUSH_LIMIT * 4; t++) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+    // The effect alone is flushed at most 4 times, the rest are dither refreshes
+    EXPECT_GE(rgb_sim_flushes - flushes, 2 * RGB_MATRIX_LED_FLUSH_LIMIT / RGB_MATRIX_DITHER_INTERVAL);
+}
+
+TEST_F(RgbMatrixGammaDither, NothingIsRefreshedWhileOff) {
+    TestDriver driver;
+
+    rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+    rgb_matrix_sethsv_noeeprom(0, 0, 0);
+    settle();
+
+    // Only the effect frames reach the driver
+    uint32_t flushes = rgb_sim_flushes;
+    for (uint32_t t = 0; t < RGB_MATRIX_LED_FLUSH_LIMIT * 4; t++) {
+        rgb_matrix_task();
+        advance_time(1);
+    }
+    EXPECT_LE(rgb_sim_flushes - flushes, 4);
+    EXPECT_EQ(rgb_sim_frame[0].r, 0);
+}
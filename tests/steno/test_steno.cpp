@@ -0,0 +1,214 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <vector>
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "keymap_steno.h"
+#include "process_steno.h"
+#include "timer.h"
+#include "virtser.h"
+}
+
+using testing::_;
+
+/* A virtual serial endpoint that takes one USB packet per polling interval,
+ * and records everything the steno code sends. */
+static struct {
+    std::vector<uint8_t> stream;
+    std::vector<size_t>  transfers;
+    size_t               sync_bytes;
+    bool                 busy;
+    uint16_t             interval;
+    uint16_t             last_transfer;
+} serial;
+
+static const uint8_t USB_PACKET_SIZE = 64;
+
+extern "C" {
+void virtser_init(void) {}
+
+void virtser_send(const uint8_t byte) {
+    serial.stream.push_back(byte);
+    serial.sync_bytes++;
+}
+
+uint8_t virtser_write(const uint8_t *data, uint8_t length) {
+    if (serial.busy || (!serial.transfers.empty() && timer_elapsed(serial.last_transfer) < serial.interval)) {
+        return 0;
+    }
+    uint8_t written = length < USB_PACKET_SIZE ? length : USB_PACKET_SIZE;
+    serial.stream.insert(serial.stream.end(), data, data + written);
+    serial.transfers.push_back(written);
+    serial.last_transfer = timer_read();
+    return written;
+}
+}
+
+class Steno : public TestFixture {
+   protected:
+    KeymapKey key_s1 = KeymapKey(0, 0, 0, STN_S1);
+    KeymapKey key_tl = KeymapKey(0, 1, 0, STN_TL);
+    KeymapKey key_a  = KeymapKey(0, 2, 0, STN_A);
+    KeymapKey key_e  = KeymapKey(0, 3, 0, STN_E);
+    KeymapKey key_zr = KeymapKey(0, 4, 0, STN_ZR);
+
+    void SetUp() override {
+        set_keymap({key_s1, key_tl, key_a, key_e, key_zr});
+        serial.stream.clear();
+        serial.transfers.clear();
+        serial.sync_bytes = 0;
+        serial.busy       = false;
+        serial.interval   = 0;
+    }
+
+    void stroke(std::vector<KeymapKey *> keys) {
+        for (auto key : keys) {
+            key->press();
+            run_one_scan_loop();
+        }
+        for (auto key : keys) {
+            key->release();
+            run_one_scan_loop();
+        }
+    }
+};
+
+static const std::vector<uint8_t> GEMINI_S_A = {0x80, 0x40, 0x20, 0x00, 0x00, 0x00};
+static const std::vector<uint8_t> GEMINI_T_E = {0x80, 0x10, 0x00, 0x08, 0x00, 0x00};
+static const std::vector<uint8_t> GEMINI_Z   = {0x80, 0x00, 0x00, 0x00, 0x00, 0x01};
+static const std::vector<uint8_t> BOLT_S_A   = {0x01, 0x42, 0x00};
+static const std::vector<uint8_t> BOLT_T_E   = {0x02, 0x50, 0x00};
+
+static std::vector<uint8_t> concat(std::vector<std::vector<uint8_t>> packets) {
+    std::vector<uint8_t> result;
+    for (auto &packet : packets) {
+        result.insert(result.end(), packet.begin(), packet.end());
+    }
+    return result;
+}
+
+TEST_F(Steno, GeminiStrokeIsSentOnRelease) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    steno_set_mode(STENO_MODE_GEMINI);
+
+    stroke({&key_s1, &key_a});
+
+    EXPECT_EQ(serial.stream, GEMINI_S_A);
+    EXPECT_EQ(serial.transfers.size(), 1);
+    EXPECT_EQ(serial.sync_bytes, 0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Steno, StrokesAreBatchedWhileEndpointIsBusy) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    steno_set_mode(STENO_MODE_GEMINI);
+    serial.busy = true;
+
+    stroke({&key_s1, &key_a});
+    stroke({&key_tl, &key_e});
+    stroke({&key_zr});
+    EXPECT_TRUE(serial.stream.empty());
+
+    serial.busy = false;
+    run_one_scan_loop();
+
+    EXPECT_EQ(serial.stream, concat({GEMINI_S_A, GEMINI_T_E, GEMINI_Z}));
+    EXPECT_EQ(serial.transfers, std::vector<size_t>{18});
+    EXPECT_EQ(serial.sync_bytes, 0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Steno, BoltPacketsAreTerminated) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    steno_set_mode(STENO_MODE_BOLT);
+    serial.busy = true;
+
+    stroke({&key_s1, &key_a});
+    stroke({&key_tl, &key_e});
+
+    serial.busy = false;
+    run_one_scan_loop();
+
+    EXPECT_EQ(serial.stream, concat({BOLT_S_A, BOLT_T_E}));
+    EXPECT_EQ(serial.transfers.size(), 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Steno, FullBufferDropsWholeStrokes) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    steno_set_mode(STENO_MODE_GEMINI);
+    serial.busy = true;
+
+    // 63 usable bytes hold 10 strokes
+    std::vector<uint8_t> expected;
+    for (int i = 0; i < 12; i++) {
+        stroke({&key_tl, &key_e});
+        if (i < 10) expected = concat({expected, GEMINI_T_E});
+    }
+    stroke({&key_zr});
+
+    // Nothing waits for the busy endpoint
+    EXPECT_EQ(serial.sync_bytes, 0);
+    EXPECT_TRUE(serial.stream.empty());
+    serial.busy = false;
+    run_one_scan_loop();
+
+    EXPECT_EQ(serial.stream, expected);
+
+    // Once there is room again strokes are queued as usual
+    stroke({&key_zr});
+    EXPECT_EQ(serial.stream, concat({expected, GEMINI_Z}));
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Steno, RecordedStrokeStreamThroughput) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    steno_set_mode(STENO_MODE_GEMINI);
+
+    // The host only polls the endpoint every 8ms, while a stroke takes a few scans
+    serial.interval = 8;
+
+    const std::vector<std::vector<KeymapKey *>> strokes = {{&key_s1, &key_a}, {&key_tl, &key_e}, {&key_zr}};
+    const std::vector<std::vector<uint8_t>>     packets = {GEMINI_S_A, GEMINI_T_E, GEMINI_Z};
+    const int                                   count   = 300;
+
+    std::vector<uint8_t> expected;
+    uint32_t             start = timer_read32();
+    for (int i = 0; i < count; i++) {
+        stroke(strokes[i % strokes.size()]);
+        expected = concat({expected, packets[i % packets.size()]});
+    }
+    idle_for(serial.interval * 2);
+    uint32_t elapsed = timer_elapsed32(start);
+
+    EXPECT_EQ(serial.stream, expected);
+    EXPECT_EQ(serial.sync_bytes, 0);
+    EXPECT_LT(serial.transfers.size(), count / 2);
+
+    printf("%d strokes in %u ms, %zu transfers, %.1f strokes per transfer\n", count, elapsed, serial.transfers.size(), (double)count / serial.transfers.size());
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -0,0 +1,24 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+// Tap dances are defined in C, their initializers are not valid C++
+qk_tap_dance_action_t tap_dance_actions[] = {
+    [0]   = ACTION_TAP_DANCE_DOUBLE(KC_A, KC_B),
+    [1]   = ACTION_TAP_DANCE_DOUBLE(KC_C, KC_D),
+    [200] = ACTION_TAP_DANCE_DOUBLE(KC_E, KC_F),
+};
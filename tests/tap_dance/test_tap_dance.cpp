@@ -0,0 +1,138 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "process_tap_dance.h"
+}
+
+using testing::_;
+using testing::InSequence;
+
+class TapDance : public TestFixture {};
+
+TEST_F(TapDance, SingleTapFinishesAfterTappingTerm) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_td = KeymapKey(0, 0, 0, TD(0));
+
+    set_keymap({key_td});
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    key_td.press();
+    run_one_scan_loop();
+    key_td.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(TAPPING_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Nothing is left in progress
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(TAPPING_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(TapDance, DoubleTapFinishesImmediately) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_td = KeymapKey(0, 0, 0, TD(0));
+
+    set_keymap({key_td});
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    key_td.press();
+    run_one_scan_loop();
+    key_td.release();
+    run_one_scan_loop();
+    key_td.press();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_td.release();
+    run_one_scan_loop();
+    idle_for(TAPPING_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(TapDance, InterruptedByAnotherDance) {
+    TestDriver driver;
+    InSequence s;
+    auto       key_td_0   = KeymapKey(0, 0, 0, TD(0));
+    auto       key_td_200 = KeymapKey(0, 1, 0, TD(200));
+
+    set_keymap({key_td_0, key_td_200});
+
+    key_td_0.press();
+    run_one_scan_loop();
+    key_td_0.release();
+    run_one_scan_loop();
+
+    // Pressing the second dance finishes the first one
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    key_td_200.press();
+    run_one_scan_loop();
+    key_td_200.release();
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(TAPPING_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(TapDance, ResettingAnUnpressedDanceKeepsOthersInProgress) {
+    TestDriver driver;
+    auto       key_td = KeymapKey(0, 0, 0, TD(0));
+
+    set_keymap({key_td});
+
+    key_td.press();
+    run_one_scan_loop();
+    key_td.release();
+    run_one_scan_loop();
+
+    // Dance 5 is empty and was never pressed
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    reset_tap_dance(&tap_dance_actions[5].state);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(TAPPING_TERM + 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
@@ -17,22 +17,48 @@
 #include "keyboard_report_util.hpp"
 #include <vector>
 #include <algorithm>
+
+extern "C" {
+#include "host.h"
+#include "keycode_config.h"
+}
+
 using namespace testing;
 
 namespace {
+#if defined(NKRO_ENABLE)
+bool is_nkro(void) { return keyboard_protocol && keymap_config.nkro; }
+#endif
+
+uint8_t get_mods(const report_keyboard_t& report) {
+#if defined(NKRO_ENABLE)
+    if (is_nkro()) {
+        return report.nkro.mods;
+    }
+#endif
+    return report.mods;
+}
+
 std::vector<uint8_t> get_keys(const report_keyboard_t& report) {
     std::vector<uint8_t> result;
-#if defined(NKRO_ENABLE)
-#    error NKRO support not implemented yet
-#elif defined(RING_BUFFERED_6KRO_REPORT_ENABLE)
+#if defined(RING_BUFFERED_6KRO_REPORT_ENABLE)
 #    error 6KRO support not implemented yet
-#else
+#endif
+#if defined(NKRO_ENABLE)
+    if (is_nkro()) {
+        for (size_t i = 0; i < KEYBOARD_REPORT_BITS * 8; i++) {
+            if (report.nkro.bits[i >> 3] & 1 << (i & 7)) {
+                result.emplace_back(i);
+            }
+        }
+        return result;
+    }
+#endif
     for (size_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
         if (report.keys[i]) {
             result.emplace_back(report.keys[i]);
         }
     }
-#endif
     std::sort(result.begin(), result.end());
     return result;
 }
@@ -41,14 +67,14 @@ std::vector<uint8_t> get_keys(const report_keyboard_t& report) {
 bool operator==(const report_keyboard_t& lhs, const report_keyboard_t& rhs) {
     auto lhskeys = get_keys(lhs);
     auto rhskeys = get_keys(rhs);
-    return lhs.mods == rhs.mods && lhskeys == rhskeys;
+    return get_mods(lhs) == get_mods(rhs) && lhskeys == rhskeys;
 }
 
 std::ostream& operator<<(std::ostream& stream, const report_keyboard_t& report) {
     auto keys = get_keys(report);
 
     // TODO: This should probably print friendly names for the keys
-    stream << "Keyboard Report: Mods (" << (uint32_t)report.mods << ") Keys (";
+    stream << "Keyboard Report: Mods (" << (uint32_t)get_mods(report) << ") Keys (";
 
     for (auto key = keys.cbegin(); key != keys.cend();) {
         stream << +(*key);
@@ -62,14 +88,22 @@ std::ostream& operator<<(std::ostream& stream, const report_keyboard_t& report)
 }
 
 KeyboardReportMatcher::KeyboardReportMatcher(const std::vector<uint8_t>& keys) {
-    memset(m_report.raw, 0, sizeof(m_report.raw));
+    memset(&m_report, 0, sizeof(m_report));
+    uint8_t mods = 0;
     for (auto k : keys) {
         if (IS_MOD(k)) {
-            m_report.mods |= MOD_BIT(k);
+            mods |= MOD_BIT(k);
         } else {
             add_key_to_report(&m_report, k);
         }
     }
+#if defined(NKRO_ENABLE)
+    if (is_nkro()) {
+        m_report.nkro.mods = mods;
+        return;
+    }
+#endif
+    m_report.mods = mods;
 }
 
 bool KeyboardReportMatcher::MatchAndExplain(report_keyboard_t& report, MatchResultListener* listener) const { return m_report == report; }
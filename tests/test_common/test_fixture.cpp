@@ -62,7 +62,12 @@ TestFixture::~TestFixture() {
     test_logger.info() << "TestFixture clean-up start." << std::endl;
     TestDriver driver;
 
+#ifdef HOST_REPORT_DEDUPLICATION
+    /* The empty report is only sent if the host has not seen it already */
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(testing::AtMost(1));
+#else
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(2);
+#endif
 
     /* Reset keyboard state. */
     clear_all_keys();
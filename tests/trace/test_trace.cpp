@@ -0,0 +1,266 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <vector>
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "keycode_config.h"
+#include "trace.h"
+
+uint8_t keyboard_protocol = 1;
+}
+
+using testing::_;
+
+static std::vector<std::vector<uint8_t>> packets;
+static bool                              output_ready = true;
+
+extern "C" bool trace_send_packet(uint8_t *packet) {
+    if (!output_ready) {
+        return false;
+    }
+    packets.emplace_back(packet, packet + TRACE_PACKET_SIZE);
+    return true;
+}
+
+/* Decodes the packets the same way `qmk trace` does. */
+static std::vector<trace_record_t> received_records(void) {
+    std::vector<trace_record_t> records;
+    for (auto &packet : packets) {
+        EXPECT_EQ(packet[0], TRACE_PACKET_MAGIC);
+        EXPECT_LE(packet[1], TRACE_RECORDS_PER_PACKET);
+        for (uint8_t i = 0; i < packet[1]; i++) {
+            trace_record_t record;
+            memcpy(&record, &packet[TRACE_PACKET_HEADER_SIZE + i * sizeof(record)], sizeof(record));
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+static std::vector<uint8_t> received_events(void) {
+    std::vector<uint8_t> events;
+    for (auto &record : received_records()) {
+        events.push_back(record.event);
+    }
+    return events;
+}
+
+class Trace : public TestFixture {
+   protected:
+    KeymapKey key_a   = KeymapKey(0, 0, 0, KC_A);
+    KeymapKey key_mt  = KeymapKey(0, 2, 0, SFT_T(KC_P));
+    KeymapKey key_mo  = KeymapKey(0, 3, 0, MO(1));
+    KeymapKey key_l1a = KeymapKey(1, 0, 0, KC_C);
+    KeymapKey key_sft = KeymapKey(0, 4, 0, KC_LSFT);
+
+    void SetUp() override {
+        set_keymap({key_a, key_mt, key_mo, key_l1a, key_sft});
+        trace_clear();
+        packets.clear();
+        output_ready       = true;
+        keymap_config.nkro = false;
+    }
+};
+
+TEST_F(Trace, KeyEventsAndReportsAreTraced) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(2);
+
+    key_a.press();
+    run_one_scan_loop();
+    key_a.release();
+    run_one_scan_loop();
+    idle_for(2);
+
+    auto records = received_records();
+    ASSERT_EQ(records.size(), 4);
+
+    EXPECT_EQ(records[0].event, TRACE_KEY);
+    EXPECT_EQ(records[0].arg, 1);
+    EXPECT_EQ(records[0].data[0], 0 << 8 | 0);
+
+    EXPECT_EQ(records[1].event, TRACE_REPORT_KEYBOARD);
+    EXPECT_EQ(records[1].arg, 0);
+    EXPECT_EQ(records[1].data[0], KC_A);
+    EXPECT_EQ(records[1].data[1], 1);
+
+    EXPECT_EQ(records[2].event, TRACE_KEY);
+    EXPECT_EQ(records[2].arg, 0);
+
+    EXPECT_EQ(records[3].event, TRACE_REPORT_KEYBOARD);
+    EXPECT_EQ(records[3].data[1], 0);
+
+    // The release happens one scan after the press
+    EXPECT_EQ((uint16_t)(records[2].time - records[0].time), 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Trace, LayerChangesAreTraced) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    key_mo.press();
+    run_one_scan_loop();
+    key_l1a.press();
+    run_one_scan_loop();
+    key_l1a.release();
+    run_one_scan_loop();
+    key_mo.release();
+    run_one_scan_loop();
+    idle_for(2);
+
+    std::vector<trace_record_t> layers;
+    for (auto &record : received_records()) {
+        if (record.event == TRACE_LAYER_STATE) layers.push_back(record);
+    }
+    ASSERT_EQ(layers.size(), 2);
+    EXPECT_EQ(layers[0].data[0], 1 << 1);
+    EXPECT_EQ(layers[1].data[0], 0);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Trace, TapHoldDecisionsAreTraced) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(2);
+
+    key_mt.press();
+    run_one_scan_loop();
+    key_mt.release();
+    run_one_scan_loop();
+    idle_for(TAPPING_TERM);
+
+    std::vector<trace_record_t> tapping;
+    for (auto &record : received_records()) {
+        if (record.event == TRACE_TAPPING_KEY) tapping.push_back(record);
+    }
+    ASSERT_FALSE(tapping.empty());
+    EXPECT_EQ(tapping.front().arg, 1 << 7);
+    EXPECT_EQ(tapping.front().data[0], 0 << 8 | 2);
+
+    // The release settles the key as a tap
+    bool tapped = false;
+    for (auto &record : tapping) {
+        if (!(record.arg & 0x80) && (record.arg & 0x0F) == 1) tapped = true;
+    }
+    EXPECT_TRUE(tapped);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Trace, BurstsAreSentInFullPackets) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+
+    for (uint8_t i = 0; i < TRACE_RECORDS_PER_PACKET * 3; i++) {
+        trace_event(TRACE_USER, i, 0, 0);
+    }
+    // Only full packets leave while records are still arriving
+    run_one_scan_loop();
+    trace_event(TRACE_USER, 0xFF, 0, 0);
+    run_one_scan_loop();
+    run_one_scan_loop();
+    for (auto &packet : packets) {
+        EXPECT_EQ(packet[1], TRACE_RECORDS_PER_PACKET);
+    }
+
+    idle_for(2);
+    EXPECT_EQ(packets.size(), 4);
+    EXPECT_EQ(packets.back()[1], 1);
+
+    auto records = received_records();
+    for (uint8_t i = 0; i < TRACE_RECORDS_PER_PACKET * 3; i++) {
+        EXPECT_EQ(records[i].arg, i);
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Trace, OverflowIsReported) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+
+    uint16_t dropped = trace_dropped_count();
+    for (uint8_t i = 0; i < 100; i++) {
+        trace_event(TRACE_USER, i, 0, 0);
+    }
+    uint16_t lost = trace_dropped_count() - dropped;
+    EXPECT_GT(lost, 0);
+
+    idle_for(100);
+    trace_event(TRACE_USER + 1, 0, 0, 0);
+    idle_for(2);
+
+    auto events = received_events();
+    ASSERT_GE(events.size(), 2);
+    EXPECT_EQ(events[events.size() - 2], TRACE_OVERFLOW);
+    EXPECT_EQ(events.back(), TRACE_USER + 1);
+    EXPECT_EQ(received_records()[events.size() - 2].data[0], lost);
+    EXPECT_EQ(events.size() - 2, 100 - lost);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Trace, PacketsWaitForTheOutput) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+
+    output_ready = false;
+    for (uint8_t i = 0; i < TRACE_RECORDS_PER_PACKET + 1; i++) {
+        trace_event(TRACE_USER, i, 0, 0);
+    }
+    idle_for(10);
+    EXPECT_TRUE(packets.empty());
+
+    // Nothing was lost or sent in part while the output was busy
+    output_ready = true;
+    idle_for(10);
+    auto records = received_records();
+    ASSERT_EQ(records.size(), TRACE_RECORDS_PER_PACKET + 1);
+    for (uint8_t i = 0; i < TRACE_RECORDS_PER_PACKET + 1; i++) {
+        EXPECT_EQ(records[i].arg, i);
+    }
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Trace, NkroReportsTraceTheirMods) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+    keymap_config.nkro = true;
+    key_sft.press();
+    run_one_scan_loop();
+    key_a.press();
+    run_one_scan_loop();
+    key_a.release();
+    key_sft.release();
+    run_one_scan_loop();
+    idle_for(2);
+
+    std::vector<trace_record_t> reports;
+    for (auto &record : received_records()) {
+        if (record.event == TRACE_REPORT_KEYBOARD) reports.push_back(record);
+    }
+    ASSERT_GE(reports.size(), 2);
+    EXPECT_EQ(reports[0].arg, MOD_BIT(KC_LSFT));
+    EXPECT_EQ(reports[1].arg, MOD_BIT(KC_LSFT));
+    EXPECT_EQ(reports[1].data[0], KC_A);
+    EXPECT_EQ(reports[1].data[1], 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
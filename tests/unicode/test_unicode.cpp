@@ -0,0 +1,202 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keyboard_report_util.hpp"
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "deferred_exec.h"
+#include "process_unicode_common.h"
+}
+
+using testing::_;
+using testing::InSequence;
+
+class Unicode : public TestFixture {
+   protected:
+    KeymapKey key_a = KeymapKey(0, 0, 0, KC_A);
+
+    std::vector<report_keyboard_t> reports;
+
+    void record_reports(TestDriver &driver) {
+        EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(testing::Invoke([this](const report_keyboard_t &report) { reports.push_back(report); }));
+    }
+
+    // Index of the first recorded report holding keycode, or -1
+    int find_report(uint8_t keycode, int from = 0) {
+        for (int i = from; i < (int)reports.size(); i++) {
+            for (auto key : reports[i].keys) {
+                if (key == keycode) return i;
+            }
+        }
+        return -1;
+    }
+
+    void SetUp() override { add_key(key_a); }
+
+    // The deferred executors are run from the main loop, not keyboard_task()
+    void run(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            run_one_scan_loop();
+            deferred_exec_task();
+        }
+    }
+};
+
+TEST_F(Unicode, LinuxDigitsShareReports) {
+    TestDriver driver;
+    InSequence s;
+    set_unicode_input_mode(UC_LNX);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT, KC_U)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    // U+00E9: the repeated zero needs a release in between, the other digits do not
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_0)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_0)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_9)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_SPACE)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+
+    send_unicode_string("é");
+    run(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Unicode, OutputDoesNotBlockScanning) {
+    TestDriver driver;
+    set_unicode_input_mode(UC_LNX);
+
+    // Nothing is typed from inside the call
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    send_unicode_string("éé");
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Keys pressed in the meantime are still processed
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    auto has_key_a = [](const report_keyboard_t &report) {
+        for (auto key : report.keys) {
+            if (key == KC_A) return true;
+        }
+        return false;
+    };
+    EXPECT_CALL(driver, send_keyboard_mock(testing::Truly(has_key_a))).Times(testing::AtLeast(1));
+    run(5);
+    key_a.press();
+    run(1);
+    key_a.release();
+    run(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Unicode, MacTypesQueuedCodePointsInOneSession) {
+    TestDriver driver;
+    InSequence s;
+    set_unicode_input_mode(UC_MAC);
+
+    // Option is pressed once for both characters
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT)));
+    for (int i = 0; i < 2; i++) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT, KC_0)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT, KC_0)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT, KC_E)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT, KC_9)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT)));
+    }
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+
+    send_unicode_string("éé");
+    run(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Unicode, FlushTypesPendingOutput) {
+    TestDriver driver;
+    set_unicode_input_mode(UC_LNX);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_SPACE))).Times(2);
+    send_unicode_hex_string("00E9 00e8");
+    unicode_flush();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Nothing is left for the deferred executor
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run(10);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(Unicode, KeyPressedDuringOutputFollowsIt) {
+    TestDriver driver;
+    set_unicode_input_mode(UC_LNX);
+    record_reports(driver);
+
+    send_unicode_string("éé");
+    run(5);
+    key_a.press();
+    run(1);
+    key_a.release();
+    run(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The space ends each character on Linux, both come before A
+    int first_space  = find_report(KC_SPACE);
+    int second_space = find_report(KC_SPACE, first_space + 1);
+    int a            = find_report(KC_A);
+    ASSERT_GE(first_space, 0);
+    ASSERT_GE(second_space, 0);
+    EXPECT_GT(a, second_space);
+}
+
+TEST_F(Unicode, HexStringIsTypedAsWritten) {
+    TestDriver driver;
+    set_unicode_input_mode(UC_WIN);
+    record_reports(driver);
+
+    // Above U+FFFF, which register_unicode() does not send on Windows
+    send_unicode_hex_string("1F600");
+    run(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    int one = find_report(KC_KP_1);
+    int f   = find_report(KC_F, one);
+    int six = find_report(KC_KP_6, f);
+    EXPECT_GE(one, 0);
+    EXPECT_GE(f, 0);
+    EXPECT_GE(six, 0);
+}
+
+TEST_F(Unicode, InvalidHexStringIsSentAsString) {
+    TestDriver driver;
+    set_unicode_input_mode(UC_LNX);
+    record_reports(driver);
+
+    send_unicode_hex_string("00e9 zz");
+    run(50);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Instead of U+0000, after the queued character
+    EXPECT_GT(find_report(KC_Z), find_report(KC_9));
+    EXPECT_EQ(find_report(KC_0, find_report(KC_9)), -1);
+}
@@ -0,0 +1,124 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "wpm.h"
+}
+
+using testing::_;
+
+/* With the default 5 second window of 50 periods, a key every 100ms is one
+ * press per period, and 600 presses a minute make 120 words of 5 keys. */
+#define WINDOW_MS (WPM_SAMPLE_SECONDS * 1000)
+
+class Wpm : public TestFixture {
+   protected:
+    KeymapKey  key_a = KeymapKey(0, 0, 0, KC_A);
+    TestDriver driver;
+
+    void SetUp() override {
+        set_keymap({key_a});
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+        // Let whatever the previous test typed leave the window
+        idle_for(2 * WINDOW_MS);
+        reset_peak_wpm();
+        ASSERT_EQ(get_current_wpm(), 0);
+        ASSERT_EQ(get_burst_wpm(), 0);
+        ASSERT_EQ(get_peak_wpm(), 0);
+    }
+
+    void type_for(unsigned ms, unsigned interval) {
+        for (unsigned t = 0; t < ms; t += interval) {
+            key_a.press();
+            run_one_scan_loop();
+            key_a.release();
+            run_one_scan_loop();
+            idle_for(interval - 2);
+        }
+    }
+};
+
+TEST_F(Wpm, SteadyRate) {
+    type_for(2 * WINDOW_MS, 100);
+
+    EXPECT_NEAR(get_current_wpm(), 120, 3);
+    EXPECT_NEAR(get_burst_wpm(), 120, 3);
+    EXPECT_GE(get_peak_wpm(), get_current_wpm());
+}
+
+TEST_F(Wpm, RampsUpOverTheWindow) {
+    type_for(2000, 100);
+
+    // Less than half the window has presses in it
+    EXPECT_LT(get_current_wpm(), 60);
+    // The burst periods are all filled already
+    EXPECT_NEAR(get_burst_wpm(), 120, 3);
+}
+
+TEST_F(Wpm, DecaysAfterTypingStops) {
+    type_for(2 * WINDOW_MS, 100);
+    uint8_t typing = get_current_wpm();
+
+    uint8_t last = typing;
+    for (int i = 0; i < 10; i++) {
+        idle_for(100);
+        EXPECT_LE(get_current_wpm(), last);
+        last = get_current_wpm();
+    }
+    EXPECT_LT(last, typing - 10);
+    EXPECT_GT(last, 0);
+    // The burst periods hold no presses anymore
+    idle_for(100);
+    EXPECT_EQ(get_burst_wpm(), 0);
+
+    idle_for(2 * WINDOW_MS);
+    EXPECT_EQ(get_current_wpm(), 0);
+    EXPECT_EQ(get_burst_wpm(), 0);
+}
+
+TEST_F(Wpm, BurstAndPeak) {
+    type_for(2 * WINDOW_MS, 100);
+    uint8_t steady = get_peak_wpm();
+    EXPECT_NEAR(steady, 120, 3);
+
+    // Twice as fast for a little longer than the burst periods
+    type_for((WPM_BURST_PERIODS + 1) * 100, 50);
+    EXPECT_NEAR(get_burst_wpm(), 240, 3);
+    EXPECT_GT(get_current_wpm(), steady);
+    EXPECT_LT(get_current_wpm(), get_burst_wpm());
+    EXPECT_GE(get_peak_wpm(), get_current_wpm());
+
+    // The peak stays after typing stops, until it is reset
+    idle_for(2 * WINDOW_MS);
+    EXPECT_EQ(get_current_wpm(), 0);
+    EXPECT_GT(get_peak_wpm(), steady);
+    reset_peak_wpm();
+    EXPECT_EQ(get_peak_wpm(), 0);
+}
+
+TEST_F(Wpm, SingleKeypressIsNotCounted) {
+    type_for(100, 100);
+    idle_for(500);
+
+    EXPECT_EQ(get_current_wpm(), 0);
+    EXPECT_EQ(get_burst_wpm(), 0);
+}
@@ -0,0 +1,82 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keycode.h"
+#include "test_common.hpp"
+#include "test_fixture.hpp"
+#include "test_keymap_key.hpp"
+
+extern "C" {
+#include "wpm.h"
+}
+
+using testing::_;
+
+#define WINDOW_MS (WPM_SAMPLE_SECONDS * 1000)
+
+class WpmLaunchControl : public TestFixture {
+   protected:
+    KeymapKey  key_a = KeymapKey(0, 0, 0, KC_A);
+    TestDriver driver;
+
+    void SetUp() override {
+        set_keymap({key_a});
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+
+        idle_for(2 * WINDOW_MS);
+        reset_peak_wpm();
+        ASSERT_EQ(get_current_wpm(), 0);
+    }
+
+    void type_for(unsigned ms, unsigned interval) {
+        for (unsigned t = 0; t < ms; t += interval) {
+            key_a.press();
+            run_one_scan_loop();
+            key_a.release();
+            run_one_scan_loop();
+            idle_for(interval - 2);
+        }
+    }
+};
+
+TEST_F(WpmLaunchControl, ReachesTheRateBeforeTheWindowFills) {
+    type_for(1000, 100);
+
+    // Only the periods since typing started count, the filter is the only lag
+    EXPECT_GT(get_current_wpm(), 100);
+    EXPECT_LE(get_current_wpm(), 123);
+    EXPECT_NEAR(get_burst_wpm(), 120, 3);
+}
+
+TEST_F(WpmLaunchControl, RestartsAfterTheWindowEmpties) {
+    type_for(2 * WINDOW_MS, 100);
+    EXPECT_NEAR(get_current_wpm(), 120, 3);
+
+    idle_for(2 * WINDOW_MS);
+    EXPECT_EQ(get_current_wpm(), 0);
+
+    // Half the rate, picked up just as quickly
+    type_for(1000, 200);
+    EXPECT_GT(get_current_wpm(), 50);
+    EXPECT_LE(get_current_wpm(), 63);
+}
+
+TEST_F(WpmLaunchControl, SteadyRate) {
+    type_for(2 * WINDOW_MS, 100);
+
+    EXPECT_NEAR(get_current_wpm(), 120, 3);
+    EXPECT_NEAR(get_burst_wpm(), 120, 3);
+}
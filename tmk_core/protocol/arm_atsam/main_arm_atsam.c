@@ -156,6 +156,11 @@ int8_t sendchar(uint8_t c) {
     return 0;
 }
 
+uint8_t sendchar_space(void) {
+    uint16_t space = CONSOLE_PRINTBUF_SIZE - console_printbuf_len;
+    return space > UINT8_MAX ? UINT8_MAX : space;
+}
+
 void main_subtask_console_flush(void) {
     while (udi_hid_con_b_report_trans_ongoing) {
     }  // Wait for any previous transfers to complete
@@ -720,13 +720,16 @@ static void udi_hid_raw_report_sent(udd_ep_status_t status, iram_size_t nb_sent,
 
 static void udi_hid_raw_setreport_valid(void) {}
 
-void raw_hid_send(uint8_t *data, uint8_t length) {
+bool raw_hid_try_send(uint8_t *data, uint8_t length) {
     if (main_b_raw_enable && !udi_hid_raw_b_report_trans_ongoing && length == UDI_HID_RAW_REPORT_SIZE) {
         memcpy(udi_hid_raw_report, data, UDI_HID_RAW_REPORT_SIZE);
-        udi_hid_raw_send_report();
+        return udi_hid_raw_send_report();
     }
+    return false;
 }
 
+void raw_hid_send(uint8_t *data, uint8_t length) { raw_hid_try_send(data, length); }
+
 bool udi_hid_raw_receive_report(void) {
     if (!main_b_raw_enable) {
         return false;
@@ -42,6 +42,7 @@
 #include "usb_device_state.h"
 #include "usb_descriptor.h"
 #include "usb_driver.h"
+#include "ring_buffer.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -387,35 +388,18 @@ static usb_driver_configs_t drivers = {
  */
 
 #define USB_EVENT_QUEUE_SIZE 16
-usbevent_t event_queue[USB_EVENT_QUEUE_SIZE];
-uint8_t    event_queue_head;
-uint8_t    event_queue_tail;
+static usbevent_t    event_queue_data[USB_EVENT_QUEUE_SIZE];
+static ring_buffer_t event_queue = RING_BUFFER_INIT(event_queue_data);
 
 void usb_event_queue_init(void) {
     // Initialise the event queue
-    memset(&event_queue, 0, sizeof(event_queue));
-    event_queue_head = 0;
-    event_queue_tail = 0;
+    ring_buffer_clear(&event_queue);
 }
 
-static inline bool usb_event_queue_enqueue(usbevent_t event) {
-    uint8_t next = (event_queue_head + 1) % USB_EVENT_QUEUE_SIZE;
-    if (next == event_queue_tail) {
-        return false;
-    }
-    event_queue[event_queue_head] = event;
-    event_queue_head              = next;
-    return true;
-}
+// Called from the USB interrupt, the events are handled by the main loop
+static inline bool usb_event_queue_enqueue(usbevent_t event) { return ring_buffer_push(&event_queue, &event); }
 
-static inline bool usb_event_queue_dequeue(usbevent_t *event) {
-    if (event_queue_head == event_queue_tail) {
-        return false;
-    }
-    *event           = event_queue[event_queue_tail];
-    event_queue_tail = (event_queue_tail + 1) % USB_EVENT_QUEUE_SIZE;
-    return true;
-}
+static inline bool usb_event_queue_dequeue(usbevent_t *event) { return ring_buffer_pop(&event_queue, event); }
 
 static inline void usb_event_suspend_handler(void) {
     usb_device_state_set_suspend(USB_DRIVER.configuration != 0, USB_DRIVER.configuration);
@@ -506,6 +490,9 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
         case USB_EVENT_UNCONFIGURED:
             /* Falls into.*/
         case USB_EVENT_RESET:
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+            host_mouse_resolution_reset();
+#endif
             usb_event_queue_enqueue(event);
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
                 chSysLockFromISR();
@@ -583,6 +570,12 @@ static bool usb_request_hook_cb(USBDriver *usbp) {
             case USB_RTYPE_DIR_DEV2HOST:
                 switch (usbp->setup[1]) { /* bRequest */
                     case HID_GET_REPORT:
+#if defined(MOUSE_ENABLE) && defined(POINTING_DEVICE_HIRES_SCROLL_ENABLE)
+                        if (is_mouse_resolution_request(get_hword(&usbp->setup[2]), get_hword(&usbp->setup[4]))) {
+                            usbSetupTransfer(usbp, (uint8_t *)&mouse_resolution_report, sizeof(mouse_resolution_report), NULL);
+                            return TRUE;
+                        }
+#endif
                         switch (usbp->setup[4]) { /* LSB(wIndex) (check MSB==0?) */
                             case KEYBOARD_INTERFACE:
                                 usbSetupTransfer(usbp, (uint8_t *)&keyboard_report_sent, sizeof(keyboard_report_sent), NULL);
@@ -620,6 +613,12 @@ static bool usb_request_hook_cb(USBDriver *usbp) {
             case USB_RTYPE_DIR_HOST2DEV:
                 switch (usbp->setup[1]) { /* bRequest */
                     case HID_SET_REPORT:
+#if defined(MOUSE_ENABLE) && defined(POINTING_DEVICE_HIRES_SCROLL_ENABLE)
+                        if (is_mouse_resolution_request(get_hword(&usbp->setup[2]), get_hword(&usbp->setup[4]))) {
+                            usbSetupTransfer(usbp, (uint8_t *)&mouse_resolution_report, sizeof(mouse_resolution_report), NULL);
+                            return TRUE;
+                        }
+#endif
                         switch (usbp->setup[4]) { /* LSB(wIndex) (check MSB==0?) */
                             case KEYBOARD_INTERFACE:
 #if defined(SHARED_EP_ENABLE) && !defined(KEYBOARD_SHARED_EP)
@@ -906,6 +905,7 @@ void send_mouse(report_mouse_t *report) {
          * no interrupts served, so USB not going through as well.
          * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
         if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[MOUSE_IN_EPNUM]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
+            host_invalidate_reports();
             osalSysUnlock();
             return;
         }
@@ -950,6 +950,7 @@ static void send_extra(uint8_t report_id, uint16_t data) {
          * no interrupts served, so USB not going through as well.
          * Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
         if (osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[SHARED_IN_EPNUM]->in_state->thread, TIME_MS2I(10)) == MSG_TIMEOUT) {
+            host_invalidate_reports();
             osalSysUnlock();
             return;
         }
@@ -999,35 +1000,72 @@ void send_digitizer(report_digitizer_t *report) {
 
 #ifdef CONSOLE_ENABLE
 
-int8_t sendchar(uint8_t c) {
-    static bool timed_out = false;
-    /* The `timed_out` state is an approximation of the ideal `is_listener_disconnected?` state.
-     *
-     * When a 5ms timeout write has timed out, hid_listen is most likely not running, or not
-     * listening to this keyboard, so we go into the timed_out state. In this state we assume
-     * that hid_listen is most likely not gonna be connected to us any time soon, so it would
-     * be wasteful to write follow-up characters with a 5ms timeout, it would all add up and
-     * unncecessarily slow down the firmware. However instead of just dropping the characters,
-     * we write them with a TIME_IMMEDIATE timeout, which is a zero timeout,
-     * and this will succeed only if hid_listen gets connected again. When a write with
-     * TIME_IMMEDIATE timeout succeeds, we know that hid_listen is listening to us again, and
-     * we can go back to the timed_out = false state, and following writes will be executed
-     * with a 5ms timeout. The reason we don't just send all characters with the TIME_IMMEDIATE
-     * timeout is that this could cause bytes to be lost even if hid_listen is running, if there
-     * is a lot of data being sent over the console.
-     *
-     * This logic will work correctly as long as hid_listen is able to receive at least 200
-     * bytes per second. On a heavily overloaded machine that's so overloaded that it's
-     * unusable, and constantly swapping, hid_listen might have trouble receiving 200 bytes per
-     * second, so some bytes might be lost on the console.
-     */
+#    ifndef CONSOLE_OUTPUT_BUFFER_SIZE
+#        define CONSOLE_OUTPUT_BUFFER_SIZE 255
+#    elif CONSOLE_OUTPUT_BUFFER_SIZE > 255
+#        error CONSOLE_OUTPUT_BUFFER_SIZE must be at most 255
+#    elif CONSOLE_OUTPUT_BUFFER_SIZE <= CONSOLE_EPSIZE
+// One byte of the buffer is always left empty
+#        error CONSOLE_OUTPUT_BUFFER_SIZE must be larger than CONSOLE_EPSIZE, to hold a full packet
+#    endif
+
+/* Output is queued here and sent from console_task() in whole packets, so
+ * printing never waits on the USB driver; sendchar() only sends once the
+ * buffer is full. sendchar() and console_task() both run in the main loop,
+ * the buffer is the only thing they share. */
+static uint8_t       console_buf_data[CONSOLE_OUTPUT_BUFFER_SIZE];
+static ring_buffer_t console_buf = RING_BUFFER_INIT(console_buf_data);
+static uint32_t      console_dropped;
+static uint8_t       console_last_count;
+
+/* Hands packets to the driver's output queue for as long as it has room.
+ * With `partial` set, a packet that is not full is sent as well, padded with
+ * zeros as the driver would do. */
+static void console_send_packets(bool partial) {
+    uint8_t packet[CONSOLE_EPSIZE];
+
+    while (!ring_buffer_empty(&console_buf)) {
+        uint8_t count = ring_buffer_count(&console_buf);
+        if (count > CONSOLE_EPSIZE) {
+            count = CONSOLE_EPSIZE;
+        } else if (count < CONSOLE_EPSIZE && !partial) {
+            break;
+        }
+
+        for (uint8_t i = 0; i < count; i++) {
+            ring_buffer_peek_at(&console_buf, i, &packet[i]);
+        }
+        memset(&packet[count], 0, CONSOLE_EPSIZE - count);
+
+        // A whole packet fills one buffer of the queue, so it is either taken or not
+        if (chnWriteTimeout(&drivers.console_driver.driver, packet, CONSOLE_EPSIZE, TIME_IMMEDIATE) != CONSOLE_EPSIZE) {
+            break;
+        }
+        ring_buffer_drop(&console_buf, count);
+    }
+
+    console_last_count = ring_buffer_count(&console_buf);
+}
 
-    const sysinterval_t timeout = timed_out ? TIME_IMMEDIATE : TIME_MS2I(5);
-    const size_t        result  = chnWriteTimeout(&drivers.console_driver.driver, &c, 1, timeout);
-    timed_out                   = (result == 0);
-    return result;
+int8_t sendchar(uint8_t c) {
+    if (!ring_buffer_push(&console_buf, &c)) {
+        // Hand whole packets to the driver's queue first, which does not wait either
+        console_send_packets(false);
+        if (!ring_buffer_push(&console_buf, &c)) {
+            // hid_listen is not running, or cannot keep up
+            console_dropped++;
+            return 0;
+        }
+    }
+    return 1;
 }
 
+uint8_t sendchar_space(void) { return ring_buffer_space(&console_buf); }
+
+uint32_t console_dropped_count(void) { return console_dropped; }
+
+void console_flush_output(void) { console_send_packets(true); }
+
 // Just a dummy function for now, this could be exposed as a weak function
 // Or connected to the actual QMK console
 static void console_receive(uint8_t *data, uint8_t length) {
@@ -1036,6 +1074,9 @@ static void console_receive(uint8_t *data, uint8_t length) {
 }
 
 void console_task(void) {
+    // A packet that is not full is held back for as long as more output keeps arriving
+    console_send_packets(ring_buffer_count(&console_buf) == console_last_count);
+
     uint8_t buffer[CONSOLE_EPSIZE];
     size_t  size = 0;
     do {
@@ -1057,6 +1098,13 @@ void raw_hid_send(uint8_t *data, uint8_t length) {
     chnWrite(&drivers.raw_driver.driver, data, length);
 }
 
+bool raw_hid_try_send(uint8_t *data, uint8_t length) {
+    if (length != RAW_EPSIZE) {
+        return false;
+    }
+    return chnWriteTimeout(&drivers.raw_driver.driver, data, length, TIME_IMMEDIATE) == length;
+}
+
 __attribute__((weak)) void raw_hid_receive(uint8_t *data, uint8_t length) {
     // Users should #include "raw_hid.h" in their own code
     // and implement this function there. Leave this as weak linkage
@@ -1103,6 +1151,8 @@ void virtser_init(void) {}
 
 void virtser_send(const uint8_t byte) { chnWrite(&drivers.serial_driver.driver, &byte, 1); }
 
+uint8_t virtser_write(const uint8_t *data, uint8_t length) { return chnWriteTimeout(&drivers.serial_driver.driver, data, length, TIME_IMMEDIATE); }
+
 __attribute__((weak)) void virtser_recv(uint8_t c) {
     // Ignore by default
 }
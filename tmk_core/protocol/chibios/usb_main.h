@@ -92,10 +92,13 @@ void shared_in_cb(USBDriver *usbp, usbep_t ep);
 
 #ifdef CONSOLE_ENABLE
 
-/* Putchar over the USB console */
+/* Putchar over the USB console, buffered until console_task() sends it */
 int8_t sendchar(uint8_t c);
 
 /* Flush output (send everything immediately) */
 void console_flush_output(void);
 
+/* Bytes dropped because the console buffer was full */
+uint32_t console_dropped_count(void);
+
 #endif /* CONSOLE_ENABLE */
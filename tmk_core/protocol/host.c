@@ -16,6 +16,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <stdint.h>
+#include <string.h>
 //#include <avr/interrupt.h>
 #include "keyboard.h"
 #include "keycode.h"
@@ -23,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "util.h"
 #include "debug.h"
 #include "digitizer.h"
+#include "trace.h"
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -34,6 +36,27 @@ static uint16_t       last_system_report              = 0;
 static uint16_t       last_consumer_report            = 0;
 static uint32_t       last_programmable_button_report = 0;
 
+#ifdef HOST_REPORT_DEDUPLICATION
+/* Shadows of the last report of each type that reached the driver, so
+ * unchanged reports are not sent again. They are not valid until a report has
+ * been sent, and after the host may have forgotten it. */
+static report_keyboard_t  last_keyboard_report;
+static uint8_t            last_keyboard_report_size;
+static report_mouse_t     last_mouse_report;
+static bool               last_mouse_report_valid;
+static report_digitizer_t last_digitizer_report;
+static bool               last_digitizer_report_valid;
+static host_report_stats_t report_stats;
+#endif
+
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+report_mouse_resolution_t mouse_resolution_report = {
+#    ifdef MOUSE_SHARED_EP
+    .report_id = REPORT_ID_MOUSE,
+#    endif
+};
+#endif
+
 void host_set_driver(host_driver_t *d) { driver = d; }
 
 host_driver_t *host_get_driver(void) { return driver; }
@@ -53,6 +76,43 @@ uint8_t host_keyboard_leds(void) {
 
 led_t host_keyboard_led_state(void) { return (led_t)host_keyboard_leds(); }
 
+#ifdef HOST_REPORT_DEDUPLICATION
+host_report_stats_t host_get_report_stats(void) { return report_stats; }
+
+void host_clear_report_stats(void) { memset(&report_stats, 0, sizeof(report_stats)); }
+#endif
+
+void host_invalidate_reports(void) {
+#ifdef HOST_REPORT_DEDUPLICATION
+    last_keyboard_report_size       = 0;
+    last_mouse_report_valid         = false;
+    last_digitizer_report_valid     = false;
+    last_system_report              = 0;
+    last_consumer_report            = 0;
+    last_programmable_button_report = 0;
+#endif
+}
+
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+uint16_t host_mouse_wheel_multiplier(uint8_t axis) { return mouse_resolution_report.multipliers & axis ? POINTING_DEVICE_HIRES_SCROLL_MULTIPLIER : 1; }
+
+void host_mouse_resolution_reset(void) { mouse_resolution_report.multipliers = 0; }
+#endif
+
+#ifdef HOST_REPORT_DEDUPLICATION
+/* Counts a report, returns false if it should be suppressed */
+static bool host_report_changed(uint8_t type, bool changed) {
+    if (changed) {
+        report_stats.sent[type]++;
+    } else {
+        report_stats.suppressed[type]++;
+    }
+    return changed;
+}
+#else
+#    define host_report_changed(type, changed) (changed)
+#endif
+
 /* send report */
 void host_keyboard_send(report_keyboard_t *report) {
     if (!driver) return;
@@ -70,7 +130,26 @@ void host_keyboard_send(report_keyboard_t *report) {
         report->report_id = REPORT_ID_KEYBOARD;
 #endif
     }
+
+#ifdef HOST_REPORT_DEDUPLICATION
+    /* A change between the 6KRO and NKRO layouts also changes the size */
+    uint8_t size = KEYBOARD_REPORT_SIZE;
+#    ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) size = sizeof(report->nkro);
+#    endif
+    if (!host_report_changed(HOST_REPORT_KEYBOARD, size != last_keyboard_report_size || memcmp(&last_keyboard_report, report, size) != 0)) return;
+    memcpy(&last_keyboard_report, report, size);
+    last_keyboard_report_size = size;
+#endif
     (*driver->send_keyboard)(report);
+#ifdef TRACE_ENABLE
+    uint8_t mods = report->mods;
+#    ifdef NKRO_ENABLE
+    // Sent from the NKRO layout, where the mods can be at another offset
+    if (keyboard_protocol && keymap_config.nkro) mods = report->nkro.mods;
+#    endif
+    trace_event(TRACE_REPORT_KEYBOARD, mods, get_first_key(report), has_anykey(report));
+#endif
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
@@ -85,24 +164,34 @@ void host_mouse_send(report_mouse_t *report) {
     if (!driver) return;
 #ifdef MOUSE_SHARED_EP
     report->report_id = REPORT_ID_MOUSE;
+#endif
+#ifdef HOST_REPORT_DEDUPLICATION
+    /* Movement is relative, so a repeated report with movement is still a new one */
+    bool moved = report->x || report->y || report->v || report->h;
+    if (!host_report_changed(HOST_REPORT_MOUSE, moved || !last_mouse_report_valid || memcmp(&last_mouse_report, report, sizeof(*report)) != 0)) return;
+    last_mouse_report       = *report;
+    last_mouse_report_valid = true;
 #endif
     (*driver->send_mouse)(report);
+    trace_event(TRACE_REPORT_MOUSE, report->buttons, report->x, report->y);
 }
 
 void host_system_send(uint16_t report) {
-    if (report == last_system_report) return;
+    if (!driver) return;
+    if (!host_report_changed(HOST_REPORT_SYSTEM, report != last_system_report)) return;
     last_system_report = report;
 
-    if (!driver) return;
     (*driver->send_system)(report);
+    trace_event(TRACE_REPORT_SYSTEM, 0, report, 0);
 }
 
 void host_consumer_send(uint16_t report) {
-    if (report == last_consumer_report) return;
+    if (!driver) return;
+    if (!host_report_changed(HOST_REPORT_CONSUMER, report != last_consumer_report)) return;
     last_consumer_report = report;
 
-    if (!driver) return;
     (*driver->send_consumer)(report);
+    trace_event(TRACE_REPORT_CONSUMER, 0, report, 0);
 }
 
 void host_digitizer_send(digitizer_t *digitizer) {
@@ -118,16 +207,21 @@ void host_digitizer_send(digitizer_t *digitizer) {
         .y       = (uint16_t)(digitizer->y * 0x7FFF),
     };
 
+#ifdef HOST_REPORT_DEDUPLICATION
+    if (!host_report_changed(HOST_REPORT_DIGITIZER, !last_digitizer_report_valid || memcmp(&last_digitizer_report, &report, sizeof(report)) != 0)) return;
+    last_digitizer_report       = report;
+    last_digitizer_report_valid = true;
+#endif
     send_digitizer(&report);
 }
 
 __attribute__((weak)) void send_digitizer(report_digitizer_t *report) {}
 
 void host_programmable_button_send(uint32_t report) {
-    if (report == last_programmable_button_report) return;
+    if (!driver) return;
+    if (!host_report_changed(HOST_REPORT_PROGRAMMABLE_BUTTON, report != last_programmable_button_report)) return;
     last_programmable_button_report = report;
 
-    if (!driver) return;
     (*driver->send_programmable_button)(report);
 }
 
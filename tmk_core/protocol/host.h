@@ -33,6 +33,24 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 extern "C" {
 #endif
 
+#ifdef HOST_REPORT_DEDUPLICATION
+enum host_report_type {
+    HOST_REPORT_KEYBOARD,
+    HOST_REPORT_MOUSE,
+    HOST_REPORT_SYSTEM,
+    HOST_REPORT_CONSUMER,
+    HOST_REPORT_DIGITIZER,
+    HOST_REPORT_PROGRAMMABLE_BUTTON,
+    HOST_REPORT_TYPES,
+};
+
+/* Indexed by host_report_type */
+typedef struct {
+    uint32_t sent[HOST_REPORT_TYPES];
+    uint32_t suppressed[HOST_REPORT_TYPES];
+} host_report_stats_t;
+#endif
+
 extern uint8_t keyboard_idle;
 extern uint8_t keyboard_protocol;
 
@@ -53,6 +71,25 @@ uint16_t host_last_system_report(void);
 uint16_t host_last_consumer_report(void);
 uint32_t host_last_programmable_button_report(void);
 
+#ifdef HOST_REPORT_DEDUPLICATION
+/* Reports that were passed on to the host driver, and unchanged ones that were not */
+host_report_stats_t host_get_report_stats(void);
+void                host_clear_report_stats(void);
+#endif
+/* Send the next report of every type, e.g. after the host was reset. Drivers
+ * call this when they drop a report, which the host then never received. */
+void host_invalidate_reports(void);
+
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+/* Resolution Multiplier feature report, as last set by the host */
+extern report_mouse_resolution_t mouse_resolution_report;
+
+/* Wheel units per detent the host expects on an axis, MOUSE_RESOLUTION_MULTIPLIER_V or _H */
+uint16_t host_mouse_wheel_multiplier(uint8_t axis);
+/* Back to one unit per detent, the host sets the multiplier again after a reset */
+void host_mouse_resolution_reset(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
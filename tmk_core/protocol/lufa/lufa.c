@@ -179,14 +179,14 @@ USB_ClassInfo_CDC_Device_t cdc_device = {
  *
  * FIXME: Needs doc
  */
-void raw_hid_send(uint8_t *data, uint8_t length) {
+bool raw_hid_try_send(uint8_t *data, uint8_t length) {
     // TODO: implement variable size packet
     if (length != RAW_EPSIZE) {
-        return;
+        return false;
     }
 
     if (USB_DeviceState != DEVICE_STATE_Configured) {
-        return;
+        return false;
     }
 
     // TODO: decide if we allow calls to raw_hid_send() in the middle
@@ -196,7 +196,8 @@ void raw_hid_send(uint8_t *data, uint8_t length) {
     Endpoint_SelectEndpoint(RAW_IN_EPNUM);
 
     // Check to see if the host is ready to accept another packet
-    if (Endpoint_IsINReady()) {
+    bool ready = Endpoint_IsINReady();
+    if (ready) {
         // Write data
         Endpoint_Write_Stream_LE(data, RAW_EPSIZE, NULL);
         // Finalize the stream transfer to send the last packet
@@ -204,8 +205,11 @@ void raw_hid_send(uint8_t *data, uint8_t length) {
     }
 
     Endpoint_SelectEndpoint(ep);
+    return ready;
 }
 
+void raw_hid_send(uint8_t *data, uint8_t length) { raw_hid_try_send(data, length); }
+
 /** \brief Raw HID Receive
  *
  * FIXME: Needs doc
@@ -418,6 +422,9 @@ void EVENT_USB_Device_Disconnect(void) {
 void EVENT_USB_Device_Reset(void) {
     print("[R]");
     usb_device_state_set_reset();
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+    host_mouse_resolution_reset();
+#endif
 }
 
 /** \brief Event USB Device Connect
@@ -576,6 +583,13 @@ void EVENT_USB_Device_ControlRequest(void) {
                         ReportSize = sizeof(keyboard_report_sent);
                         break;
                 }
+#if defined(MOUSE_ENABLE) && defined(POINTING_DEVICE_HIRES_SCROLL_ENABLE)
+                // The keyboard may share the interface
+                if (is_mouse_resolution_request(USB_ControlRequest.wValue, USB_ControlRequest.wIndex)) {
+                    ReportData = (uint8_t *)&mouse_resolution_report;
+                    ReportSize = sizeof(mouse_resolution_report);
+                }
+#endif
 
                 /* Write the report data to the control endpoint */
                 Endpoint_Write_Control_Stream_LE(ReportData, ReportSize);
@@ -585,6 +599,14 @@ void EVENT_USB_Device_ControlRequest(void) {
             break;
         case HID_REQ_SetReport:
             if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE)) {
+#if defined(MOUSE_ENABLE) && defined(POINTING_DEVICE_HIRES_SCROLL_ENABLE)
+                if (is_mouse_resolution_request(USB_ControlRequest.wValue, USB_ControlRequest.wIndex)) {
+                    Endpoint_ClearSETUP();
+                    Endpoint_Read_Control_Stream_LE(&mouse_resolution_report, sizeof(mouse_resolution_report));
+                    Endpoint_ClearIN();
+                    break;
+                }
+#endif
                 // Interface
                 switch (USB_ControlRequest.wIndex) {
                     case KEYBOARD_INTERFACE:
@@ -713,7 +735,10 @@ static void send_keyboard(report_keyboard_t *report) {
     Endpoint_SelectEndpoint(ep);
     /* Check if write ready for a polling interval around 10ms */
     while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
+    if (!Endpoint_IsReadWriteAllowed()) {
+        host_invalidate_reports();
+        return;
+    }
 
     /* If we're in Boot Protocol, don't send any report ID or other funky fields */
     if (!keyboard_protocol) {
@@ -761,7 +786,10 @@ static void send_mouse(report_mouse_t *report) {
 
     /* Check if write ready for a polling interval around 10ms */
     while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
+    if (!Endpoint_IsReadWriteAllowed()) {
+        host_invalidate_reports();
+        return;
+    }
 
     /* Write Mouse Report Data */
     Endpoint_Write_Stream_LE(report, sizeof(report_mouse_t), NULL);
@@ -781,7 +809,10 @@ static void send_report(void *report, size_t size) {
 
     /* Check if write ready for a polling interval around 10ms */
     while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
+    if (!Endpoint_IsReadWriteAllowed()) {
+        host_invalidate_reports();
+        return;
+    }
 
     Endpoint_Write_Stream_LE(report, size, NULL);
     Endpoint_ClearIN();
@@ -1009,6 +1040,45 @@ void virtser_send(const uint8_t byte) {
         Endpoint_SelectEndpoint(ep);
     }
 }
+
+/** \brief Virtual Serial Write
+ *
+ * Send as much of data as fits in one short packet, without waiting for the host.
+ * Returns the number of bytes consumed, which is 0 while the host has not collected the previous packet.
+ * Like virtser_send(), data is discarded while no terminal is attached.
+ */
+uint8_t virtser_write(const uint8_t *data, uint8_t length) {
+    uint8_t written = 0;
+    uint8_t ep      = Endpoint_GetCurrentEndpoint();
+
+    if (!(cdc_device.State.ControlLineStates.HostToDevice & CDC_CONTROL_LINE_OUT_DTR)) {
+        return length;
+    }
+
+    Endpoint_SelectEndpoint(cdc_device.Config.DataINEndpoint.Address);
+
+    if (!Endpoint_IsEnabled() || !Endpoint_IsConfigured()) {
+        Endpoint_SelectEndpoint(ep);
+        return length;
+    }
+
+    if (!Endpoint_IsINReady()) {
+        Endpoint_SelectEndpoint(ep);
+        return 0;
+    }
+
+    // A full packet would need a zero length packet after it to end the transfer, which means waiting on the host
+    if (length > CDC_EPSIZE - 1) {
+        length = CDC_EPSIZE - 1;
+    }
+    while (written < length && Endpoint_IsReadWriteAllowed()) {
+        Endpoint_Write_8(data[written++]);
+    }
+    Endpoint_ClearIN();
+
+    Endpoint_SelectEndpoint(ep);
+    return written;
+}
 #endif
 
 void send_digitizer(report_digitizer_t *report) {
@@ -1021,7 +1091,10 @@ void send_digitizer(report_digitizer_t *report) {
 
     /* Check if write ready for a polling interval around 10ms */
     while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-    if (!Endpoint_IsReadWriteAllowed()) return;
+    if (!Endpoint_IsReadWriteAllowed()) {
+        host_invalidate_reports();
+        return;
+    }
 
     Endpoint_Write_Stream_LE(report, sizeof(report_digitizer_t), NULL);
     Endpoint_ClearIN();
@@ -47,7 +47,7 @@ extern "C" {
  */
 
 #include "midi_function_types.h"
-#include "bytequeue/bytequeue.h"
+#include "ring_buffer.h"
 #define MIDI_INPUT_QUEUE_LENGTH 192
 
 typedef enum { IDLE, ONE_BYTE_MESSAGE = 1, TWO_BYTE_MESSAGE = 2, THREE_BYTE_MESSAGE = 3, SYSEX_MESSAGE } input_state_t;
@@ -102,8 +102,8 @@ struct _midi_device {
     uint16_t      input_count;
 
     // for queueing data between the input and the processing functions
-    uint8_t     input_queue_data[MIDI_INPUT_QUEUE_LENGTH];
-    byteQueue_t input_queue;
+    uint8_t       input_queue_data[MIDI_INPUT_QUEUE_LENGTH];
+    ring_buffer_t input_queue;
 };
 
 /**
@@ -31,22 +31,44 @@ static int8_t cb_tail  = 0;
 static int8_t cb_count = 0;
 #endif
 
+#ifdef NKRO_ENABLE
+/* The NKRO bitmap is not word aligned in the packed report, so it is read a
+ * word at a time through memcpy, which is a single load on cores that allow
+ * unaligned access. */
+#    define NKRO_WORDS (KEYBOARD_REPORT_BITS / 4)
+
+static inline uint32_t nkro_word(const uint8_t* bits, uint8_t word) {
+    uint32_t w;
+    memcpy(&w, &bits[word * 4], sizeof(w));
+    return w;
+}
+
+static uint8_t nkro_count_keys(report_keyboard_t* keyboard_report) {
+    const uint8_t* bits = keyboard_report->nkro.bits;
+    uint8_t        cnt  = 0;
+    for (uint8_t i = 0; i < NKRO_WORDS; i++) {
+        cnt += bitpop32(nkro_word(bits, i));
+    }
+    for (uint8_t i = NKRO_WORDS * 4; i < KEYBOARD_REPORT_BITS; i++) {
+        cnt += bitpop(bits[i]);
+    }
+    return cnt;
+}
+#endif
+
 /** \brief has_anykey
  *
- * FIXME: Needs doc
+ * Returns the number of keys in the report, not counting modifiers
  */
 uint8_t has_anykey(report_keyboard_t* keyboard_report) {
-    uint8_t  cnt = 0;
-    uint8_t* p   = keyboard_report->keys;
-    uint8_t  lp  = sizeof(keyboard_report->keys);
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
-        p  = keyboard_report->nkro.bits;
-        lp = sizeof(keyboard_report->nkro.bits);
+        return nkro_count_keys(keyboard_report);
     }
 #endif
-    while (lp--) {
-        if (*p++) cnt++;
+    uint8_t cnt = 0;
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (keyboard_report->keys[i]) cnt++;
     }
     return cnt;
 }
@@ -58,10 +80,19 @@ uint8_t has_anykey(report_keyboard_t* keyboard_report) {
 uint8_t get_first_key(report_keyboard_t* keyboard_report) {
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
-        uint8_t i = 0;
-        for (; i < KEYBOARD_REPORT_BITS && !keyboard_report->nkro.bits[i]; i++)
-            ;
-        return i << 3 | biton(keyboard_report->nkro.bits[i]);
+        const uint8_t* bits = keyboard_report->nkro.bits;
+        uint8_t        i    = 0;
+        // skip empty words, then find the byte within the word
+        while (i < NKRO_WORDS * 4 && !nkro_word(bits, i / 4)) {
+            i += 4;
+        }
+        while (i < KEYBOARD_REPORT_BITS && !bits[i]) {
+            i++;
+        }
+        if (i == KEYBOARD_REPORT_BITS) {
+            return KC_NO;
+        }
+        return i << 3 | biton(bits[i]);
     }
 #endif
 #ifdef RING_BUFFERED_6KRO_REPORT_ENABLE
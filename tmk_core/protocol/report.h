@@ -124,7 +124,7 @@ enum desktop_usages {
 
 #define NKRO_SHARED_EP
 /* key report size(NKRO or boot mode) */
-#if defined(NKRO_ENABLE)
+#if defined(NKRO_ENABLE) && !defined(KEYBOARD_REPORT_BITS)
 #    if defined(PROTOCOL_LUFA) || defined(PROTOCOL_CHIBIOS)
 #        include "protocol/usb_descriptor.h"
 #        define KEYBOARD_REPORT_BITS (SHARED_EPSIZE - 2)
@@ -201,17 +201,64 @@ typedef struct {
     uint32_t usage;
 } __attribute__((packed)) report_programmable_button_t;
 
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+#    ifndef WHEEL_EXTENDED_REPORT
+#        define WHEEL_EXTENDED_REPORT
+#    endif
+/* wheel units per detent reported to the host once it enables the resolution multiplier */
+#    ifndef POINTING_DEVICE_HIRES_SCROLL_MULTIPLIER
+#        define POINTING_DEVICE_HIRES_SCROLL_MULTIPLIER 120
+#    endif
+#endif
+
+#if (defined(MOUSE_EXTENDED_REPORT) || defined(WHEEL_EXTENDED_REPORT)) && (defined(PROTOCOL_VUSB) || defined(PROTOCOL_ARM_ATSAM))
+#    error "Extended mouse reports are only supported with the LUFA and ChibiOS protocols"
+#endif
+
+#ifdef MOUSE_EXTENDED_REPORT
+#    define MOUSE_REPORT_XY_MIN -32767
+#    define MOUSE_REPORT_XY_MAX 32767
+typedef int16_t mouse_xy_report_t;
+#else
+#    define MOUSE_REPORT_XY_MIN -127
+#    define MOUSE_REPORT_XY_MAX 127
+typedef int8_t mouse_xy_report_t;
+#endif
+
+#ifdef WHEEL_EXTENDED_REPORT
+#    define MOUSE_REPORT_HV_MIN -32767
+#    define MOUSE_REPORT_HV_MAX 32767
+typedef int16_t mouse_hv_report_t;
+#else
+#    define MOUSE_REPORT_HV_MIN -127
+#    define MOUSE_REPORT_HV_MAX 127
+typedef int8_t mouse_hv_report_t;
+#endif
+
 typedef struct {
 #ifdef MOUSE_SHARED_EP
     uint8_t report_id;
 #endif
-    uint8_t buttons;
-    int8_t  x;
-    int8_t  y;
-    int8_t  v;
-    int8_t  h;
+    uint8_t           buttons;
+    mouse_xy_report_t x;
+    mouse_xy_report_t y;
+    mouse_hv_report_t v;
+    mouse_hv_report_t h;
 } __attribute__((packed)) report_mouse_t;
 
+#ifdef POINTING_DEVICE_HIRES_SCROLL_ENABLE
+/* Resolution Multiplier feature report, one 2 bit field per wheel axis */
+#    define MOUSE_RESOLUTION_MULTIPLIER_V (1 << 0)
+#    define MOUSE_RESOLUTION_MULTIPLIER_H (1 << 2)
+
+typedef struct {
+#    ifdef MOUSE_SHARED_EP
+    uint8_t report_id;
+#    endif
+    uint8_t multipliers;
+} __attribute__((packed)) report_mouse_resolution_t;
+#endif
+
 typedef struct {
 #ifdef DIGITIZER_SHARED_EP
     uint8_t report_id;
@@ -194,6 +194,21 @@ enum usb_interfaces {
     TOTAL_INTERFACES
 };
 
+#if defined(MOUSE_ENABLE) && defined(POINTING_DEVICE_HIRES_SCROLL_ENABLE)
+/* Report type in the high byte of wValue of Get_Report and Set_Report requests */
+#    define HID_REPORT_TYPE_FEATURE 0x03
+
+/* Whether a Get_Report or Set_Report request is for the Resolution Multiplier feature report */
+static inline bool is_mouse_resolution_request(uint16_t value, uint16_t index) {
+    if ((value >> 8) != HID_REPORT_TYPE_FEATURE) return false;
+#    ifdef MOUSE_SHARED_EP
+    return index == SHARED_INTERFACE && (value & 0xFF) == REPORT_ID_MOUSE;
+#    else
+    return index == MOUSE_INTERFACE;
+#    endif
+}
+#endif
+
 #define NEXT_EPNUM __COUNTER__
 
 /*
@@ -301,7 +316,11 @@ enum usb_endpoints {
 
 #define KEYBOARD_EPSIZE 8
 #define SHARED_EPSIZE 32
-#define MOUSE_EPSIZE 8
+#if defined(MOUSE_EXTENDED_REPORT) || defined(WHEEL_EXTENDED_REPORT)
+#    define MOUSE_EPSIZE 16
+#else
+#    define MOUSE_EPSIZE 8
+#endif
 #define RAW_EPSIZE 32
 #define CONSOLE_EPSIZE 32
 #define MIDI_STREAM_EPSIZE 64
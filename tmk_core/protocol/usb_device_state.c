@@ -16,6 +16,7 @@
  */
 
 #include "usb_device_state.h"
+#include "host.h"
 #if defined(HAPTIC_ENABLE)
 #    include "haptic.h"
 #endif
@@ -34,6 +35,7 @@ static void notify_usb_device_state_change(enum usb_device_state usb_device_stat
 }
 
 void usb_device_state_set_configuration(bool isConfigured, uint8_t configurationNumber) {
+    host_invalidate_reports();
     usb_device_state = isConfigured ? USB_DEVICE_STATE_CONFIGURED : USB_DEVICE_STATE_INIT;
     notify_usb_device_state_change(usb_device_state);
 }
@@ -49,6 +51,7 @@ void usb_device_state_set_resume(bool isConfigured, uint8_t configurationNumber)
 }
 
 void usb_device_state_set_reset(void) {
+    host_invalidate_reports();
     usb_device_state = USB_DEVICE_STATE_INIT;
     notify_usb_device_state_change(usb_device_state);
 }
@@ -36,7 +36,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #endif
 
 #if defined(CONSOLE_ENABLE)
-#    define RBUF_SIZE 128
 #    include "ring_buffer.h"
 #endif
 
@@ -150,6 +149,15 @@ void raw_hid_send(uint8_t *data, uint8_t length) {
     usbSetInterrupt4(0, 0);
 }
 
+bool raw_hid_try_send(uint8_t *data, uint8_t length) {
+    // Once the host takes the first part it keeps polling, so the rest only waits briefly
+    if (length != RAW_BUFFER_SIZE || !usbInterruptIsReady4()) {
+        return false;
+    }
+    raw_hid_send(data, length);
+    return true;
+}
+
 __attribute__((weak)) void raw_hid_receive(uint8_t *data, uint8_t length) {
     // Users should #include "raw_hid.h" in their own code
     // and implement this function there. Leave this as weak linkage
@@ -171,11 +179,16 @@ void raw_hid_task(void) {
 #    define CONSOLE_BUFFER_SIZE 32
 #    define CONSOLE_EPSIZE 8
 
+static uint8_t       console_buf_data[128];
+static ring_buffer_t console_buf = RING_BUFFER_INIT(console_buf_data);
+
 int8_t sendchar(uint8_t c) {
-    rbuf_enqueue(c);
+    ring_buffer_push(&console_buf, &c);
     return 0;
 }
 
+uint8_t sendchar_space(void) { return ring_buffer_space(&console_buf); }
+
 static inline bool usbSendData3(char *data, uint8_t len) {
     uint8_t retries = 5;
     while (!usbInterruptIsReady3()) {
@@ -194,15 +207,15 @@ void console_task(void) {
         return;
     }
 
-    if (!rbuf_has_data()) {
+    if (ring_buffer_empty(&console_buf)) {
         return;
     }
 
     // Send in chunks of 8 padded to 32
     char    send_buf[CONSOLE_BUFFER_SIZE] = {0};
     uint8_t send_buf_count                = 0;
-    while (rbuf_has_data() && send_buf_count < CONSOLE_EPSIZE) {
-        send_buf[send_buf_count++] = rbuf_dequeue();
+    while (send_buf_count < CONSOLE_EPSIZE && ring_buffer_pop(&console_buf, &send_buf[send_buf_count])) {
+        send_buf_count++;
     }
 
     char *temp = send_buf;
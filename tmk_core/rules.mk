@@ -75,6 +75,18 @@ ifneq ($(USE_CCACHE),no)
     CC_PREFIX ?= ccache
 endif
 
+# Share identical object files between builds through a content-addressed cache
+USE_COMPILE_CACHE ?= no
+COMPILE_CACHE_DIR ?= $(BUILD_DIR)/cache
+# in MiB, the least recently used objects are removed beyond this
+COMPILE_CACHE_MAX_SIZE ?= 2048
+ifneq ($(USE_COMPILE_CACHE),no)
+    ifneq ($(USE_CCACHE),no)
+        $(error USE_CCACHE and USE_COMPILE_CACHE can not be used together)
+    endif
+    CC_PREFIX ?= PYTHONPATH=$(TOP_DIR)/lib/python python3 -m qmk.compile_cache $(COMPILE_CACHE_DIR) --max-size $(COMPILE_CACHE_MAX_SIZE) --
+endif
+
 #---------------- Compiler Options C ----------------
 #  -g*:          generate debugging information
 #  -O*:          optimization level